@@ -34,6 +34,106 @@ UG_NAMESPACE_BEGIN
 
 TouchRegistry *TouchRegistry::m_instance = nullptr;
 
+/*
+  A QTouchEvent reused for dispatching the UnownedTouchEvents, one per dispatch
+  in progress. Its touch points are updated in place, so once the points count
+  settles no allocation happens, unless a receiver keeps a copy of them.
+ */
+class TouchRegistry::DispatchTouchEvent : public QTouchEvent
+{
+public:
+    DispatchTouchEvent(QEvent::Type type)
+        : QTouchEvent(type)
+    {}
+
+    void fill(const QTouchEvent *event, const TouchIds &touchIds, QQuickItem *item);
+
+private:
+    static bool containsTouchId(const TouchIds &touchIds, int touchId);
+};
+
+bool TouchRegistry::DispatchTouchEvent::containsTouchId(const TouchIds &touchIds, int touchId)
+{
+    for (int i = 0; i < touchIds.count(); ++i) {
+        if (touchIds[i] == touchId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+   Sets point to the original touch point, with the screen coordinates replaced by the
+   window ones, the window coordinates by the scene ones, and the local coordinates
+   mapped into the given item.
+ */
+static void setItemTouchPoint(QTouchEvent::TouchPoint &point, const QTouchEvent::TouchPoint &original,
+                              const QTransform &windowToItemTransform,
+                              const QMatrix4x4 &windowToItemMatrix)
+{
+    point.setId(original.id());
+    point.setState(original.state());
+    point.setFlags(original.flags());
+    point.setPressure(original.pressure());
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    point.setUniqueId(original.uniqueId().numericId());
+    point.setRotation(original.rotation());
+#endif
+    point.setNormalizedPos(original.normalizedPos());
+    point.setStartNormalizedPos(original.startNormalizedPos());
+    point.setLastNormalizedPos(original.lastNormalizedPos());
+    point.setRawScreenPositions(original.rawScreenPositions());
+
+    point.setScreenRect(original.sceneRect());
+    point.setStartScreenPos(original.startScenePos());
+    point.setLastScreenPos(original.lastScenePos());
+
+    point.setSceneRect(original.rect());
+    point.setStartScenePos(original.startPos());
+    point.setLastScenePos(original.lastPos());
+
+    point.setRect(windowToItemTransform.mapRect(original.rect()));
+    point.setStartPos(windowToItemTransform.map(original.startPos()));
+    point.setLastPos(windowToItemTransform.map(original.lastPos()));
+    point.setVelocity(windowToItemMatrix.mapVector(original.velocity()).toVector2D());
+}
+
+void TouchRegistry::DispatchTouchEvent::fill(const QTouchEvent *event, const TouchIds &touchIds,
+                                             QQuickItem *item)
+{
+    Q_ASSERT(event->type() == type());
+
+    Qt::TouchPointStates touchPointStates = 0;
+    const QList<QTouchEvent::TouchPoint> &allTouchPoints = event->touchPoints();
+
+    QTransform windowToCandidateTransform = QQuickItemPrivate::get(item)->windowToItemTransform();
+    QMatrix4x4 windowToCandidateMatrix(windowToCandidateTransform);
+
+    int count = 0;
+    for (int i = 0; i < allTouchPoints.count(); ++i) {
+        const QTouchEvent::TouchPoint &originalTouchPoint = allTouchPoints[i];
+        if (containsTouchId(touchIds, originalTouchPoint.id())) {
+            if (count == _touchPoints.count()) {
+                _touchPoints.append(QTouchEvent::TouchPoint());
+            }
+            setItemTouchPoint(_touchPoints[count++], originalTouchPoint,
+                              windowToCandidateTransform, windowToCandidateMatrix);
+            touchPointStates |= originalTouchPoint.state();
+        }
+    }
+    while (_touchPoints.count() > count) {
+        _touchPoints.removeLast();
+    }
+
+    setDevice(event->device());
+    setModifiers(event->modifiers());
+    setTouchPointStates(touchPointStates);
+    setWindow(event->window());
+    setTimestamp(event->timestamp());
+    setTarget(event->target());
+    setAccepted(true);
+}
+
 TouchRegistry::TouchRegistry(QObject *parent)
     : QObject(parent)
     , m_inDispatchLoop(false)
@@ -46,6 +146,7 @@ TouchRegistry::~TouchRegistry()
     Q_ASSERT(m_instance != nullptr);
     m_instance = nullptr;
     delete m_timerFactory;
+    qDeleteAll(m_freeTouchEvents);
 }
 
 TouchRegistry *TouchRegistry::instance()
@@ -97,9 +198,29 @@ void TouchRegistry::deliverTouchUpdatesToUndecidedCandidatesAndWatchers(const QT
     // E.g.: a QTouchEvent might have three touches but a given item might be interested in only
     // one of them. So he will get a UnownedTouchEvent from this QTouchEvent containing only that
     // touch point.
-    QHash<QQuickItem*, QList<int>> touchIdsForItems;
+    // The buffer is taken over so that a re-entrant update does not overwrite it; the entries
+    // keep their storage between events.
+    QVector<ItemTouches> itemTouches;
+    itemTouches.swap(m_itemTouches);
+    int itemCount = 0;
+
+    auto addTouchForItem = [&](QQuickItem *item, int touchId) {
+        for (int i = 0; i < itemCount; ++i) {
+            if (itemTouches[i].item == item) {
+                itemTouches[i].touchIds.append(touchId);
+                return;
+            }
+        }
+        if (itemCount == itemTouches.count()) {
+            itemTouches.resize(itemCount + 1);
+        }
+        ItemTouches &entry = itemTouches[itemCount++];
+        entry.item = item;
+        entry.touchIds.clear();
+        entry.touchIds.append(touchId);
+    };
 
-    // Build touchIdsForItems
+    // Build the item touches
     m_touchInfoPool.forEach([&](Pool<TouchInfo>::Iterator &touchInfo) {
         if (touchInfo->isOwned() && touchInfo->watchers.isEmpty())
             return true;
@@ -111,15 +232,15 @@ void TouchRegistry::deliverTouchUpdatesToUndecidedCandidatesAndWatchers(const QT
                         CandidateInfo &candidate = touchInfo->candidates[i];
                         Q_ASSERT(!candidate.item.isNull());
                         if (candidate.state != CandidateInfo::InterimOwner) {
-                            touchIdsForItems[candidate.item.data()].append(touchInfo->id);
+                            addTouchForItem(candidate.item.data(), touchInfo->id);
                         }
                     }
                 }
 
-                const QList<QPointer<QQuickItem>> &watchers = touchInfo->watchers;
+                const QVarLengthArray<QPointer<QQuickItem>, 2> &watchers = touchInfo->watchers;
                 for (int i = 0; i < watchers.count(); ++i) {
                     if (!watchers[i].isNull()) {
-                        touchIdsForItems[watchers[i].data()].append(touchInfo->id);
+                        addTouchForItem(watchers[i].data(), touchInfo->id);
                     }
                 }
 
@@ -133,14 +254,12 @@ void TouchRegistry::deliverTouchUpdatesToUndecidedCandidatesAndWatchers(const QT
     // TODO: Consider what happens if an item calls any of TouchRegistry's public methods
     // from the event handler callback.
     m_inDispatchLoop = true;
-    auto it = touchIdsForItems.constBegin();
-    while (it != touchIdsForItems.constEnd()) {
-        QQuickItem *item = it.key();
-        const QList<int> &touchIds = it.value();
-        dispatchPointsToItem(event, touchIds, item);
-        ++it;
-    };
+    for (int i = 0; i < itemCount; ++i) {
+        dispatchPointsToItem(event, itemTouches[i].touchIds, itemTouches[i].item);
+    }
     m_inDispatchLoop = false;
+
+    m_itemTouches.swap(itemTouches);
 }
 
 void TouchRegistry::freeEndedTouchInfos()
@@ -157,61 +276,33 @@ void TouchRegistry::freeEndedTouchInfos()
    Extracts the touches with the given touchIds from event and send them in a
    UnownedTouchEvent to the given item
  */
-void TouchRegistry::dispatchPointsToItem(const QTouchEvent *event, const QList<int> &touchIds,
+void TouchRegistry::dispatchPointsToItem(const QTouchEvent *event, const TouchIds &touchIds,
         QQuickItem *item)
 {
-    Qt::TouchPointStates touchPointStates = 0;
-    QList<QTouchEvent::TouchPoint> touchPoints;
-
-    const QList<QTouchEvent::TouchPoint> &allTouchPoints = event->touchPoints();
-
-    QTransform windowToCandidateTransform = QQuickItemPrivate::get(item)->windowToItemTransform();
-    QMatrix4x4 windowToCandidateMatrix(windowToCandidateTransform);
-
-    for (int i = 0; i < allTouchPoints.count(); ++i) {
-        const QTouchEvent::TouchPoint &originalTouchPoint = allTouchPoints[i];
-        if (touchIds.contains(originalTouchPoint.id())) {
-            QTouchEvent::TouchPoint touchPoint = originalTouchPoint;
-
-            translateTouchPointFromScreenToWindowCoords(touchPoint);
-
-            // Set the point's local coordinates to that of the item
-            touchPoint.setRect(windowToCandidateTransform.mapRect(touchPoint.sceneRect()));
-            touchPoint.setStartPos(windowToCandidateTransform.map(touchPoint.startScenePos()));
-            touchPoint.setLastPos(windowToCandidateTransform.map(touchPoint.lastScenePos()));
-            touchPoint.setVelocity(windowToCandidateMatrix.mapVector(touchPoint.velocity()).toVector2D());
-
-            touchPoints.append(touchPoint);
-            touchPointStates |= touchPoint.state();
+    // take a free event of the same type, a dispatch may be in progress with another one
+    DispatchTouchEvent *eventForItem = nullptr;
+    for (int i = 0; i < m_freeTouchEvents.count(); ++i) {
+        if (m_freeTouchEvents[i]->type() == event->type()) {
+            eventForItem = m_freeTouchEvents[i];
+            m_freeTouchEvents.remove(i);
+            break;
         }
     }
+    if (!eventForItem) {
+        eventForItem = new DispatchTouchEvent(event->type());
+    }
+    eventForItem->fill(event, touchIds, item);
 
-    QTouchEvent *eventForItem = new QTouchEvent(event->type(),
-                                                event->device(),
-                                                event->modifiers(),
-                                                touchPointStates,
-                                                touchPoints);
-    eventForItem->setWindow(event->window());
-    eventForItem->setTimestamp(event->timestamp());
-    eventForItem->setTarget(event->target());
-
-    UnownedTouchEvent unownedTouchEvent(eventForItem);
-
-    UG_DEBUG << "Sending unowned" << qPrintable(touchEventToString(eventForItem))
-        << "to" << item;
+    {
+        UnownedTouchEvent unownedTouchEvent(eventForItem, false /*takeOwnership*/);
 
-    QCoreApplication::sendEvent(item, &unownedTouchEvent);
-}
+        UG_DEBUG << "Sending unowned" << qPrintable(touchEventToString(eventForItem))
+            << "to" << item;
 
-void TouchRegistry::translateTouchPointFromScreenToWindowCoords(QTouchEvent::TouchPoint &touchPoint)
-{
-    touchPoint.setScreenRect(touchPoint.sceneRect());
-    touchPoint.setStartScreenPos(touchPoint.startScenePos());
-    touchPoint.setLastScreenPos(touchPoint.lastScenePos());
+        QCoreApplication::sendEvent(item, &unownedTouchEvent);
+    }
 
-    touchPoint.setSceneRect(touchPoint.rect());
-    touchPoint.setStartScenePos(touchPoint.startPos());
-    touchPoint.setLastScenePos(touchPoint.lastPos());
+    m_freeTouchEvents.append(eventForItem);
 }
 
 bool TouchRegistry::eventFilter(QObject *watched, QEvent *event)
@@ -459,7 +550,7 @@ void TouchRegistry::removeCandidateHelper(Pool<TouchInfo>::Iterator &touchInfo,
             disconnect(candidateInfo.item.data(), nullptr, this, nullptr);
         }
     }
-    touchInfo->candidates.removeAt(candidateIndex);
+    touchInfo->candidates.remove(candidateIndex);
 }
 
 ////////////////////////////////////// TouchRegistry::TouchInfo ////////////////////////////////////
@@ -490,7 +581,7 @@ void TouchRegistry::TouchInfo::init(int id)
 
 bool TouchRegistry::TouchInfo::isOwned() const
 {
-    return !candidates.isEmpty() && candidates.first().state != CandidateInfo::Undecided;
+    return !candidates.isEmpty() && candidates[0].state != CandidateInfo::Undecided;
 }
 
 bool TouchRegistry::TouchInfo::ended() const
@@ -508,9 +599,9 @@ void TouchRegistry::TouchInfo::notifyCandidatesOfOwnershipResolution()
 
     // need to take a copy of the item list in case
     // we call back in to remove candidate during the lost ownership event.
-    QList<QPointer<QQuickItem>> items;
-    Q_FOREACH(const CandidateInfo& info, candidates) {
-        items << info.item;
+    QVarLengthArray<QPointer<QQuickItem>, 4> items;
+    for (int i = 0; i < candidates.count(); ++i) {
+        items.append(candidates[i].item);
     }
 
     TouchOwnershipEvent gainedOwnershipEvent(id, true /*gained*/);
@@ -20,6 +20,7 @@
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QVarLengthArray>
 #include <QtCore/QVector>
 #include <QtGui/QTouchEvent>
 #include <QtQuick/QQuickItem>
@@ -168,11 +169,23 @@ private:
         bool ended() const;
         void notifyCandidatesOfOwnershipResolution();
 
-        // TODO optimize storage (s/QList/Pool)
-        QList<CandidateInfo> candidates;
-        QList<QPointer<QQuickItem>> watchers;
+        // there are rarely more than a couple of candidates and watchers per touch,
+        // and the storage is kept when the pool reuses the TouchInfo
+        QVarLengthArray<CandidateInfo, 4> candidates;
+        QVarLengthArray<QPointer<QQuickItem>, 2> watchers;
     };
 
+    typedef QVarLengthArray<int, 4> TouchIds;
+
+    // the touches of a touch event an item should be informed about
+    class ItemTouches {
+    public:
+        QQuickItem *item;
+        TouchIds touchIds;
+    };
+
+    class DispatchTouchEvent;
+
     void pruneNullCandidatesForTouch(int touchId);
     void removeCandidateOwnerForTouchByIndex(Pool<TouchInfo>::Iterator &touchInfo, int candidateIndex);
     void removeCandidateHelper(Pool<TouchInfo>::Iterator &touchInfo, int candidateIndex);
@@ -181,14 +194,16 @@ private:
 
     void deliverTouchUpdatesToUndecidedCandidatesAndWatchers(const QTouchEvent *event);
 
-    static void translateTouchPointFromScreenToWindowCoords(QTouchEvent::TouchPoint &touchPoint);
-
-    static void dispatchPointsToItem(const QTouchEvent *event, const QList<int> &touchIds,
-                                     QQuickItem *item);
+    void dispatchPointsToItem(const QTouchEvent *event, const TouchIds &touchIds,
+                              QQuickItem *item);
     void freeEndedTouchInfos();
 
     Pool<TouchInfo> m_touchInfoPool;
 
+    // buffers reused by each touch event dispatch, so that dispatching does not allocate
+    QVector<ItemTouches> m_itemTouches;
+    QVector<DispatchTouchEvent*> m_freeTouchEvents;
+
     // the singleton instance
     static TouchRegistry *m_instance;
 
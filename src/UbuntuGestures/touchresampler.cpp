@@ -0,0 +1,118 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "touchresampler_p.h"
+
+UG_NAMESPACE_BEGIN
+
+TouchResampler::TouchResampler()
+    : m_last(-1)
+    , m_count(0)
+    , m_fitWindow(50)
+    , m_maxPrediction(20)
+{
+}
+
+void TouchResampler::reset()
+{
+    m_last = -1;
+    m_count = 0;
+    m_intercept = QPointF();
+    m_slope = QPointF();
+}
+
+void TouchResampler::addSample(qint64 time, const QPointF &position)
+{
+    if (m_count > 0 && time <= lastSampleTime()) {
+        // several samples within the same millisecond, keep the most recent position
+        m_positions[m_last] = position;
+    } else {
+        m_last = (m_last + 1) % MaxSamples;
+        m_times[m_last] = time;
+        m_positions[m_last] = position;
+        if (m_count < MaxSamples) {
+            m_count++;
+        }
+    }
+    fit();
+}
+
+qint64 TouchResampler::lastSampleTime() const
+{
+    Q_ASSERT(m_count > 0);
+    return m_times[m_last];
+}
+
+QPointF TouchResampler::lastSamplePosition() const
+{
+    Q_ASSERT(m_count > 0);
+    return m_positions[m_last];
+}
+
+// returns the sample taken age samples before the last one
+const QPointF &TouchResampler::sampleAt(int age, qint64 *time) const
+{
+    int index = (m_last - age + MaxSamples) % MaxSamples;
+    *time = m_times[index];
+    return m_positions[index];
+}
+
+void TouchResampler::fit()
+{
+    const qint64 lastTime = lastSampleTime();
+
+    // times are relative to the last sample, so the intercept is the position at that time
+    int n = 0;
+    qreal sumT = 0., sumTT = 0.;
+    QPointF sumP, sumTP;
+    for (int age = 0; age < m_count; age++) {
+        qint64 time;
+        const QPointF &position = sampleAt(age, &time);
+        qreal t = time - lastTime;
+        if (-t > m_fitWindow) {
+            break;
+        }
+        n++;
+        sumT += t;
+        sumTT += t * t;
+        sumP += position;
+        sumTP += t * position;
+    }
+
+    qreal denominator = n * sumTT - sumT * sumT;
+    if (n < 2 || qFuzzyIsNull(denominator)) {
+        m_intercept = lastSamplePosition();
+        m_slope = QPointF();
+        return;
+    }
+    m_slope = (n * sumTP - sumT * sumP) / denominator;
+    m_intercept = (sumP - m_slope * sumT) / n;
+}
+
+QPointF TouchResampler::positionAt(qint64 time) const
+{
+    if (m_count == 0) {
+        return QPointF();
+    }
+    qint64 elapsed = time - lastSampleTime();
+    if (elapsed > m_fitWindow) {
+        // no movement reported for a while, the touch point is at rest
+        return lastSamplePosition();
+    }
+    return m_intercept + m_slope * qMin<qint64>(elapsed, m_maxPrediction);
+}
+
+UG_NAMESPACE_END
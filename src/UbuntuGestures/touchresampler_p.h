@@ -0,0 +1,77 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOUCHRESAMPLER_P_H
+#define TOUCHRESAMPLER_P_H
+
+#include <QtCore/QPointF>
+
+#include <UbuntuGestures/ubuntugesturesglobal.h>
+
+UG_NAMESPACE_BEGIN
+
+/*
+    Estimates the position of a touch point at an arbitrary time, typically the
+    next vsync, from its most recent samples.
+
+    A line is fitted with least squares through the samples of the last fitWindow
+    milliseconds, separately on each axis. Its slope is the filtered velocity of the
+    touch point, and positions after the last sample are extrapolated along it, up to
+    maxPrediction milliseconds. Once no sample arrived for fitWindow milliseconds the
+    touch point is considered to be at rest, at its last position.
+ */
+class UBUNTUGESTURES_EXPORT TouchResampler
+{
+public:
+    TouchResampler();
+
+    void reset();
+    // time is in milliseconds, as returned by a TimeSource
+    void addSample(qint64 time, const QPointF &position);
+
+    bool isEmpty() const { return m_count == 0; }
+    qint64 lastSampleTime() const;
+    QPointF lastSamplePosition() const;
+
+    QPointF positionAt(qint64 time) const;
+    // velocity in pixels per second
+    QPointF velocity() const { return m_slope * 1000.; }
+
+    void setFitWindow(int msecs) { m_fitWindow = msecs; }
+    int fitWindow() const { return m_fitWindow; }
+    void setMaxPrediction(int msecs) { m_maxPrediction = msecs; }
+    int maxPrediction() const { return m_maxPrediction; }
+
+private:
+    void fit();
+    const QPointF &sampleAt(int age, qint64 *time) const;
+
+    enum { MaxSamples = 8 };
+    qint64 m_times[MaxSamples];
+    QPointF m_positions[MaxSamples];
+    int m_last;
+    int m_count;
+    int m_fitWindow;
+    int m_maxPrediction;
+
+    // fitted line, at the time of the last sample, in pixels and pixels per millisecond
+    QPointF m_intercept;
+    QPointF m_slope;
+};
+
+UG_NAMESPACE_END
+
+#endif // TOUCHRESAMPLER_P_H
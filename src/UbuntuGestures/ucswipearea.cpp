@@ -283,6 +283,50 @@ void UCSwipeAreaPrivate::setTimeSource(const SharedTimeSource &timeSource)
     activeTouches.m_timeSource = timeSource;
 }
 
+void UCSwipeAreaPrivate::setTouchResampling(bool enabled)
+{
+    if (touchResampling == enabled) {
+        return;
+    }
+    touchResampling = enabled;
+    connectToWindow(window);
+}
+
+void UCSwipeAreaPrivate::connectToWindow(QQuickWindow *window)
+{
+    QObject::disconnect(afterAnimatingConnection);
+    if (!window || !touchResampling) {
+        return;
+    }
+
+    Q_Q(UCSwipeArea);
+    afterAnimatingConnection = QObject::connect(window, &QQuickWindow::afterAnimating,
+                                                q, [this]() { resampleTouchPosition(); });
+    // FIXME: Handle window->screen() changes (ie window changing screens)
+    qreal refreshRate = window->screen() ? window->screen()->refreshRate() : 60.;
+    predictionLead = qRound(1000. / (refreshRate > 0. ? refreshRate : 60.));
+}
+
+void UCSwipeAreaPrivate::resampleTouchPosition()
+{
+    if (status != Recognized || resampler.isEmpty()) {
+        return;
+    }
+
+    QPointF point = resampler.positionAt(timeSource->msecsSinceReference() + predictionLead);
+    QPointF delta = point - publicScenePos;
+    if (qAbs(delta.x()) < 0.1 && qAbs(delta.y()) < 0.1) {
+        // close enough, don't keep the window rendering for sub-pixel changes
+        return;
+    }
+    updatePosition(point);
+
+    // position smoothing only covers part of the distance at once, ask for another frame
+    if (window && publicScenePos != point) {
+        window->update();
+    }
+}
+
 /*!
  * \qmlproperty real SwipeArea::distance
  * \readonly
@@ -464,6 +508,8 @@ void UCSwipeAreaPrivate::unownedTouchEvent_undecided(UnownedTouchEvent *unownedT
         return;
     }
 
+    resampler.addSample(timeSource->msecsSinceReference(), touchScenePosition);
+
     previousDampedScenePos.setX(dampedScenePos.x());
     previousDampedScenePos.setY(dampedScenePos.y());
     dampedScenePos.update(touchScenePosition);
@@ -579,6 +625,8 @@ void UCSwipeAreaPrivate::touchEvent_absent(QTouchEvent *event)
         startScenePos = newTouchPoint->scenePos();
         touchId = newTouchPoint->id();
         dampedScenePos.reset(startScenePos);
+        resampler.reset();
+        resampler.addSample(timeSource->msecsSinceReference(), startScenePos);
         updatePosition(startScenePos);
 
         updateSceneDirectionVector();
@@ -646,10 +694,17 @@ void UCSwipeAreaPrivate::touchEvent_recognized(QTouchEvent *event)
                "Considering it as released.";
         setStatus(WaitingForTouch);
     } else {
-        updatePosition(touchPoint->scenePos());
+        resampler.addSample(timeSource->msecsSinceReference(), touchPoint->scenePos());
 
         if (touchPoint->state() == Qt::TouchPointReleased) {
+            // the gesture ends where the finger was lifted, no prediction
+            updatePosition(touchPoint->scenePos());
             setStatus(WaitingForTouch);
+        } else if (afterAnimatingConnection) {
+            // position gets updated by resampleTouchPosition() on the next frame
+            window->update();
+        } else {
+            updatePosition(touchPoint->scenePos());
         }
     }
 }
@@ -851,11 +906,12 @@ bool UCSwipeAreaPrivate::isWithinTouchCompositionWindow()
 void UCSwipeArea::itemChange(ItemChange change, const ItemChangeData &value)
 {
     if (change == QQuickItem::ItemSceneChange) {
+        Q_D(UCSwipeArea);
+        d->connectToWindow(value.window);
         if (value.window != nullptr) {
             value.window->installEventFilter(TouchRegistry::instance());
 
             // FIXME: Handle window->screen() changes (ie window changing screens)
-            Q_D(UCSwipeArea);
             qreal pixelsPerInch = value.window->screen()->physicalDotsPerInch();
             if (pixelsPerInch < 0) {
                 // FIXME: dpi can be negative lp#1525293
@@ -1024,10 +1080,12 @@ UCSwipeAreaPrivate::UCSwipeAreaPrivate()
     , touchId(-1)
     , maxTime(400)
     , compositionTime(60)
+    , predictionLead(16)
     , status(WaitingForTouch)
     , direction(UCSwipeArea::Rightwards)
     , immediateRecognition(false)
     , grabGesture(true)
+    , touchResampling(false)
 {
 }
 
@@ -22,6 +22,7 @@
 #include <QtQuick/private/qquickitem_p.h>
 
 #include <UbuntuGestures/private/damper_p.h>
+#include <UbuntuGestures/private/touchresampler_p.h>
 
 UG_NAMESPACE_BEGIN
 
@@ -75,6 +76,14 @@ public:
     // Useful for testing, where a fake time source can be supplied
     void setTimeSource(const UG_PREPEND_NAMESPACE(SharedTimeSource) &timeSource);
 
+    // When enabled, the public touch position of a recognized gesture is updated once per
+    // frame, right before the scene graph is synchronized, with the touch position predicted
+    // for the time that frame is going to be displayed, instead of on each touch event.
+    void setTouchResampling(bool enabled);
+    // Filtered velocity of the tracked touch point, in scene pixels per second
+    QPointF velocity() const { return resampler.velocity(); }
+    void resampleTouchPosition();
+
     // Describes the state of the directional drag gesture.
     enum Status {
         // Waiting for a new touch point to land on this area. No gesture is being processed
@@ -119,6 +128,7 @@ public:
     bool sanityCheckRecognitionProperties();
     void setDistanceThreshold(qreal value);
     void setPixelsPerMm(qreal pixelsPerMm);
+    void connectToWindow(QQuickWindow *window);
     QString objectName() const { return q_func()->objectName(); }
 
     // manage status change listeners
@@ -137,6 +147,8 @@ public:
     QPointF sceneDirectionVector;
     UG_PREPEND_NAMESPACE(SharedTimeSource) timeSource;
     ActiveTouchesInfo activeTouches;
+    UG_PREPEND_NAMESPACE(TouchResampler) resampler;
+    QMetaObject::Connection afterAnimatingConnection;
 
     // status change listeners
     QList<UCSwipeAreaStatusListener*> statusChangeListeners;
@@ -158,6 +170,9 @@ public:
     // subsequent touch starts are grouped with the first one into an N-touches gesture
     // (e.g. a two-fingers tap or drag).
     int compositionTime;
+    // How far ahead (in milliseconds) of the current time the resampled position is predicted,
+    // that is one frame interval of the screen the window is on.
+    int predictionLead;
 
     // The current status of the directional drag gesture area.
     Status status;
@@ -165,6 +180,7 @@ public:
 
     bool immediateRecognition;
     bool grabGesture;
+    bool touchResampling;
 };
 
 class UBUNTUGESTURES_EXPORT UCSwipeAreaStatusListener
@@ -20,12 +20,20 @@ UG_NAMESPACE_BEGIN
 
 QEvent::Type UnownedTouchEvent::m_unownedTouchEventType = (QEvent::Type)-1;
 
-UnownedTouchEvent::UnownedTouchEvent(QTouchEvent *touchEvent)
+UnownedTouchEvent::UnownedTouchEvent(QTouchEvent *touchEvent, bool takeOwnership)
     : QEvent(unownedTouchEventType())
     , m_touchEvent(touchEvent)
+    , m_ownsTouchEvent(takeOwnership)
 {
 }
 
+UnownedTouchEvent::~UnownedTouchEvent()
+{
+    if (m_ownsTouchEvent) {
+        delete m_touchEvent;
+    }
+}
+
 QEvent::Type UnownedTouchEvent::unownedTouchEventType()
 {
     if (m_unownedTouchEventType == (QEvent::Type)-1) {
@@ -37,7 +45,7 @@ QEvent::Type UnownedTouchEvent::unownedTouchEventType()
 
 QTouchEvent *UnownedTouchEvent::touchEvent()
 {
-    return m_touchEvent.data();
+    return m_touchEvent;
 }
 
 UG_NAMESPACE_END
@@ -17,7 +17,6 @@
 #ifndef UNOWNEDTOUCHEVENT_P_H
 #define UNOWNEDTOUCHEVENT_P_H
 
-#include <QtCore/QScopedPointer>
 #include <QtGui/QTouchEvent>
 
 #include <UbuntuGestures/ubuntugesturesglobal.h>
@@ -31,7 +30,9 @@ UG_NAMESPACE_BEGIN
 class UBUNTUGESTURES_EXPORT UnownedTouchEvent : public QEvent
 {
 public:
-    UnownedTouchEvent(QTouchEvent *touchEvent);
+    // The touchEvent is deleted together with this event unless takeOwnership is false
+    UnownedTouchEvent(QTouchEvent *touchEvent, bool takeOwnership = true);
+    ~UnownedTouchEvent();
     static Type unownedTouchEventType();
 
     // TODO: It might be cleaner to store the information directly in UnownedTouchEvent
@@ -40,8 +41,10 @@ public:
     QTouchEvent *touchEvent();
 
 private:
+    Q_DISABLE_COPY(UnownedTouchEvent)
     static Type m_unownedTouchEventType;
-    QScopedPointer<QTouchEvent> m_touchEvent;
+    QTouchEvent *m_touchEvent;
+    bool m_ownsTouchEvent;
 };
 
 UG_NAMESPACE_END
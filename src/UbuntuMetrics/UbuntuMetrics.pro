@@ -8,6 +8,7 @@ contains(QT_CONFIG, opengles2) {
 }
 
 linux {
+    LIBS += -lrt
     DEFINES += \
         LTTNG_PLUGIN_INSTALL_PATH=\\\"$$[QT_INSTALL_PLUGINS]/ubuntu/metrics/libumlttng.so\\\"
     DEFINES += LTTNG_PLUGIN_BUILD_PATH=\\\"$$OUT_PWD/lttng/libumlttng.so\\\"
@@ -21,6 +22,7 @@ HEADERS += \
     $$PWD/events.h \
     $$PWD/events_p.h \
     $$PWD/gputimer_p.h \
+    $$PWD/histogram.h \
     $$PWD/logger.h \
     $$PWD/logger_p.h \
     $$PWD/overlay_p.h \
@@ -32,6 +34,7 @@ SOURCES += \
     $$PWD/bitmaptext.cpp \
     $$PWD/events.cpp \
     $$PWD/gputimer.cpp \
+    $$PWD/histogram.cpp \
     $$PWD/logger.cpp \
     $$PWD/overlay.cpp \
     $$PWD/ubuntumetricsglobal.cpp
@@ -18,6 +18,7 @@
 #include "applicationmonitor_p.h"
 
 #include <QtCore/QTimer>
+#include <QtCore/QVarLengthArray>
 #include <QtGui/QGuiApplication>
 #include <QtQuick/QQuickWindow>
 
@@ -25,19 +26,130 @@
 //     that's not monitored because the max count was reached, enable monitoring
 //     on it if possible.
 
-const int logQueueSize = 16;
-const int logQueueAlignment = 64;
+// Capacities of the event queues, must be power-of-twos. Window queues are
+// bigger since they receive an event per frame.
+const int windowQueueCapacity = 64;
+const int applicationQueueCapacity = 16;
+const int queueAlignment = 64;
+
+// Max number of events dequeued at once by the logging thread.
+const int maxBatchSize = 32;
+
+// Time in milliseconds the logging thread waits for more events once woken up
+// by a new event, so that events are logged in batches. Producers cut that
+// wait short when a queue gets half full, so this also bounds the logging
+// latency. The logging thread doesn't wake up at all while the queues are
+// empty.
+const unsigned long drainInterval = 50;
+
+EventQueue::EventQueue(LoggingThread* loggingThread, int capacity)
+    : m_loggingThread(loggingThread)
+    , m_mask(capacity - 1)
+    , m_droppedEventCount(0)
+    , m_released(0)
+    , m_head(0)
+    , m_tail(0)
+{
+    DASSERT(loggingThread);
+    DASSERT(capacity > 0);
+    DASSERT(IS_POWER_OF_TWO(capacity));
+
+    m_events = static_cast<UMEvent*>(alignedAlloc(queueAlignment, capacity * sizeof(UMEvent)));
+}
+
+EventQueue::~EventQueue()
+{
+    free(m_events);
+}
+
+void EventQueue::push(const UMEvent* event)
+{
+    DASSERT(event);
+
+    // The tail is only written by the producer, no need for ordering there.
+    const quint32 tail = m_tail.load();
+    quint32 head = m_head.loadAcquire();
+
+    if (Q_UNLIKELY(tail - head > m_mask)) {
+        switch (m_loggingThread->overflowPolicy()) {
+        case UMApplicationMonitor::DropNewest:
+            m_droppedEventCount.fetchAndAddRelaxed(1);
+            return;
+
+        case UMApplicationMonitor::DropOldest:
+            // Steal the oldest slot from the consumer. If the consumer was
+            // copying that slot, its compare-and-swap on the head fails and it
+            // discards the copy.
+            while (tail - head > m_mask) {
+                if (m_head.testAndSetOrdered(head, head + 1)) {
+                    m_droppedEventCount.fetchAndAddRelaxed(1);
+                    head++;
+                    break;
+                }
+                head = m_head.loadAcquire();
+            }
+            break;
+
+        case UMApplicationMonitor::Block:
+        default:
+            m_loggingThread->wakeUp();
+            do {
+                QThread::yieldCurrentThread();
+                head = m_head.loadAcquire();
+            } while (tail - head > m_mask);
+            break;
+        }
+    }
+
+    memcpy(&m_events[tail & m_mask], event, sizeof(UMEvent));
+    // The tail store must not be reordered with the load of the waiting state
+    // in wakeUp(), otherwise the logging thread could go idle and miss the
+    // event.
+    m_tail.fetchAndStoreOrdered(tail + 1);
+
+    // Wake up the logging thread if it's idle, or early if it's waiting for
+    // more events and the queue gets half full.
+    m_loggingThread->wakeUp((tail + 1 - head) > (m_mask >> 1));
+}
+
+void EventQueue::release()
+{
+    m_released.fetchAndStoreOrdered(1);
+    m_loggingThread->wakeUp(false);
+}
+
+int EventQueue::pop(UMEvent* events, int maxCount)
+{
+    DASSERT(events);
+    DASSERT(maxCount > 0);
+
+    while (true) {
+        const quint32 head = m_head.loadAcquire();
+        const quint32 tail = m_tail.loadAcquire();
+        const int count = qMin(static_cast<quint32>(maxCount), qMin(tail - head, m_mask + 1));
+        if (count == 0) {
+            return 0;
+        }
+        for (int i = 0; i < count; ++i) {
+            memcpy(&events[i], &m_events[(head + i) & m_mask], sizeof(UMEvent));
+        }
+        // The producer might have dropped (and overwritten) the oldest events
+        // while copying, in which case the head moved and the copies are
+        // discarded.
+        if (m_head.testAndSetOrdered(head, head + count)) {
+            return count;
+        }
+    }
+}
 
-LoggingThread::LoggingThread()
+LoggingThread::LoggingThread(UMApplicationMonitor::OverflowPolicy policy)
     : m_loggerCount(0)
+    , m_droppedEventCount(0)
     , m_refCount(1)
-    , m_queueIndex(0)
-    , m_queueSize(0)
+    , m_waiting(0)
+    , m_overflowPolicy(policy)
     , m_flags(0)
 {
-    m_queue = static_cast<UMEvent*>(
-        alignedAlloc(logQueueAlignment, logQueueSize * sizeof(UMEvent)));
-
 #if !defined(QT_NO_DEBUG)
     setObjectName(QStringLiteral("UbuntuMetrics logging"));  // Thread name.
 #endif
@@ -48,76 +160,122 @@ LoggingThread::~LoggingThread()
 {
     m_mutex.lock();
     m_flags |= JoinRequested;
-    if (m_flags & Waiting) {
-        m_condition.wakeOne();
-    }
+    m_condition.wakeOne();
     m_mutex.unlock();
     wait();
 
-    free(m_queue);
+    // All the queues are released and drained at that point.
+    DASSERT(m_queues.isEmpty());
+    qDeleteAll(m_queues);
 }
 
-#define BREAK_ON_JOIN_REQUEST()                \
-    if (Q_UNLIKELY(m_flags & JoinRequested)) { \
-        m_mutex.unlock();                      \
-        break;                                 \
-    }
-
 // Logging thread entry point.
 void LoggingThread::run()
 {
     DLOG("Entering logging thread.");
+
+    UMEvent* events = static_cast<UMEvent*>(
+        alignedAlloc(queueAlignment, maxBatchSize * sizeof(UMEvent)));
+    QVarLengthArray<EventQueue*, 2 * UMApplicationMonitorPrivate::maxMonitors> queues;
+    UMLogger* loggers[UMApplicationMonitorPrivate::maxLoggers];
+
     while (true) {
-        // Wait for new events in the log queue.
+        // Get the current queues and loggers. That lock is never taken by
+        // producers pushing events, unless the logging thread is waiting.
         m_mutex.lock();
-        DASSERT(m_queueSize >= 0);
-        if (m_queueSize == 0) {
-            BREAK_ON_JOIN_REQUEST();
-            m_flags |= Waiting;
-            m_condition.wait(&m_mutex);
-            if (m_queueSize == 0) {
-                BREAK_ON_JOIN_REQUEST();
+        if (!hasPendingQueue()) {
+            if (Q_UNLIKELY(m_flags & JoinRequested) && m_queues.isEmpty()) {
+                m_mutex.unlock();
+                break;
             }
-            m_flags &= ~Waiting;
+            // Sleep until a producer pushes an event or releases its queue.
+            // The queues are checked again once the waiting state is
+            // published, producers that pushed in between didn't see it.
+            m_waiting.fetchAndStoreOrdered(IdleWaiting);
+            if (!hasPendingQueue() && !(m_flags & JoinRequested)) {
+                m_condition.wait(&m_mutex);
+                // Wait a bit for more events unless a queue gets half full.
+                if (!(m_flags & JoinRequested)) {
+                    m_waiting.storeRelease(BatchWaiting);
+                    m_condition.wait(&m_mutex, drainInterval);
+                }
+            }
+            m_waiting.storeRelease(NotWaiting);
         }
-
-        // Unqueue oldest events from the log queue.
-        DASSERT(m_queueSize > 0);
-        UMEvent event;
-        memcpy(&event, &m_queue[m_queueIndex], sizeof(UMEvent));
-        m_queueIndex = (m_queueIndex + 1) % logQueueSize;
-        m_queueSize--;
-
-        // Log.
+        const int queueCount = m_queues.size();
+        queues.resize(queueCount);
+        memcpy(queues.data(), m_queues.constData(), queueCount * sizeof(EventQueue*));
         const int loggerCount = m_loggerCount;
-        UMLogger* loggers[UMApplicationMonitorPrivate::maxLoggers];
         memcpy(loggers, m_loggers, loggerCount * sizeof(UMLogger*));
         m_mutex.unlock();
-        for (int i = 0; i < loggerCount; ++i) {
-            loggers[i]->log(event);
+
+        // Drain the queues in batches and log. Note that the events of
+        // different windows aren't interleaved by time stamp.
+        for (int i = 0; i < queueCount; ++i) {
+            // Released queues don't get new events, check the flag before
+            // draining so that released queues can be safely deleted once
+            // empty.
+            const bool released = queues[i]->isReleased();
+            int count;
+            while ((count = queues[i]->pop(events, maxBatchSize)) > 0) {
+                for (int j = 0; j < count; ++j) {
+                    for (int k = 0; k < loggerCount; ++k) {
+                        loggers[k]->log(events[j]);
+                    }
+                }
+            }
+            if (released) {
+                m_mutex.lock();
+                m_droppedEventCount += queues[i]->droppedEventCount();
+                m_queues.removeOne(queues[i]);
+                m_mutex.unlock();
+                delete queues[i];
+            }
         }
     }
+
+    free(events);
     DLOG("Leaving logging thread.");
 }
 
-void LoggingThread::push(const UMEvent* event)
+// Must be called with m_mutex locked.
+bool LoggingThread::hasPendingQueue()
 {
-    // Ensure the log queue is not full.
-    m_mutex.lock();
-    DASSERT(m_queueSize <= logQueueSize);
-    while (m_queueSize == logQueueSize) {
-        m_mutex.unlock();
-        QThread::yieldCurrentThread();
-        m_mutex.lock();
+    for (int i = 0; i < m_queues.size(); ++i) {
+        if (!m_queues[i]->isEmpty() || m_queues[i]->isReleased()) {
+            return true;
+        }
     }
+    return false;
+}
+
+EventQueue* LoggingThread::createQueue(int capacity)
+{
+    EventQueue* queue = new EventQueue(this, capacity);
+    QMutexLocker locker(&m_mutex);
+    m_queues.append(queue);
+    return queue;
+}
 
-    // Push event to the log queue.
-    DASSERT(m_queueSize < logQueueSize);
-    memcpy(&m_queue[(m_queueIndex + m_queueSize++) % logQueueSize], event, sizeof(UMEvent));
-    if (m_flags & Waiting) {
+void LoggingThread::wakeUp(bool urgent)
+{
+    const quint32 waiting = m_waiting.loadAcquire();
+    if (waiting == IdleWaiting || (urgent && waiting == BatchWaiting)) {
+        m_mutex.lock();
         m_condition.wakeOne();
+        m_mutex.unlock();
     }
-    m_mutex.unlock();
+}
+
+quint64 LoggingThread::droppedEventCount()
+{
+    QMutexLocker locker(&m_mutex);
+    quint64 count = m_droppedEventCount;
+    const int queueCount = m_queues.size();
+    for (int i = 0; i < queueCount; ++i) {
+        count += m_queues[i]->droppedEventCount();
+    }
+    return count;
 }
 
 void LoggingThread::setLoggers(UMLogger** loggers, int count)
@@ -163,10 +321,13 @@ UMApplicationMonitorPrivate::UMApplicationMonitorPrivate(UMApplicationMonitor* a
     , m_loggers{}
 #endif
     , m_loggingThread(nullptr)
+    , m_applicationQueue(nullptr)
+    , m_droppedEventCount(0)
     , m_monitorCount(0)
     , m_loggerCount(0)
-    , m_updateInterval{1000, -1, -1}
+    , m_updateInterval{1000, -1, -1, -1, 5000, -1}
     , m_flags(UMApplicationMonitor::AllEvents)
+    , m_overflowPolicy(UMApplicationMonitor::Block)
 {
     Q_Q(UMApplicationMonitor);
 
@@ -181,8 +342,10 @@ UMApplicationMonitorPrivate::UMApplicationMonitorPrivate(UMApplicationMonitor* a
     QObject::connect(application, SIGNAL(lastWindowClosed()), q, SLOT(closeDown()));
     QObject::connect(application, SIGNAL(aboutToQuit()), q, SLOT(closeDown()));
     QObject::connect(&m_processTimer, SIGNAL(timeout()), q, SLOT(processTimeout()));
+    QObject::connect(&m_summaryTimer, SIGNAL(timeout()), q, SLOT(summaryTimeout()));
 
     m_processTimer.setInterval(m_updateInterval[UMEvent::Process]);
+    m_summaryTimer.setInterval(m_updateInterval[UMEvent::Summary]);
 }
 
 UMApplicationMonitor::~UMApplicationMonitor()
@@ -215,7 +378,8 @@ void UMApplicationMonitor::setOverlay(bool overlay)
             }
         } else {
             d->m_flags &= ~UMApplicationMonitorPrivate::Overlay;
-            if (!(d->m_flags & UMApplicationMonitorPrivate::Logging)) {
+            if (!(d->m_flags & (UMApplicationMonitorPrivate::Logging
+                                | UMApplicationMonitorPrivate::Histograms))) {
                 d->stop();
             } else {
                 d->setMonitoringFlags(d->m_flags);
@@ -245,7 +409,8 @@ void UMApplicationMonitor::setLogging(bool logging)
             }
         } else {
             d->m_flags &= ~UMApplicationMonitorPrivate::Logging;
-            if (!(d->m_flags & UMApplicationMonitorPrivate::Overlay)) {
+            if (!(d->m_flags & (UMApplicationMonitorPrivate::Overlay
+                                | UMApplicationMonitorPrivate::Histograms))) {
                 d->stop();
             } else {
                 d->setMonitoringFlags(d->m_flags);
@@ -260,6 +425,85 @@ bool UMApplicationMonitor::logging()
     return !!(d_func()->m_flags & UMApplicationMonitorPrivate::Logging);
 }
 
+void UMApplicationMonitor::setHistograms(bool histograms)
+{
+    Q_D(UMApplicationMonitor);
+
+    if (!!(d->m_flags & UMApplicationMonitorPrivate::Histograms) != histograms) {
+        if (histograms) {
+            d->m_flags |= UMApplicationMonitorPrivate::Histograms;
+            if (!(d->m_flags & (UMApplicationMonitorPrivate::Started
+                                | UMApplicationMonitorPrivate::ClosingDown))) {
+                d->start();
+            } else {
+                resetHistograms();
+                d->setMonitoringFlags(d->m_flags);
+                d->updateSummaryTimer();
+            }
+        } else {
+            d->m_flags &= ~UMApplicationMonitorPrivate::Histograms;
+            if (!(d->m_flags & (UMApplicationMonitorPrivate::Overlay
+                                | UMApplicationMonitorPrivate::Logging))) {
+                d->stop();
+            } else {
+                d->setMonitoringFlags(d->m_flags);
+                d->updateSummaryTimer();
+            }
+        }
+        Q_EMIT histogramsChanged();
+    }
+}
+
+bool UMApplicationMonitor::histograms()
+{
+    return !!(d_func()->m_flags & UMApplicationMonitorPrivate::Histograms);
+}
+
+QList<quint32> UMApplicationMonitor::windowIds()
+{
+    Q_D(UMApplicationMonitor);
+
+    QList<quint32> ids;
+    d->m_monitorsMutex.lock();
+    for (int i = 0; i < d->m_monitorCount; ++i) {
+        DASSERT(d->m_monitors[i]);
+        ids.append(d->m_monitors[i]->id());
+    }
+    d->m_monitorsMutex.unlock();
+    return ids;
+}
+
+bool UMApplicationMonitor::windowHistograms(quint32 windowId, UMFrameHistograms* histograms)
+{
+    DASSERT(histograms);
+    Q_D(UMApplicationMonitor);
+
+    bool found = false;
+    d->m_monitorsMutex.lock();
+    for (int i = 0; i < d->m_monitorCount; ++i) {
+        DASSERT(d->m_monitors[i]);
+        if (d->m_monitors[i]->id() == windowId) {
+            d->m_monitors[i]->copyHistograms(histograms);
+            found = true;
+            break;
+        }
+    }
+    d->m_monitorsMutex.unlock();
+    return found;
+}
+
+void UMApplicationMonitor::resetHistograms()
+{
+    Q_D(UMApplicationMonitor);
+
+    d->m_monitorsMutex.lock();
+    for (int i = 0; i < d->m_monitorCount; ++i) {
+        DASSERT(d->m_monitors[i]);
+        d->m_monitors[i]->resetHistograms();
+    }
+    d->m_monitorsMutex.unlock();
+}
+
 void UMApplicationMonitorPrivate::startMonitoring(QQuickWindow* window)
 {
     DASSERT(window);
@@ -282,8 +526,9 @@ void UMApplicationMonitorPrivate::start()
     DASSERT(!(m_flags & Started));
     DASSERT(!m_loggingThread);
 
-    m_loggingThread = new LoggingThread;
+    m_loggingThread = new LoggingThread(m_overflowPolicy);
     m_loggingThread->setLoggers(m_loggers, m_loggerCount);
+    m_applicationQueue = m_loggingThread->createQueue(applicationQueueCapacity);
 
     QWindowList windows = QGuiApplication::allWindows();
     const int size = windows.size();
@@ -307,6 +552,7 @@ void UMApplicationMonitorPrivate::start()
     if (m_updateInterval[UMEvent::Process] >= 0) {
         m_processTimer.start();
     }
+    updateSummaryTimer();
 }
 
 bool UMApplicationMonitorPrivate::removeMonitor(WindowMonitor* monitor)
@@ -380,6 +626,7 @@ void UMApplicationMonitorPrivate::stop()
     if (m_updateInterval[UMEvent::Process] >= 0) {
         m_processTimer.stop();
     }
+    m_summaryTimer.stop();
 
     QGuiApplication::instance()->removeEventFilter(q_func());
 
@@ -389,9 +636,10 @@ void UMApplicationMonitorPrivate::stop()
     }
     m_monitorsMutex.unlock();
 
-    DASSERT(m_loggingThread);
-    m_loggingThread->deref();
-    m_loggingThread = nullptr;
+    m_applicationQueueMutex.lock();
+    m_applicationQueue->release();
+    m_applicationQueue = nullptr;
+    m_applicationQueueMutex.unlock();
 
     // Wait for window monitors complete deletion.
     m_monitorsMutex.lock();
@@ -404,6 +652,13 @@ void UMApplicationMonitorPrivate::stop()
     }
     m_monitorsMutex.unlock();
 
+    // All the queues are released at that point, the dropped events count
+    // can't change anymore.
+    DASSERT(m_loggingThread);
+    m_droppedEventCount += m_loggingThread->droppedEventCount();
+    m_loggingThread->deref();
+    m_loggingThread = nullptr;
+
     m_flags &= ~Started;
 }
 
@@ -572,7 +827,7 @@ bool UMApplicationMonitor::logGenericEvent(quint32 id, const char* string, quint
         // if used in qMin(); force type to satisfy it
         event.generic.stringSize = qMin(size, quint32(UMGenericEvent::maxStringSize));
         memcpy(event.generic.string, string, event.generic.stringSize);
-        d->m_loggingThread->push(&event);
+        d->pushApplicationEvent(&event);
         return true;
     } else {
         return false;
@@ -592,6 +847,26 @@ bool UMApplicationMonitor::logEvent(Event event)
     };
 }
 
+bool UMApplicationMonitor::logPaintNodeEvent(const UMPaintNodeEvent& paintNodeEvent)
+{
+    Q_D(UMApplicationMonitor);
+
+    if ((d->m_flags & UMApplicationMonitorPrivate::Logging) && (d->m_flags & PaintNodeEvent)) {
+        DASSERT(d->m_loggingThread);
+        UMEvent event;
+        event.type = UMEvent::PaintNode;
+        event.timeStamp = UMEventUtils::timeStamp();
+        memcpy(&event.paintNode, &paintNodeEvent, sizeof(UMPaintNodeEvent));
+        // Loggers expect null-terminated strings.
+        event.paintNode.className[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+        event.paintNode.objectName[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+        d->pushApplicationEvent(&event);
+        return true;
+    } else {
+        return false;
+    }
+}
+
 void UMApplicationMonitor::setUpdateInterval(UMEvent::Type type, int interval)
 {
     Q_D(UMApplicationMonitor);
@@ -612,6 +887,12 @@ void UMApplicationMonitor::setUpdateInterval(UMEvent::Type type, int interval)
             d->m_updateInterval[UMEvent::Process] = interval;
             Q_EMIT updateIntervalChanged(UMEvent::Process);
         }
+    } else if (type == UMEvent::Summary) {
+        if (interval != d->m_updateInterval[UMEvent::Summary]) {
+            d->m_updateInterval[UMEvent::Summary] = interval;
+            d->updateSummaryTimer();
+            Q_EMIT updateIntervalChanged(UMEvent::Summary);
+        }
     }
 }
 
@@ -620,6 +901,37 @@ int UMApplicationMonitor::updateInterval(UMEvent::Type type)
     return d_func()->m_updateInterval[type];
 }
 
+void UMApplicationMonitor::setOverflowPolicy(OverflowPolicy policy)
+{
+    Q_D(UMApplicationMonitor);
+
+    if (policy != d->m_overflowPolicy) {
+        d->m_overflowPolicy = policy;
+        if (d->m_flags & UMApplicationMonitorPrivate::Started) {
+            DASSERT(d->m_loggingThread);
+            d->m_loggingThread->setOverflowPolicy(policy);
+        }
+        Q_EMIT overflowPolicyChanged();
+    }
+}
+
+UMApplicationMonitor::OverflowPolicy UMApplicationMonitor::overflowPolicy()
+{
+    return d_func()->m_overflowPolicy;
+}
+
+quint64 UMApplicationMonitor::droppedEventCount()
+{
+    Q_D(UMApplicationMonitor);
+
+    if (d->m_flags & UMApplicationMonitorPrivate::Started) {
+        DASSERT(d->m_loggingThread);
+        return d->m_droppedEventCount + d->m_loggingThread->droppedEventCount();
+    } else {
+        return d->m_droppedEventCount;
+    }
+}
+
 void UMApplicationMonitor::closeDown()
 {
     Q_D(UMApplicationMonitor);
@@ -635,6 +947,66 @@ void UMApplicationMonitor::processTimeout()
     d_func()->processTimeout();
 }
 
+// Generic events can be logged from any thread, the application queue being a
+// single-producer queue, pushes are serialised. That doesn't impact rendering
+// since window monitors have their own queues.
+void UMApplicationMonitorPrivate::pushApplicationEvent(const UMEvent* event)
+{
+    DASSERT(event);
+
+    m_applicationQueueMutex.lock();
+    if (m_applicationQueue) {
+        m_applicationQueue->push(event);
+    }
+    m_applicationQueueMutex.unlock();
+}
+
+void UMApplicationMonitor::summaryTimeout()
+{
+    d_func()->summaryTimeout();
+}
+
+// The summary timer runs whenever histograms are enabled and the monitoring
+// started, summary events being only logged if requested.
+void UMApplicationMonitorPrivate::updateSummaryTimer()
+{
+    if ((m_flags & Started) && (m_flags & Histograms)
+        && m_updateInterval[UMEvent::Summary] >= 0) {
+        m_summaryTimer.setInterval(m_updateInterval[UMEvent::Summary]);
+        if (!m_summaryTimer.isActive()) {
+            m_summaryTimer.start();
+        }
+    } else {
+        m_summaryTimer.stop();
+    }
+}
+
+void UMApplicationMonitorPrivate::summaryTimeout()
+{
+    DASSERT(m_flags & Started);
+
+    // Interval histograms are merged into the cumulative ones by summarize(),
+    // which must run at each timeout even if summary events aren't logged.
+    // Events are pushed once the monitors are unlocked since pushing can block
+    // on the logging queue.
+    UMEvent events[maxMonitors];
+    int eventCount = 0;
+    m_monitorsMutex.lock();
+    for (int i = 0; i < m_monitorCount; ++i) {
+        DASSERT(m_monitors[i]);
+        if (m_monitors[i]->summarize(&events[eventCount])) {
+            eventCount++;
+        }
+    }
+    m_monitorsMutex.unlock();
+
+    if ((m_flags & Logging) && (m_flags & UMApplicationMonitor::SummaryEvent)) {
+        for (int i = 0; i < eventCount; ++i) {
+            pushApplicationEvent(&events[i]);
+        }
+    }
+}
+
 void UMApplicationMonitorPrivate::processTimeout()
 {
     DASSERT(m_flags & Started);
@@ -647,7 +1019,7 @@ void UMApplicationMonitorPrivate::processTimeout()
     if (processLogging || overlay) {
         m_eventUtils.updateProcessEvent(&m_processEvent);
         if (processLogging) {
-            m_loggingThread->push(&m_processEvent);
+            pushApplicationEvent(&m_processEvent);
         }
         if (overlay) {
             // FIXME(loicm) We've got two choices here, locking all the monitors
@@ -696,18 +1068,23 @@ static const char* const defaultOverlayText =
     "  VSZ mem. : %9vszMemory kB\n"
     "  RSS mem. : %9rssMemory kB\n"
     "   Threads : %9threadCount   \n"
-    " CPU usage : %9cpuUsage %% ";
+    " CPU usage : %9cpuUsage %%\n"
+    "   GUI CPU : %9guiCpuUsage %%\n"
+    "Render CPU : %9renderCpuUsage %% ";
 
 WindowMonitor::WindowMonitor(
     UMApplicationMonitor* applicationMonitor, QQuickWindow* window, LoggingThread* loggingThread,
     quint32 flags, quint32 id)
     : m_applicationMonitor(applicationMonitor)
     , m_loggingThread(loggingThread)
+    , m_queue(loggingThread->createQueue(windowQueueCapacity))
     , m_window(window)
     , m_overlay(defaultOverlayText, id)
     , m_id(id)
     , m_flags(flags)
     , m_frameSize(window->width(), window->height())
+    , m_pendingFrameHead(0)
+    , m_pendingFrameCount(0)
 {
     DASSERT(applicationMonitor == UMApplicationMonitor::instance());
     DASSERT(m_applicationMonitor);
@@ -746,7 +1123,7 @@ WindowMonitor::WindowMonitor(
         event.window.width = m_frameSize.width();
         event.window.height = m_frameSize.height();
         event.window.state = UMWindowEvent::Shown;
-        loggingThread->push(&event);
+        m_queue->push(&event);
     }
 }
 
@@ -763,9 +1140,10 @@ WindowMonitor::~WindowMonitor()
         event.window.width = m_frameSize.width();
         event.window.height = m_frameSize.height();
         event.window.state = UMWindowEvent::Hidden;
-        m_loggingThread->push(&event);
+        m_queue->push(&event);
     }
 
+    m_queue->release();
     m_loggingThread->deref();
 }
 
@@ -776,11 +1154,58 @@ void WindowMonitor::initializeGpuResources()
     // FIXME(loicm) We should actually provide an API call to let the user set
     //     that behavior programmatically.
     static bool noGpuTimer = qEnvironmentVariableIsSet("UM_NO_GPU_TIMER");
+    // The GPU timer is asynchronous by default, frame events are then logged
+    // a few frames later, once the GPU time is available. If the GPU can't be
+    // timed without stalling (no timer query support, only fences or the
+    // glFinish() fallback), GPU times are disabled like with UM_NO_GPU_TIMER
+    // unless UM_SYNC_GPU_TIMER is set.
+    static bool syncGpuTimer = qEnvironmentVariableIsSet("UM_SYNC_GPU_TIMER");
 
     m_overlay.initialize();
-    m_gpuTimer.initialize();
+    const bool gpuTimerAvailable = !noGpuTimer && m_gpuTimer.initialize(!syncGpuTimer);
     m_frameEvent.frame.number = 0;
-    m_flags |= GpuResourcesInitialized | (!noGpuTimer ? GpuTimerAvailable : 0);
+    m_frameEvent.frame.gpuTime = 0;
+    m_flags |= GpuResourcesInitialized | (gpuTimerAvailable ? GpuTimerAvailable : 0);
+}
+
+// Get the available asynchronous GPU timer results and log the frame events
+// waiting for them. Frame events without result (which can happen when the
+// logging flags change) are logged with a GPU time of 0.
+void WindowMonitor::collectGpuResults(bool wait)
+{
+    quint32 frameNumber;
+    quint64 gpuTime;
+    while (m_gpuTimer.popResult(&frameNumber, &gpuTime, wait)) {
+        wait = false;
+        m_frameEvent.frame.gpuTime = gpuTime;
+        if (m_flags & UMApplicationMonitorPrivate::Histograms) {
+            m_histogramsMutex.lock();
+            m_intervalHistograms.metrics[UMSummaryEvent::GpuTime].add(gpuTime);
+            m_histogramsMutex.unlock();
+        }
+        while (m_pendingFrameCount > 0) {
+            UMEvent* event = &m_pendingFrameEvents[m_pendingFrameHead];
+            if (event->frame.number > frameNumber) {
+                break;
+            }
+            if (event->frame.number == frameNumber) {
+                event->frame.gpuTime = gpuTime;
+            }
+            m_queue->push(event);
+            m_pendingFrameHead = (m_pendingFrameHead + 1) % maxPendingFrameEvents;
+            m_pendingFrameCount--;
+        }
+    }
+}
+
+void WindowMonitor::flushPendingFrameEvents()
+{
+    while (m_pendingFrameCount > 0) {
+        m_queue->push(&m_pendingFrameEvents[m_pendingFrameHead]);
+        m_pendingFrameHead = (m_pendingFrameHead + 1) % maxPendingFrameEvents;
+        m_pendingFrameCount--;
+    }
+    m_pendingFrameHead = 0;
 }
 
 void WindowMonitor::windowSceneGraphInitialized()
@@ -795,8 +1220,10 @@ void WindowMonitor::finalizeGpuResources()
     DASSERT(m_flags & GpuResourcesInitialized);
 
     if (m_flags & GpuTimerAvailable) {
+        collectGpuResults(true);
         m_gpuTimer.finalize();
     }
+    flushPendingFrameEvents();
     m_overlay.finalize();
 
     m_frameEvent.frame.number = 0;
@@ -838,11 +1265,26 @@ void WindowMonitor::windowBeforeRendering()
             event.window.width = frameSize.width();
             event.window.height = frameSize.height();
             event.window.state = UMWindowEvent::Resized;
-            m_loggingThread->push(&event);
+            // Frame events still waiting for their GPU times were rendered
+            // before the resize, log them first to keep the events ordered.
+            if (m_pendingFrameCount > 0) {
+                if (m_flags & GpuTimerAvailable) {
+                    while (m_gpuTimer.pendingCount() > 0) {
+                        collectGpuResults(true);
+                    }
+                }
+                flushPendingFrameEvents();
+            }
+            m_queue->push(&event);
         }
     }
 
     if (m_flags & GpuResourcesInitialized) {
+        if (m_flags & GpuTimerAvailable) {
+            // Get the results of the previous frames, only waiting if the
+            // query ring is full (the GPU being more than a few frames late).
+            collectGpuResults(m_gpuTimer.pendingCount() == GPUTimer::maxPendingQueries);
+        }
         m_sceneGraphTimer.start();
         if (m_flags & GpuTimerAvailable) {
             m_gpuTimer.start();
@@ -854,8 +1296,18 @@ void WindowMonitor::windowAfterRendering()
 {
     if (m_flags & GpuResourcesInitialized) {
         m_frameEvent.frame.renderTime = m_sceneGraphTimer.nsecsElapsed();
-        m_frameEvent.frame.gpuTime = (m_flags & GpuTimerAvailable) ? m_gpuTimer.stop() : 0;
         m_frameEvent.frame.number++;
+        if (m_flags & GpuTimerAvailable) {
+            // The asynchronous timer returns 0, the GPU time displayed by the
+            // overlay is then the last one available.
+            if (m_gpuTimer.isAsynchronous()) {
+                m_gpuTimer.stop(m_frameEvent.frame.number);
+            } else {
+                m_frameEvent.frame.gpuTime = m_gpuTimer.stop();
+            }
+        } else {
+            m_frameEvent.frame.gpuTime = 0;
+        }
         if (m_flags & UMApplicationMonitorPrivate::Overlay) {
             m_mutex.lock();
             m_overlay.render(m_frameEvent, m_frameSize);
@@ -870,11 +1322,27 @@ void WindowMonitor::windowFrameSwapped()
     if (m_flags & GpuResourcesInitialized) {
         m_frameEvent.frame.deltaTime = m_deltaTimer.isValid() ? m_deltaTimer.nsecsElapsed() : 0;
         m_deltaTimer.start();
+        m_frameEvent.frame.swapTime = m_sceneGraphTimer.nsecsElapsed();
+        if (m_flags & UMApplicationMonitorPrivate::Histograms) {
+            recordFrameHistograms();
+        }
         if ((m_flags & UMApplicationMonitorPrivate::Logging) &&
             (m_flags & UMApplicationMonitor::FrameEvent)) {
-            m_frameEvent.frame.swapTime = m_sceneGraphTimer.nsecsElapsed();
             m_frameEvent.timeStamp = UMEventUtils::timeStamp();
-            m_loggingThread->push(&m_frameEvent);
+            if ((m_flags & GpuTimerAvailable) && m_gpuTimer.isAsynchronous()) {
+                // Keep the event until its GPU time is available.
+                if (m_pendingFrameCount == maxPendingFrameEvents) {
+                    m_queue->push(&m_pendingFrameEvents[m_pendingFrameHead]);
+                    m_pendingFrameHead = (m_pendingFrameHead + 1) % maxPendingFrameEvents;
+                    m_pendingFrameCount--;
+                }
+                UMEvent* event = &m_pendingFrameEvents[
+                    (m_pendingFrameHead + m_pendingFrameCount++) % maxPendingFrameEvents];
+                memcpy(event, &m_frameEvent, sizeof(UMEvent));
+                event->frame.gpuTime = 0;
+            } else {
+                m_queue->push(&m_frameEvent);
+            }
         }
     } else {
         initializeGpuResources();  // Get everything ready for the next frame.
@@ -884,6 +1352,78 @@ void WindowMonitor::windowFrameSwapped()
     }
 }
 
+// Asynchronous GPU times are recorded in collectGpuResults().
+void WindowMonitor::recordFrameHistograms()
+{
+    m_histogramsMutex.lock();
+    if (m_frameEvent.frame.deltaTime > 0) {
+        m_intervalHistograms.metrics[UMSummaryEvent::DeltaTime].add(m_frameEvent.frame.deltaTime);
+    }
+    m_intervalHistograms.metrics[UMSummaryEvent::SyncTime].add(m_frameEvent.frame.syncTime);
+    m_intervalHistograms.metrics[UMSummaryEvent::RenderTime].add(m_frameEvent.frame.renderTime);
+    m_intervalHistograms.metrics[UMSummaryEvent::SwapTime].add(m_frameEvent.frame.swapTime);
+    if ((m_flags & GpuTimerAvailable) && !m_gpuTimer.isAsynchronous()) {
+        m_intervalHistograms.metrics[UMSummaryEvent::GpuTime].add(m_frameEvent.frame.gpuTime);
+    }
+    m_histogramsMutex.unlock();
+}
+
+// Fill a summary event with the percentiles of the frames rendered since the
+// last call and merge them into the cumulative histograms. Returns false if no
+// frames have been rendered in the meantime.
+bool WindowMonitor::summarize(UMEvent* event)
+{
+    DASSERT(event);
+
+    QMutexLocker locker(&m_histogramsMutex);
+
+    const quint64 frameCount =
+        m_intervalHistograms.metrics[UMSummaryEvent::RenderTime].count();
+    if (frameCount == 0) {
+        return false;
+    }
+
+    memset(event, 0, sizeof(UMEvent));
+    event->type = UMEvent::Summary;
+    event->timeStamp = UMEventUtils::timeStamp();
+    event->summary.window = m_id;
+    event->summary.frameCount = static_cast<quint32>(qMin(frameCount, Q_UINT64_C(0xffffffff)));
+    for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+        UMHistogram* histogram = &m_intervalHistograms.metrics[i];
+        const quint64 maxValue = Q_UINT64_C(0xffffffff);
+        event->summary.p50[i] = static_cast<quint32>(qMin(histogram->percentile(50.0f), maxValue));
+        event->summary.p95[i] = static_cast<quint32>(qMin(histogram->percentile(95.0f), maxValue));
+        event->summary.p99[i] = static_cast<quint32>(qMin(histogram->percentile(99.0f), maxValue));
+        event->summary.max[i] = static_cast<quint32>(qMin(histogram->max(), maxValue));
+        m_histograms.metrics[i].add(*histogram);
+        histogram->reset();
+    }
+
+    return true;
+}
+
+void WindowMonitor::copyHistograms(UMFrameHistograms* histograms)
+{
+    DASSERT(histograms);
+
+    m_histogramsMutex.lock();
+    for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+        histograms->metrics[i] = m_histograms.metrics[i];
+        histograms->metrics[i].add(m_intervalHistograms.metrics[i]);
+    }
+    m_histogramsMutex.unlock();
+}
+
+void WindowMonitor::resetHistograms()
+{
+    m_histogramsMutex.lock();
+    for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+        m_histograms.metrics[i].reset();
+        m_intervalHistograms.metrics[i].reset();
+    }
+    m_histogramsMutex.unlock();
+}
+
 void WindowMonitor::windowSceneGraphAboutToStop()
 {
 #if !defined(QT_NO_DEBUG)
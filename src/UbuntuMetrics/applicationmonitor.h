@@ -22,6 +22,7 @@
 
 #include <UbuntuMetrics/logger.h>
 #include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/histogram.h>
 #include <UbuntuMetrics/ubuntumetricsglobal.h>
 
 class UMApplicationMonitorPrivate;
@@ -43,8 +44,13 @@ public:
         FrameEvent   = (1 << 2),
         // Allow generic events logging.
         GenericEvent = (1 << 3),
+        // Allow summary events logging.
+        SummaryEvent = (1 << 4),
+        // Allow paint node events logging.
+        PaintNodeEvent = (1 << 5),
         // Allow all events logging.
-        AllEvents    = (ProcessEvent | WindowEvent | FrameEvent | GenericEvent)
+        AllEvents    = (ProcessEvent | WindowEvent | FrameEvent | GenericEvent | SummaryEvent
+                        | PaintNodeEvent)
     };
     Q_DECLARE_FLAGS(LoggingFilters, LoggingFilter)
 
@@ -55,6 +61,15 @@ public:
         UserInterfaceReady = 0
     };
 
+    enum OverflowPolicy {
+        // Drop the oldest queued event to make room for the new one.
+        DropOldest = 0,
+        // Drop the new event.
+        DropNewest = 1,
+        // Block the producing thread until the logging thread makes room.
+        Block      = 2
+    };
+
     // Get the unique UMApplicationMonitor instance. A QGuiApplication instance
     // must be running.
     static UMApplicationMonitor* instance() { return self ? self : new UMApplicationMonitor; }
@@ -77,6 +92,16 @@ public:
     bool removeLogger(UMLogger* logger, bool free = true);
     void clearLoggers(bool free = true);
 
+    // Set the policy applied when a thread logs an event while its logging
+    // queue is full. Each window (and the application itself) has its own
+    // queue drained asynchronously by the logging thread. Default is Block.
+    void setOverflowPolicy(OverflowPolicy policy);
+    OverflowPolicy overflowPolicy();
+
+    // Get the number of events dropped because of full logging queues since
+    // the creation of the application monitor. Always 0 with the Block policy.
+    quint64 droppedEventCount();
+
     // Generic event system allowing to log application specific
     // events. registerGenericEvent() returns a unique integer id to be used as
     // first argument to logGenericEvent(). logGenericEvent() logs a generic
@@ -92,23 +117,48 @@ public:
     // event system.
     bool logEvent(Event event);
 
+    // Log the updatePaintNode() call of an item during a slow frame. Can be
+    // called from any thread. Does not log and returns false if logging is
+    // disabled or if the logging filter does not contain PaintNodeEvent.
+    bool logPaintNodeEvent(const UMPaintNodeEvent& event);
+
     // Set the time in milliseconds between two updates of events of a given
-    // type. -1 to disable updates. Only UMEvent::Process is accepted so far as
-    // event type, default value is 1000. Note that when the overlay is enabled,
-    // a process update triggers a frame update.
+    // type. -1 to disable updates. Only UMEvent::Process and UMEvent::Summary
+    // are accepted so far as event type, default values are 1000 and 5000. Note
+    // that when the overlay is enabled, a process update triggers a frame
+    // update.
     void setUpdateInterval(UMEvent::Type type, int interval);
     int updateInterval(UMEvent::Type type);
 
+    // Aggregate the frame metrics of each window in histograms. Disabled by
+    // default. When enabled, summary events with the percentiles of the frames
+    // rendered since the previous summary are logged at the UMEvent::Summary
+    // update interval.
+    void setHistograms(bool histograms);
+    bool histograms();
+
+    // Get the ids of the monitored windows.
+    QList<quint32> windowIds();
+
+    // Copy the frame histograms of a monitored window. The histograms contain
+    // the frames rendered since the histograms were enabled or reset. Returns
+    // false if the window isn't monitored.
+    bool windowHistograms(quint32 windowId, UMFrameHistograms* histograms);
+    void resetHistograms();
+
 Q_SIGNALS:
     void overlayChanged();
     void loggingChanged();
     void loggingFilterChanged();
     void loggersChanged();
+    void overflowPolicyChanged();
     void updateIntervalChanged(UMEvent::Type type);
+    void histogramsChanged();
 
 private Q_SLOTS:
     void closeDown();
     void processTimeout();
+    void summaryTimeout();
 
 private:
     static UMApplicationMonitor* self;
@@ -27,11 +27,13 @@
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QRunnable>
 #include <QtCore/QAtomicInteger>
+#include <QtCore/QVector>
 
 #include <UbuntuMetrics/private/overlay_p.h>
 #include <UbuntuMetrics/private/gputimer_p.h>
 #include <UbuntuMetrics/private/ubuntumetricsglobal_p.h>
 
+class EventQueue;
 class LoggingThread;
 class WindowMonitor;
 class QQuickWindow;
@@ -52,6 +54,7 @@ public:
         Logging     = (1 << 9),
         Started     = (1 << 10),
         ClosingDown = (1 << 11),
+        Histograms  = (1 << 12),
         // Higher bit allowed is (1 << 15).
         FilterMask             = 0x000000ff,
         ApplicationMonitorMask = 0x0000ff00,
@@ -69,6 +72,9 @@ public:
     bool hasMonitor(WindowMonitor* monitor);
     void setMonitoringFlags(quint32 flags);
     void processTimeout();
+    void summaryTimeout();
+    void updateSummaryTimer();
+    void pushApplicationEvent(const UMEvent* event);
 
     UMApplicationMonitor* const q_ptr;
     Q_DECLARE_PUBLIC(UMApplicationMonitor)
@@ -76,46 +82,115 @@ public:
     WindowMonitor* m_monitors[maxMonitors];
     UMLogger* m_loggers[maxLoggers];
     LoggingThread* m_loggingThread;
+    EventQueue* m_applicationQueue;
 #if !defined(QT_NO_DEBUG)
     QGuiApplication* m_application;
 #endif
     UMEventUtils m_eventUtils;
     QTimer m_processTimer;
+    QTimer m_summaryTimer;
     QMutex m_monitorsMutex;
+    QMutex m_applicationQueueMutex;
+    quint64 m_droppedEventCount;
     int m_monitorCount;
     int m_loggerCount;
     int m_updateInterval[UMEvent::TypeCount];
     quint32 m_flags;
+    UMApplicationMonitor::OverflowPolicy m_overflowPolicy;
     alignas(64) UMEvent m_processEvent;
 };
 
+// Wait-free single-producer/single-consumer ring buffer of events. Each
+// producer (a window monitor on its render thread, the application monitor on
+// the GUI thread) gets its own queue so that pushing an event doesn't take a
+// lock, unless the logging thread has to be woken up. The logging thread is
+// the only consumer and drains queues in batches. Head and tail are free-running indices, the capacity must be a
+// power-of-two.
+class UBUNTU_METRICS_PRIVATE_EXPORT EventQueue
+{
+public:
+    EventQueue(LoggingThread* loggingThread, int capacity);
+    ~EventQueue();
+
+    // Producer side. release() must be called once the producer is done with
+    // the queue, the logging thread deletes it after having drained the
+    // remaining events.
+    void push(const UMEvent* event);
+    void release();
+
+    // Consumer side. pop() copies at most maxCount of the oldest events to
+    // events and returns the number of events copied.
+    int pop(UMEvent* events, int maxCount);
+    bool isEmpty() const { return m_tail.loadAcquire() == m_head.loadAcquire(); }
+    bool isReleased() const { return !!m_released.loadAcquire(); }
+    quint32 droppedEventCount() const { return m_droppedEventCount.loadAcquire(); }
+
+private:
+    LoggingThread* m_loggingThread;
+    UMEvent* m_events;
+    quint32 m_mask;
+    QAtomicInteger<quint32> m_droppedEventCount;
+    QAtomicInteger<quint32> m_released;
+    // Written by the consumer (and by the producer when dropping the oldest
+    // events). Both indices are on their own cache line to avoid false sharing.
+    alignas(64) QAtomicInteger<quint32> m_head;
+    // Written by the producer only.
+    alignas(64) QAtomicInteger<quint32> m_tail;
+};
+
 class UBUNTU_METRICS_PRIVATE_EXPORT LoggingThread : public QThread
 {
 public:
-    LoggingThread();
+    LoggingThread(UMApplicationMonitor::OverflowPolicy policy);
 
     void run() override;
-    void push(const UMEvent* event);
     void setLoggers(UMLogger** loggers, int count);
     LoggingThread* ref();
     void deref();
 
+    // Create a new event queue drained by the logging thread. Thread-safe.
+    EventQueue* createQueue(int capacity);
+
+    // Wake up the logging thread if it's waiting. Lock-free unless the thread
+    // is actually waiting. When urgent is false, the thread is only woken up
+    // if it's waiting with all the queues empty, not if it's waiting for more
+    // events to log them in batches.
+    void wakeUp(bool urgent = true);
+
+    void setOverflowPolicy(UMApplicationMonitor::OverflowPolicy policy) {
+        m_overflowPolicy.storeRelease(policy);
+    }
+    UMApplicationMonitor::OverflowPolicy overflowPolicy() const {
+        return static_cast<UMApplicationMonitor::OverflowPolicy>(m_overflowPolicy.loadAcquire());
+    }
+
+    // Get the number of events dropped by all the queues created so far.
+    quint64 droppedEventCount();
+
 private:
     enum {
-        Waiting       = (1 << 0),
-        JoinRequested = (1 << 1)
+        JoinRequested = (1 << 0)
+    };
+
+    // Values of m_waiting.
+    enum {
+        NotWaiting = 0,
+        IdleWaiting = 1,
+        BatchWaiting = 2
     };
 
     ~LoggingThread();
+    bool hasPendingQueue();
 
-    UMEvent* m_queue;
+    QVector<EventQueue*> m_queues;
     UMLogger* m_loggers[UMApplicationMonitorPrivate::maxLoggers];
     int m_loggerCount;
+    quint64 m_droppedEventCount;
     QMutex m_mutex;
     QWaitCondition m_condition;
     QAtomicInteger<quint32> m_refCount;
-    qint8 m_queueIndex;
-    qint8 m_queueSize;
+    QAtomicInteger<quint32> m_waiting;
+    QAtomicInt m_overflowPolicy;
     quint8 m_flags;
 };
 
@@ -169,8 +244,14 @@ public:
     ~WindowMonitor();
 
     QQuickWindow* window() const { return m_window; }
+    quint32 id() const { return m_id; }
     void setProcessEvent(const UMEvent& event);
 
+    // Histograms accessors, can be called from any thread.
+    bool summarize(UMEvent* event);
+    void copyHistograms(UMFrameHistograms* histograms);
+    void resetHistograms();
+
 private Q_SLOTS:
     void windowSceneGraphInitialized();
     void windowSceneGraphInvalidated();
@@ -190,25 +271,40 @@ private:
         // Higher bit allowed is (1 << 31).
     };
 
+    static const int maxPendingFrameEvents = 2 * GPUTimer::maxPendingQueries;
+
     bool gpuResourcesInitialized() const { return m_flags & GpuResourcesInitialized; }
     void setFlags(quint32 flags) {
         m_flags = (m_flags & UMApplicationMonitorPrivate::WindowMonitorMask) | flags;
     }
     void initializeGpuResources();
     void finalizeGpuResources();
+    void collectGpuResults(bool wait);
+    void recordFrameHistograms();
+    void flushPendingFrameEvents();
 
     UMApplicationMonitor* m_applicationMonitor;
     LoggingThread* m_loggingThread;
+    EventQueue* m_queue;
     QQuickWindow* m_window;
     GPUTimer m_gpuTimer;
     Overlay m_overlay;  // Accessed from different threads (needs locking).
     QMutex m_mutex;
+    // Frame histograms since the last summary and before, accessed from
+    // different threads.
+    QMutex m_histogramsMutex;
+    UMFrameHistograms m_intervalHistograms;
+    UMFrameHistograms m_histograms;
     QElapsedTimer m_sceneGraphTimer;
     QElapsedTimer m_deltaTimer;
     quint32 m_id;
     quint32 m_flags;
     QSize m_frameSize;
     UMEvent m_frameEvent;
+    // Frame events waiting for the results of the asynchronous GPU timer.
+    UMEvent m_pendingFrameEvents[maxPendingFrameEvents];
+    int m_pendingFrameHead;
+    int m_pendingFrameCount;
 
     friend class WindowMonitorDeleter;
     friend class WindowMonitorFlagSetter;
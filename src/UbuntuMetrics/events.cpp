@@ -20,7 +20,9 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <cstdio>
+#include <cstdlib>
 
 #include <QtCore/QElapsedTimer>
 
@@ -28,6 +30,21 @@
 
 const int bufferSize = 128;
 const int bufferAlignment = 64;
+const int threadBufferSize = 4096;
+
+// Keep in sync with UMProcessEvent::Thread! Names are matched against the
+// beginning of /proc/self/task/*/comm, which is truncated to 15 characters.
+// The GUI thread is the main thread, it's found from the process id.
+static const struct {
+    const char* const name;
+    int size;
+} threadInfo[] = {
+    { nullptr,           0                             },
+    { "QSGRenderThread", sizeof("QSGRenderThread") - 1 },
+    { "QQmlThread",      sizeof("QQmlThread") - 1      },
+    { "UbuntuMetrics",   sizeof("UbuntuMetrics") - 1   }
+};
+Q_STATIC_ASSERT(ARRAY_SIZE(threadInfo) == UMProcessEvent::ThreadCount);
 
 UMEventUtils::UMEventUtils()
     : d_ptr(new EventUtilsPrivate)
@@ -45,6 +62,8 @@ EventUtilsPrivate::EventUtilsPrivate()
     m_cpuTicks = times(&m_cpuTimes);
     m_cpuOnlineCores = sysconf(_SC_NPROCESSORS_ONLN);
     m_pageSize = sysconf(_SC_PAGESIZE);
+    memset(m_threads, 0, sizeof(m_threads));
+    m_threadSearchCount = 0;
 }
 
 UMEventUtils::~UMEventUtils()
@@ -64,8 +83,9 @@ void UMEventUtils::updateProcessEvent(UMEvent* event)
 
     event->type = UMEvent::Process;
     event->timeStamp = UMEventUtils::timeStamp();
-    d->updateCpuUsage(event);
+    // Thread count is needed by the CPU usage update to find the threads.
     d->updateProcStatMetrics(event);
+    d->updateCpuUsage(event);
 }
 
 void EventUtilsPrivate::updateCpuUsage(UMEvent* event)
@@ -82,6 +102,7 @@ void EventUtilsPrivate::updateCpuUsage(UMEvent* event)
         const clock_t userTime = newCpuTimes.tms_utime - m_cpuTimes.tms_utime;
         const clock_t systemTime = newCpuTimes.tms_stime - m_cpuTimes.tms_stime;
         event->process.cpuUsage = ((userTime + systemTime) * 100) / (ticks * m_cpuOnlineCores);
+        updateThreadMetrics(event, ticks);
         m_cpuTimer.start();
         memcpy(&m_cpuTimes, &newCpuTimes, sizeof(struct tms));
         m_cpuTicks = newTicks;
@@ -145,6 +166,154 @@ void EventUtilsPrivate::updateProcStatMetrics(UMEvent* event)
     close(fd);
 }
 
+// Reads the CPU time in clock ticks (user and system) and the context switches
+// count (voluntary and involuntary) of a thread of the process. Returns false
+// if the thread doesn't exist anymore.
+static bool threadStats(pid_t id, quint64* cpuTime, quint64* contextSwitches)
+{
+    DASSERT(cpuTime);
+    DASSERT(contextSwitches);
+
+    char buffer[threadBufferSize];
+    char path[64];
+
+    // utime and stime are the 14th and 15th entries of the stat file. The
+    // thread name (2nd entry) can contain spaces, so count from its closing
+    // parenthesis.
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", id);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    int readSize = read(fd, buffer, threadBufferSize - 1);
+    close(fd);
+    if (readSize <= 0) {
+        return false;
+    }
+    buffer[readSize] = '\0';
+    const char* entry = strrchr(buffer, ')');
+    if (!entry) {
+        DNOT_REACHED();
+        return false;
+    }
+    const int utimeEntry = 14;
+    int spaceCount = 0;
+    while (spaceCount < utimeEntry - 2 && *entry != '\0') {
+        if (*entry++ == ' ') {
+            spaceCount++;
+        }
+    }
+    unsigned long long utime, stime;
+    if (sscanf(entry, "%llu %llu", &utime, &stime) != 2) {
+        DNOT_REACHED();  // Missing entries in the stat file.
+        return false;
+    }
+    *cpuTime = utime + stime;
+
+    // Context switches aren't in the stat file, get them from the status file.
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", id);
+    if ((fd = open(path, O_RDONLY)) == -1) {
+        return false;
+    }
+    readSize = read(fd, buffer, threadBufferSize - 1);
+    close(fd);
+    if (readSize <= 0) {
+        return false;
+    }
+    buffer[readSize] = '\0';
+    const char* voluntary = strstr(buffer, "\nvoluntary_ctxt_switches:");
+    const char* involuntary = strstr(buffer, "\nnonvoluntary_ctxt_switches:");
+    if (!voluntary || !involuntary) {
+        DNOT_REACHED();  // Consider increasing threadBufferSize.
+        return false;
+    }
+    *contextSwitches =
+        strtoull(&voluntary[sizeof("\nvoluntary_ctxt_switches:") - 1], nullptr, 10)
+        + strtoull(&involuntary[sizeof("\nnonvoluntary_ctxt_switches:") - 1], nullptr, 10);
+
+    return true;
+}
+
+void EventUtilsPrivate::findThreads(quint16 threadCount)
+{
+    DIR* directory = opendir("/proc/self/task");
+    if (!directory) {
+        DWARN("EventUtils: can't open '/proc/self/task'");
+        return;
+    }
+
+    pid_t ids[UMProcessEvent::ThreadCount] = { getpid(), 0, 0, 0 };
+    char path[64];
+    char name[16];
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        const pid_t id = atoi(entry->d_name);
+        snprintf(path, sizeof(path), "/proc/self/task/%d/comm", id);
+        const int fd = open(path, O_RDONLY);
+        if (fd == -1) {
+            continue;
+        }
+        const int nameSize = read(fd, name, sizeof(name));
+        close(fd);
+        // There can be several threads with the same name (one render thread
+        // per window for instance), the first one found is monitored.
+        for (int i = UMProcessEvent::GuiThread + 1; i < UMProcessEvent::ThreadCount; i++) {
+            if (ids[i] == 0 && nameSize > threadInfo[i].size
+                && !strncmp(name, threadInfo[i].name, threadInfo[i].size)) {
+                ids[i] = id;
+                break;
+            }
+        }
+    }
+    closedir(directory);
+
+    // Start measuring from now for newly found threads.
+    for (int i = 0; i < UMProcessEvent::ThreadCount; i++) {
+        if (ids[i] != m_threads[i].id) {
+            m_threads[i].id = ids[i];
+            if (ids[i] != 0
+                && !threadStats(ids[i], &m_threads[i].cpuTime, &m_threads[i].contextSwitches)) {
+                m_threads[i].id = 0;
+            }
+        }
+    }
+    m_threadSearchCount = threadCount;
+}
+
+void EventUtilsPrivate::updateThreadMetrics(UMEvent* event, clock_t ticks)
+{
+    DASSERT(ticks > 0);
+
+    // Threads are only searched when their count changes, listing and reading
+    // the names of all the tasks is too expensive to be done at each update.
+    if (event->process.threadCount != m_threadSearchCount) {
+        findThreads(event->process.threadCount);
+    }
+
+    for (int i = 0; i < UMProcessEvent::ThreadCount; i++) {
+        quint64 cpuTime, contextSwitches;
+        if (m_threads[i].id != 0
+            && threadStats(m_threads[i].id, &cpuTime, &contextSwitches)) {
+            event->process.threadCpuUsage[i] = ((cpuTime - m_threads[i].cpuTime) * 100) / ticks;
+            event->process.threadContextSwitches[i] =
+                contextSwitches - m_threads[i].contextSwitches;
+            m_threads[i].cpuTime = cpuTime;
+            m_threads[i].contextSwitches = contextSwitches;
+        } else {
+            if (m_threads[i].id != 0) {
+                // The thread exited, search again at next update.
+                m_threads[i].id = 0;
+                m_threadSearchCount = 0;
+            }
+            event->process.threadCpuUsage[i] = 0;
+            event->process.threadContextSwitches[i] = 0;
+        }
+    }
+}
+
 // static.
 quint64 UMEventUtils::timeStamp()
 {
@@ -26,6 +26,12 @@
 
 struct UBUNTU_METRICS_EXPORT UMProcessEvent
 {
+    // Threads monitored individually, identified by their name (as set by
+    // QThread from the object name) or by being the main thread.
+    enum Thread {
+        GuiThread = 0, RenderThread = 1, QmlThread = 2, LoggerThread = 3, ThreadCount = 4
+    };
+
     // Virtual size of the process in kilobytes.
     quint32 vszMemory;
 
@@ -39,9 +45,17 @@ struct UBUNTU_METRICS_EXPORT UMProcessEvent
     // Number of threads at buffer swap.
     quint16 threadCount;
 
+    // CPU usage of the monitored threads as a percentage of one core, indexed
+    // by Thread. 0 if the thread isn't running.
+    quint16 threadCpuUsage[ThreadCount];
+
+    // Number of context switches (voluntary and involuntary) of the monitored
+    // threads since the previous CPU usage update, indexed by Thread.
+    quint32 threadContextSwitches[ThreadCount];
+
     // The whole struct must take 112 bytes to allow future additions and best
     // memory alignment, don't forget to update when adding new metrics.
-    quint8 __reserved[/*12 bytes taken,*/ 100 /*bytes free*/];
+    quint8 __reserved[/*36 bytes taken,*/ 76 /*bytes free*/];
 };
 Q_STATIC_ASSERT(sizeof(UMProcessEvent) == 112);
 
@@ -118,9 +132,62 @@ struct UBUNTU_METRICS_EXPORT UMGenericEvent
 };
 Q_STATIC_ASSERT(sizeof(UMGenericEvent) == 112);
 
+struct UBUNTU_METRICS_EXPORT UMSummaryEvent
+{
+    enum Metric {
+        DeltaTime = 0, SyncTime = 1, RenderTime = 2, GpuTime = 3, SwapTime = 4, MetricCount = 5
+    };
+
+    // The id of the window on which the frames have been rendered.
+    quint32 window;
+
+    // Number of frames rendered since the previous summary.
+    quint32 frameCount;
+
+    // 50th, 95th and 99th percentiles and maximum values in nanoseconds of the
+    // frame metrics (see UMFrameEvent) since the previous summary, indexed by
+    // Metric. Values are clamped to 2^32 - 1.
+    quint32 p50[MetricCount];
+    quint32 p95[MetricCount];
+    quint32 p99[MetricCount];
+    quint32 max[MetricCount];
+
+    // The whole struct must take 112 bytes to allow future additions and best
+    // memory alignment, don't forget to update when adding new metrics.
+    quint8 __reserved[/*88 bytes taken,*/ 24 /*bytes free*/];
+};
+Q_STATIC_ASSERT(sizeof(UMSummaryEvent) == 112);
+
+struct UBUNTU_METRICS_EXPORT UMPaintNodeEvent
+{
+    static const int maxNameSize = 44;
+
+    // Id of the slow frame, shared by the events of all the items updated
+    // during that frame.
+    quint32 frame;
+
+    // Number of updatePaintNode() calls recorded during the frame.
+    quint32 itemCount;
+
+    // Time in nanoseconds taken by the frame.
+    quint64 frameTime;
+
+    // Time in nanoseconds spent in the updatePaintNode() call of the item.
+    quint64 time;
+
+    // Null-terminated class name and object name of the item, truncated to
+    // maxNameSize (with the null-terminating character).
+    char className[maxNameSize];
+    char objectName[maxNameSize];
+};
+Q_STATIC_ASSERT(sizeof(UMPaintNodeEvent) == 112);
+
 struct UBUNTU_METRICS_EXPORT UMEvent
 {
-    enum Type { Process = 0, Window = 1, Frame = 2, Generic = 3, TypeCount = 4 };
+    enum Type {
+        Process = 0, Window = 1, Frame = 2, Generic = 3, Summary = 4, PaintNode = 5,
+        TypeCount = 6
+    };
 
     // Event type.
     Type type;
@@ -133,6 +200,8 @@ struct UBUNTU_METRICS_EXPORT UMEvent
         UMWindowEvent window;
         UMFrameEvent frame;
         UMGenericEvent generic;
+        UMSummaryEvent summary;
+        UMPaintNodeEvent paintNode;
     };
 };
 Q_STATIC_ASSERT(sizeof(UMEvent) == 128);
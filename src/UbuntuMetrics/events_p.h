@@ -21,6 +21,7 @@
 #include <UbuntuMetrics/events.h>
 
 #include <sys/times.h>
+#include <sys/types.h>
 
 #include <QtCore/QElapsedTimer>
 
@@ -34,8 +35,16 @@ public:
 
     void updateCpuUsage(UMEvent* event);
     void updateProcStatMetrics(UMEvent* event);
+    void updateThreadMetrics(UMEvent* event, clock_t ticks);
+    void findThreads(quint16 threadCount);
 
     char* m_buffer;
+    struct {
+        pid_t id;
+        quint64 cpuTime;
+        quint64 contextSwitches;
+    } m_threads[UMProcessEvent::ThreadCount];
+    quint16 m_threadSearchCount;
     QElapsedTimer m_cpuTimer;
     struct tms m_cpuTimes;
     clock_t m_cpuTicks;
@@ -24,8 +24,54 @@
 #if !defined(QT_OPENGL_ES) && !defined(GL_TIME_ELAPSED)
 #define GL_TIME_ELAPSED 0x88BF  // For GL_EXT_timer_query.
 #endif
+#if !defined(GL_QUERY_RESULT_AVAILABLE)
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#if defined(QT_OPENGL_ES)
+// For GL_EXT_disjoint_timer_query.
+#if !defined(GL_QUERY_RESULT_EXT)
+#define GL_QUERY_RESULT_EXT 0x8866
+#endif
+#if !defined(GL_QUERY_RESULT_AVAILABLE_EXT)
+#define GL_QUERY_RESULT_AVAILABLE_EXT 0x8867
+#endif
+#if !defined(GL_TIMESTAMP_EXT)
+#define GL_TIMESTAMP_EXT 0x8E28
+#endif
+#if !defined(GL_GPU_DISJOINT_EXT)
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+#endif
+
+// static
+GPUTimer::Type GPUTimer::selectType(quint32 types, bool asynchronous)
+{
+    // Ordered by preference. OpenGL ES and OpenGL types are never set together.
+    static const Type asynchronousTypes[] = {
+        EXTDisjointTimerQuery, ARBTimerQuery, EXTTimerQuery
+    };
+    static const Type synchronousTypes[] = {
+        ARBTimerQuery, EXTTimerQuery, KHRFence, NVFence
+    };
+
+    if (asynchronous) {
+        for (Type type : asynchronousTypes) {
+            if (types & (1 << type)) {
+                return type;
+            }
+        }
+        return Unset;
+    } else {
+        for (Type type : synchronousTypes) {
+            if (types & (1 << type)) {
+                return type;
+            }
+        }
+        return Finish;
+    }
+}
 
-void GPUTimer::initialize()
+bool GPUTimer::initialize(bool asynchronous)
 {
     DASSERT(QOpenGLContext::currentContext());
     DASSERT(m_type == Unset);
@@ -34,17 +80,103 @@ void GPUTimer::initialize()
     m_context = QOpenGLContext::currentContext();
 #endif
 
+    m_asynchronous = false;
+    m_head = 0;
+    m_pendingCount = 0;
+
+    quint32 types = 0;
 #if defined(QT_OPENGL_ES)
     QList<QByteArray> eglExtensions = QByteArray(
         static_cast<const char*>(
             eglQueryString(eglGetCurrentDisplay(), EGL_EXTENSIONS))).split(' ');
     QList<QByteArray> glExtensions = QByteArray(
         reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS))).split(' ');
-
-    // KHRFence.
+    if (glExtensions.contains("GL_EXT_disjoint_timer_query")) {
+        types |= 1 << EXTDisjointTimerQuery;
+    }
     if (eglExtensions.contains("EGL_KHR_fence_sync")
         && (glExtensions.contains("GL_OES_EGL_sync")
             || glExtensions.contains("GL_OES_egl_sync") /*PowerVR fix*/)) {
+        types |= 1 << KHRFence;
+    }
+    if (glExtensions.contains("GL_NV_fence")) {
+        types |= 1 << NVFence;
+    }
+#else
+    // We could use the thin QOpenGLTimerQuery wrapper from Qt 5.1, but the lack
+    // of a method to check the presence of glQueryCounter() would force us to
+    // inspect OpenGL version and extensions, which is basically as annoying as
+    // doing the whole thing here.
+    // TODO(loicm) Add an hasQuerycounter() method to QOpenGLTimerQuery.
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QSurfaceFormat format = context->format();
+    if (qMakePair(format.majorVersion(), format.minorVersion()) >= qMakePair(3, 2)
+        && context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"))) {
+        types |= 1 << ARBTimerQuery;
+    }
+    if (context->hasExtension(QByteArrayLiteral("GL_EXT_timer_query"))) {
+        types |= 1 << EXTTimerQuery;
+    }
+#endif
+
+    // Drivers can advertise an extension and still return NULL for some of
+    // its entry points, in which case the next timer type is tried. The
+    // glFinish() fallback stalls the whole pipeline at each frame, it's not
+    // used when an asynchronous timer is requested (that's typically the case
+    // with software rasterizers like Mesa's llvmpipe). Neither are fences since
+    // they're waited for in stop().
+    for (Type type = selectType(types, asynchronous); type != Unset;
+         type = selectType(types, asynchronous)) {
+        if (initializeType(type)) {
+            m_type = type;
+            m_asynchronous = asynchronous;
+            return true;
+        }
+        types &= ~(1 << type);
+    }
+
+#if !defined QT_NO_DEBUG
+    m_context = nullptr;
+#endif
+    DLOG("GPUTimer is not available");
+    return false;
+}
+
+bool GPUTimer::initializeType(Type type)
+{
+#if defined(QT_OPENGL_ES)
+    // EXTDisjointTimerQuery.
+    if (type == EXTDisjointTimerQuery) {
+        m_disjointTimerQuery.genQueriesEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
+                eglGetProcAddress("glGenQueriesEXT"));
+        m_disjointTimerQuery.deleteQueriesEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, const GLuint*)>(
+                eglGetProcAddress("glDeleteQueriesEXT"));
+        m_disjointTimerQuery.queryCounterEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum)>(
+                eglGetProcAddress("glQueryCounterEXT"));
+        m_disjointTimerQuery.getQueryObjectuivEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint*)>(
+                eglGetProcAddress("glGetQueryObjectuivEXT"));
+        m_disjointTimerQuery.getQueryObjectui64vEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, quint64*)>(
+                eglGetProcAddress("glGetQueryObjectui64vEXT"));
+        if (m_disjointTimerQuery.genQueriesEXT && m_disjointTimerQuery.deleteQueriesEXT
+            && m_disjointTimerQuery.queryCounterEXT && m_disjointTimerQuery.getQueryObjectuivEXT
+            && m_disjointTimerQuery.getQueryObjectui64vEXT) {
+            m_disjointTimerQuery.genQueriesEXT(2 * maxPendingQueries, m_timer);
+            // Reset the disjoint flag.
+            GLint disjoint;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            DLOG("GPUTimer is based on GL_EXT_disjoint_timer_query");
+            return true;
+        }
+        DLOG("GPUTimer can't get GL_EXT_disjoint_timer_query entry points");
+        return false;
+
+    // KHRFence.
+    } else if (type == KHRFence) {
         m_fenceSyncKHR.createSyncKHR = reinterpret_cast<
             EGLSyncKHR (QOPENGLF_APIENTRYP)(EGLDisplay, EGLenum, const EGLint*)>(
                 eglGetProcAddress("eglCreateSyncKHR"));
@@ -54,11 +186,17 @@ void GPUTimer::initialize()
         m_fenceSyncKHR.clientWaitSyncKHR = reinterpret_cast<
             EGLint (QOPENGLF_APIENTRYP)(EGLDisplay, EGLSyncKHR, EGLint, EGLTimeKHR)>(
                 eglGetProcAddress("eglClientWaitSyncKHR"));
-        m_type = KHRFence;
-        DLOG("GPUTimer is based on GL_OES_EGL_sync");
+        if (m_fenceSyncKHR.createSyncKHR && m_fenceSyncKHR.destroySyncKHR
+            && m_fenceSyncKHR.clientWaitSyncKHR) {
+            m_beforeSync = EGL_NO_SYNC_KHR;
+            DLOG("GPUTimer is based on GL_OES_EGL_sync");
+            return true;
+        }
+        DLOG("GPUTimer can't get EGL_KHR_fence_sync entry points");
+        return false;
 
     // NVFence.
-    } else if (glExtensions.contains("GL_NV_fence")) {
+    } else if (type == NVFence) {
         m_fenceNV.genFencesNV = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
             eglGetProcAddress("glGenFencesNV"));
         m_fenceNV.deleteFencesNV =
@@ -68,38 +206,45 @@ void GPUTimer::initialize()
             eglGetProcAddress("glSetFenceNV"));
         m_fenceNV.finishFenceNV = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint)>(
             eglGetProcAddress("glFinishFenceNV"));
-        m_fenceNV.genFencesNV(2, m_fence);
-        m_type = NVFence;
-        DLOG("GPUTimer is based on GL_NV_fence");
+        if (m_fenceNV.genFencesNV && m_fenceNV.deleteFencesNV && m_fenceNV.setFenceNV
+            && m_fenceNV.finishFenceNV) {
+            m_fenceNV.genFencesNV(2, m_fence);
+            DLOG("GPUTimer is based on GL_NV_fence");
+            return true;
+        }
+        DLOG("GPUTimer can't get GL_NV_fence entry points");
+        return false;
     }
 #else
-    // We could use the thin QOpenGLTimerQuery wrapper from Qt 5.1, but the lack
-    // of a method to check the presence of glQueryCounter() would force us to
-    // inspect OpenGL version and extensions, which is basically as annoying as
-    // doing the whole thing here.
-    // TODO(loicm) Add an hasQuerycounter() method to QOpenGLTimerQuery.
     QOpenGLContext* context = QOpenGLContext::currentContext();
-    QSurfaceFormat format = context->format();
 
     // ARBTimerQuery.
-    if (qMakePair(format.majorVersion(), format.minorVersion()) >= qMakePair(3, 2)
-        && context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"))) {
+    if (type == ARBTimerQuery) {
         m_timerQuery.genQueries = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
             context->getProcAddress("glGenQueries"));
         m_timerQuery.deleteQueries =
             reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, const GLuint*)>(
                 context->getProcAddress("glDeleteQueries"));
+        m_timerQuery.getQueryObjectuiv =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint*)>(
+                context->getProcAddress("glGetQueryObjectuiv"));
         m_timerQuery.getQueryObjectui64v =
             reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint64*)>(
                 context->getProcAddress("glGetQueryObjectui64v"));
         m_timerQuery.queryCounter = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum)>(
             context->getProcAddress("glQueryCounter"));
-        m_timerQuery.genQueries(2, m_timer);
-        m_type = ARBTimerQuery;
-        DLOG("GPUTimer is based on GL_ARB_timer_query");
+        if (m_timerQuery.genQueries && m_timerQuery.deleteQueries
+            && m_timerQuery.getQueryObjectuiv && m_timerQuery.getQueryObjectui64v
+            && m_timerQuery.queryCounter) {
+            m_timerQuery.genQueries(2 * maxPendingQueries, m_timer);
+            DLOG("GPUTimer is based on GL_ARB_timer_query");
+            return true;
+        }
+        DLOG("GPUTimer can't get GL_ARB_timer_query entry points");
+        return false;
 
     // EXTTimerQuery.
-    } else if (context->hasExtension(QByteArrayLiteral("GL_EXT_timer_query"))) {
+    } else if (type == EXTTimerQuery) {
         m_timerQuery.genQueries = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
             context->getProcAddress("glGenQueries"));
         m_timerQuery.deleteQueries =
@@ -109,19 +254,28 @@ void GPUTimer::initialize()
             context->getProcAddress("glBeginQuery"));
         m_timerQuery.endQuery = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLenum)>(
             context->getProcAddress("glEndQuery"));
+        m_timerQuery.getQueryObjectuiv =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint*)>(
+                context->getProcAddress("glGetQueryObjectuiv"));
         m_timerQuery.getQueryObjectui64vExt =
             reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint64EXT*)>(
                 context->getProcAddress("glGetQueryObjectui64vEXT"));
-        m_timerQuery.genQueries(1, m_timer);
-        m_type = EXTTimerQuery;
-        DLOG("GPUTimer is based on GL_EXT_timer_query");
+        if (m_timerQuery.genQueries && m_timerQuery.deleteQueries && m_timerQuery.beginQuery
+            && m_timerQuery.endQuery && m_timerQuery.getQueryObjectuiv
+            && m_timerQuery.getQueryObjectui64vExt) {
+            m_timerQuery.genQueries(maxPendingQueries, m_timer);
+            DLOG("GPUTimer is based on GL_EXT_timer_query");
+            return true;
+        }
+        DLOG("GPUTimer can't get GL_EXT_timer_query entry points");
+        return false;
     }
 #endif
 
-    else {
-        m_type = Finish;
-        DLOG("GPUTimer is based on glFinish");
-    }
+    // Finish.
+    DASSERT(type == Finish);
+    DLOG("GPUTimer is based on glFinish");
+    return true;
 }
 
 void GPUTimer::finalize()
@@ -134,8 +288,13 @@ void GPUTimer::finalize()
 #endif
 
 #if defined(QT_OPENGL_ES)
+    // EXTDisjointTimerQuery.
+    if (m_type == EXTDisjointTimerQuery) {
+        m_disjointTimerQuery.deleteQueriesEXT(2 * maxPendingQueries, m_timer);
+        m_type = Unset;
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         if (m_beforeSync != EGL_NO_SYNC_KHR) {
             m_fenceSyncKHR.destroySyncKHR(eglGetCurrentDisplay(), m_beforeSync);
         }
@@ -149,15 +308,24 @@ void GPUTimer::finalize()
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
-        m_timerQuery.deleteQueries(2, m_timer);
+        m_timerQuery.deleteQueries(2 * maxPendingQueries, m_timer);
         m_type = Unset;
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        m_timerQuery.deleteQueries(1, m_timer);
+        m_timerQuery.deleteQueries(maxPendingQueries, m_timer);
         m_type = Unset;
     }
 #endif
+
+    // Finish.
+    else {
+        m_type = Unset;
+    }
+
+    m_asynchronous = false;
+    m_head = 0;
+    m_pendingCount = 0;
 }
 
 void GPUTimer::start()
@@ -165,14 +333,22 @@ void GPUTimer::start()
     DASSERT(m_context == QOpenGLContext::currentContext());
     DASSERT(m_type != Unset);
     DASSERT(!m_started);
+    DASSERT(m_pendingCount < maxPendingQueries);
 
 #if !defined QT_NO_DEBUG
     m_started = true;
 #endif
 
+    // Index of the query slot, always 0 for synchronous timers.
+    const int slot = (m_head + m_pendingCount) % maxPendingQueries;
+
 #if defined(QT_OPENGL_ES)
+    // EXTDisjointTimerQuery.
+    if (m_type == EXTDisjointTimerQuery) {
+        m_disjointTimerQuery.queryCounterEXT(m_timer[2 * slot], GL_TIMESTAMP_EXT);
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         m_beforeSync = m_fenceSyncKHR.createSyncKHR(
             eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
 
@@ -183,16 +359,16 @@ void GPUTimer::start()
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
-        m_timerQuery.queryCounter(m_timer[0], GL_TIMESTAMP);
+        m_timerQuery.queryCounter(m_timer[2 * slot], GL_TIMESTAMP);
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        m_timerQuery.beginQuery(GL_TIME_ELAPSED, m_timer[0]);
+        m_timerQuery.beginQuery(GL_TIME_ELAPSED, m_timer[slot]);
     }
 #endif
 }
 
-quint64 GPUTimer::stop()
+quint64 GPUTimer::stop(quint32 tag)
 {
     DASSERT(m_context == QOpenGLContext::currentContext());
     DASSERT(m_type != Unset);
@@ -202,9 +378,18 @@ quint64 GPUTimer::stop()
     m_started = false;
 #endif
 
+    const int slot = (m_head + m_pendingCount) % maxPendingQueries;
+
 #if defined(QT_OPENGL_ES)
+    // EXTDisjointTimerQuery (always asynchronous).
+    if (m_type == EXTDisjointTimerQuery) {
+        m_disjointTimerQuery.queryCounterEXT(m_timer[2 * slot + 1], GL_TIMESTAMP_EXT);
+        m_tags[slot] = tag;
+        m_pendingCount++;
+        return 0;
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         QElapsedTimer timer;
         EGLDisplay dpy = eglGetCurrentDisplay();
         EGLSyncKHR afterSync = m_fenceSyncKHR.createSyncKHR(dpy, EGL_SYNC_FENCE_KHR, NULL);
@@ -238,8 +423,13 @@ quint64 GPUTimer::stop()
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
+        m_timerQuery.queryCounter(m_timer[2 * slot + 1], GL_TIMESTAMP);
+        if (m_asynchronous) {
+            m_tags[slot] = tag;
+            m_pendingCount++;
+            return 0;
+        }
         GLuint64 time[2] = { 0, 0 };
-        m_timerQuery.queryCounter(m_timer[1], GL_TIMESTAMP);
         m_timerQuery.getQueryObjectui64v(m_timer[0], GL_QUERY_RESULT, &time[0]);
         m_timerQuery.getQueryObjectui64v(m_timer[1], GL_QUERY_RESULT, &time[1]);
         if (time[0] != 0 && time[1] != 0) {
@@ -250,8 +440,13 @@ quint64 GPUTimer::stop()
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        GLuint64EXT time;
         m_timerQuery.endQuery(GL_TIME_ELAPSED);
+        if (m_asynchronous) {
+            m_tags[slot] = tag;
+            m_pendingCount++;
+            return 0;
+        }
+        GLuint64EXT time;
         m_timerQuery.getQueryObjectui64vExt(m_timer[0], GL_QUERY_RESULT, &time);
         return time;
     }
@@ -268,3 +463,84 @@ quint64 GPUTimer::stop()
     DNOT_REACHED();
     return 0;
 }
+
+bool GPUTimer::popResult(quint32* tag, quint64* time, bool wait)
+{
+    DASSERT(m_context == QOpenGLContext::currentContext());
+    DASSERT(tag);
+    DASSERT(time);
+
+    if (m_pendingCount == 0) {
+        return false;
+    }
+    DASSERT(m_asynchronous);
+    const int slot = m_head;
+
+#if defined(QT_OPENGL_ES)
+    // EXTDisjointTimerQuery.
+    if (m_type == EXTDisjointTimerQuery) {
+        // Timestamps complete in order, the second one being available implies
+        // the first one is.
+        if (!wait) {
+            GLuint available = 0;
+            m_disjointTimerQuery.getQueryObjectuivEXT(
+                m_timer[2 * slot + 1], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            if (!available) {
+                return false;
+            }
+        }
+        quint64 timeStamps[2] = { 0, 0 };
+        m_disjointTimerQuery.getQueryObjectui64vEXT(
+            m_timer[2 * slot], GL_QUERY_RESULT_EXT, &timeStamps[0]);
+        m_disjointTimerQuery.getQueryObjectui64vEXT(
+            m_timer[2 * slot + 1], GL_QUERY_RESULT_EXT, &timeStamps[1]);
+        // Results are undefined if a disjoint operation (like a frequency
+        // change) occurred in the meantime.
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        *time = (!disjoint && timeStamps[0] != 0 && timeStamps[1] > timeStamps[0])
+            ? timeStamps[1] - timeStamps[0] : 0;
+    }
+#else
+    // ARBTimerQuery.
+    if (m_type == ARBTimerQuery) {
+        // Timestamps complete in order, the second one being available implies
+        // the first one is.
+        if (!wait) {
+            GLuint available = 0;
+            m_timerQuery.getQueryObjectuiv(
+                m_timer[2 * slot + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                return false;
+            }
+        }
+        GLuint64 timeStamps[2] = { 0, 0 };
+        m_timerQuery.getQueryObjectui64v(m_timer[2 * slot], GL_QUERY_RESULT, &timeStamps[0]);
+        m_timerQuery.getQueryObjectui64v(m_timer[2 * slot + 1], GL_QUERY_RESULT, &timeStamps[1]);
+        *time = (timeStamps[0] != 0 && timeStamps[1] > timeStamps[0])
+            ? timeStamps[1] - timeStamps[0] : 0;
+
+    // EXTTimerQuery.
+    } else if (m_type == EXTTimerQuery) {
+        if (!wait) {
+            GLuint available = 0;
+            m_timerQuery.getQueryObjectuiv(m_timer[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                return false;
+            }
+        }
+        GLuint64EXT elapsed = 0;
+        m_timerQuery.getQueryObjectui64vExt(m_timer[slot], GL_QUERY_RESULT, &elapsed);
+        *time = elapsed;
+    }
+#endif
+    else {
+        DNOT_REACHED();
+        return false;
+    }
+
+    *tag = m_tags[slot];
+    m_head = (m_head + 1) % maxPendingQueries;
+    m_pendingCount--;
+    return true;
+}
@@ -33,48 +33,82 @@
 // in the command buffer from the CPU, this timer pushes dedicated
 // synchronization commands to the command buffer, which the GPU signals
 // whenever completed. That allows to get accurate GPU timings.
+//
+// When timer queries are supported, the timer can be asynchronous. In that
+// case, stop() doesn't wait for the GPU, the queries are stored in a ring and
+// the results are retrieved a few frames later with popResult(). Fence based
+// timers and the glFinish() fallback are always synchronous.
 class UBUNTU_METRICS_PRIVATE_EXPORT GPUTimer
 {
 public:
+    // Max number of asynchronous queries waiting for the GPU.
+    static const int maxPendingQueries = 4;
+
     GPUTimer() :
 #if !defined QT_NO_DEBUG
         m_context(nullptr), m_started(false),
 #endif
-        m_type(Unset) {}
+        m_type(Unset), m_asynchronous(false), m_head(0), m_pendingCount(0) {}
 
     // Allocates/Deletes the OpenGL resources. finalize() is not called at
     // destruction, it must be explicitly called to free the resources at the
     // right time in a thread with the same OpenGL context bound than at
-    // initialize().
-    void initialize();
+    // initialize(). When asynchronous is true, timer queries are pipelined if
+    // supported and the fence based timers and the glFinish() fallback, which
+    // stall the pipeline, aren't used. initialize() returns false if there's no
+    // usable timer, in which case finalize() must not be called.
+    bool initialize(bool asynchronous = false);
     void finalize();
 
     // Starts/Stops the timer. stop() returns the time elapsed in nanoseconds
-    // since the call to start(). Calling start()/stop() two times in a row
-    // triggers an assertion in debug builds and leads to undefined results in
-    // non-debug builds. Must be called in a thread with the same OpenGL context
-    // bound than at initialize().
+    // since the call to start(), or 0 if the timer is asynchronous, tag being
+    // then returned by popResult() along with the time. Calling start()/stop()
+    // two times in a row triggers an assertion in debug builds and leads to
+    // undefined results in non-debug builds. An asynchronous timer can't be
+    // started if there are maxPendingQueries pending queries. Must be called in
+    // a thread with the same OpenGL context bound than at initialize().
     void start();
-    quint64 stop();
+    quint64 stop(quint32 tag = 0);
+
+    // Gets the result of the oldest pending asynchronous query. Returns false
+    // if there's no pending query or if the GPU hasn't completed it yet and
+    // wait is false. Results are returned in the order of submission. Must be
+    // called in a thread with the same OpenGL context bound than at
+    // initialize().
+    bool popResult(quint32* tag, quint64* time, bool wait = false);
+
+    bool isAsynchronous() const { return m_asynchronous; }
+    int pendingCount() const { return m_pendingCount; }
 
-private:
     enum Type {
         Unset,
         Finish,
-#if defined(QT_OPENGL_ES)
-        KHRFence,
-        NVFence,
-#else
-        ARBTimerQuery,
-        EXTTimerQuery
-#endif
+        KHRFence,  // OpenGL ES only.
+        NVFence,  // OpenGL ES only.
+        EXTDisjointTimerQuery,  // OpenGL ES only.
+        ARBTimerQuery,  // OpenGL only.
+        EXTTimerQuery  // OpenGL only.
     };
 
+    // Returns the preferred timer type among the ones set in types (a mask of
+    // 1 << Type bits), or Unset if there's no usable type. Fence based timers
+    // and the glFinish() fallback wait for the GPU at each frame, they are
+    // never returned when asynchronous is true. The glFinish() fallback
+    // doesn't need to be set in types.
+    static Type selectType(quint32 types, bool asynchronous);
+
+private:
+    bool initializeType(Type type);
+
 #if !defined QT_NO_DEBUG
     QOpenGLContext* m_context;
     bool m_started;
 #endif
     Type m_type;
+    bool m_asynchronous;
+    quint8 m_head;
+    quint8 m_pendingCount;
+    quint32 m_tags[maxPendingQueries];
 
 #if defined(QT_OPENGL_ES)
     struct {
@@ -94,18 +128,32 @@ private:
     } m_fenceSyncKHR;
     EGLSyncKHR m_beforeSync;
 
+    struct {
+        void (QOPENGLF_APIENTRYP genQueriesEXT)(GLsizei n, GLuint* ids);
+        void (QOPENGLF_APIENTRYP deleteQueriesEXT)(GLsizei n, const GLuint* ids);
+        void (QOPENGLF_APIENTRYP queryCounterEXT)(GLuint id, GLenum target);
+        void (QOPENGLF_APIENTRYP getQueryObjectuivEXT)(GLuint id, GLenum pname, GLuint* params);
+        void (QOPENGLF_APIENTRYP getQueryObjectui64vEXT)(GLuint id, GLenum pname,
+                                                         quint64* params);
+    } m_disjointTimerQuery;
+    // Two timestamp queries per pending query.
+    GLuint m_timer[2 * maxPendingQueries];
+
 #else
     struct {
         void (QOPENGLF_APIENTRYP genQueries)(GLsizei n, GLuint* ids);
         void (QOPENGLF_APIENTRYP deleteQueries)(GLsizei n, const GLuint* ids);
         void (QOPENGLF_APIENTRYP beginQuery)(GLenum target, GLuint id);
         void (QOPENGLF_APIENTRYP endQuery)(GLenum target);
+        void (QOPENGLF_APIENTRYP getQueryObjectuiv)(GLuint id, GLenum pname, GLuint* params);
         void (QOPENGLF_APIENTRYP getQueryObjectui64v)(GLuint id, GLenum pname, GLuint64* params);
         void (QOPENGLF_APIENTRYP getQueryObjectui64vExt)(GLuint id, GLenum pname,
                                                          GLuint64EXT* params);
         void (QOPENGLF_APIENTRYP queryCounter)(GLuint id, GLenum target);
     } m_timerQuery;
-    GLuint m_timer[2];
+    // Two timestamp queries (ARBTimerQuery) or one time elapsed query
+    // (EXTTimerQuery) per pending query.
+    GLuint m_timer[2 * maxPendingQueries];
 #endif
 };
 
@@ -0,0 +1,110 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+#include "histogram.h"
+
+#include <string.h>
+
+#include "ubuntumetricsglobal_p.h"
+
+void UMHistogram::reset()
+{
+    memset(m_counts, 0, sizeof(m_counts));
+    m_count = 0;
+    m_sum = 0;
+    m_min = Q_UINT64_C(0xffffffffffffffff);
+    m_max = 0;
+}
+
+// static.
+int UMHistogram::bucketIndex(quint64 value)
+{
+    // Values lower than subBucketCount have their own bucket, the others are
+    // indexed by the position of their most significant bit and the following
+    // subBucketBits bits.
+    if (value < static_cast<quint64>(subBucketCount)) {
+        return static_cast<int>(value);
+    }
+#if defined(Q_CC_GNU)
+    const int msb = 63 - __builtin_clzll(value);
+#else
+    int msb = 0;
+    for (quint64 v = value; v >>= 1; ) {
+        msb++;
+    }
+#endif
+    const int subBucket = (value >> (msb - subBucketBits)) & (subBucketCount - 1);
+    return (msb - subBucketBits + 1) * subBucketCount + subBucket;
+}
+
+// static.
+quint64 UMHistogram::bucketValue(int index)
+{
+    DASSERT(index >= 0 && index < bucketCount);
+
+    if (index < subBucketCount) {
+        return index;
+    }
+    // Middle of the bucket.
+    const int msb = index / subBucketCount + subBucketBits - 1;
+    const quint64 subBucket = index % subBucketCount;
+    const quint64 lower = (Q_UINT64_C(1) << msb) + (subBucket << (msb - subBucketBits));
+    return lower + ((Q_UINT64_C(1) << (msb - subBucketBits)) >> 1);
+}
+
+void UMHistogram::add(quint64 value)
+{
+    value = qMin(value, (Q_UINT64_C(1) << maxValueBits) - 1);
+    m_counts[bucketIndex(value)]++;
+    m_count++;
+    m_sum += value;
+    m_min = qMin(m_min, value);
+    m_max = qMax(m_max, value);
+}
+
+void UMHistogram::add(const UMHistogram& histogram)
+{
+    if (histogram.m_count > 0) {
+        for (int i = 0; i < bucketCount; ++i) {
+            m_counts[i] += histogram.m_counts[i];
+        }
+        m_count += histogram.m_count;
+        m_sum += histogram.m_sum;
+        m_min = qMin(m_min, histogram.m_min);
+        m_max = qMax(m_max, histogram.m_max);
+    }
+}
+
+quint64 UMHistogram::percentile(float percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    // Rank of the value (starting at 1) in the sorted values.
+    const float clampedPercentile = qBound(0.0f, percentile, 100.0f);
+    const quint64 rank = qMax(
+        Q_UINT64_C(1), static_cast<quint64>(clampedPercentile * 0.01f * m_count + 0.5f));
+    quint64 count = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        count += m_counts[i];
+        if (count >= rank) {
+            return qBound(m_min, bucketValue(i), m_max);
+        }
+    }
+    return m_max;
+}
@@ -0,0 +1,75 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/ubuntumetricsglobal.h>
+
+// Histogram of times in nanoseconds with log-scaled buckets (HDR histogram
+// style). Each power-of-two range is split into 16 linear sub-buckets, which
+// bounds the relative error to about 6% with a fixed memory footprint and a
+// constant insertion cost. Values are clamped to 2^36 ns (about 68 s). Not
+// thread-safe.
+class UBUNTU_METRICS_EXPORT UMHistogram
+{
+public:
+    static const int subBucketBits = 4;
+    static const int subBucketCount = 1 << subBucketBits;
+    static const int maxValueBits = 36;
+    static const int bucketCount = (maxValueBits - subBucketBits + 1) * subBucketCount;
+
+    UMHistogram() { reset(); }
+
+    // Remove all the values.
+    void reset();
+
+    // Add a value in nanoseconds.
+    void add(quint64 value);
+
+    // Add all the values of another histogram.
+    void add(const UMHistogram& histogram);
+
+    // Get the number of values, the min, max and mean values.
+    quint64 count() const { return m_count; }
+    quint64 min() const { return m_count ? m_min : 0; }
+    quint64 max() const { return m_max; }
+    quint64 mean() const { return m_count ? m_sum / m_count : 0; }
+
+    // Get the value at the given percentile (between 0 and 100). Returns 0 if
+    // the histogram is empty.
+    quint64 percentile(float percentile) const;
+
+private:
+    static int bucketIndex(quint64 value);
+    static quint64 bucketValue(int index);
+
+    quint32 m_counts[bucketCount];
+    quint64 m_count;
+    quint64 m_sum;
+    quint64 m_min;
+    quint64 m_max;
+};
+
+// Frame time histograms of a window, indexed by UMSummaryEvent::Metric.
+struct UBUNTU_METRICS_EXPORT UMFrameHistograms
+{
+    UMHistogram metrics[UMSummaryEvent::MetricCount];
+};
+
+#endif  // HISTOGRAM_H
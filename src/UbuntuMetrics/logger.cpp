@@ -17,7 +17,14 @@
 
 #include "logger_p.h"
 
+#include <atomic>
 #include <dlfcn.h>
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif  // defined(Q_OS_LINUX)
 
 #include <QtCore/QDir>
 #include <QtCore/QTime>
@@ -30,12 +37,26 @@
 #include "lttng/lttng_p.h"
 #endif  // defined(Q_OS_LINUX)
 
+// Size of the blocks written by binary file loggers. Must be a multiple of
+// binaryBufferAlignment.
+const int binaryRecordSize = 2 * sizeof(quint32) + sizeof(UMEvent);
+const int binaryBufferRecords = 480;
+const int binaryBufferSize = binaryRecordSize * binaryBufferRecords;
+const int binaryBufferAlignment = 64;
+
 UMFileLogger::UMFileLogger(const QString& fileName, bool parsable)
-    : d_ptr(new UMFileLoggerPrivate(fileName, parsable))
+    : d_ptr(new UMFileLoggerPrivate(fileName, parsable, false))
 {
 }
 
-UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, bool parsable)
+UMFileLogger::UMFileLogger(const QString& fileName, bool parsable, bool binary)
+    : d_ptr(new UMFileLoggerPrivate(fileName, parsable, binary))
+{
+}
+
+UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, bool parsable, bool binary)
+    : m_buffer(nullptr)
+    , m_bufferSize(0)
 {
     if (QDir::isRelativePath(fileName)) {
         m_file.setFileName(QString(QDir::currentPath() + QDir::separator() + fileName));
@@ -43,6 +64,30 @@ UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, bool parsable)
         m_file.setFileName(fileName);
     }
 
+    if (binary) {
+        // Buffering is done by the logger so that blocks are written at once.
+        if (m_file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+            UMBinaryLogHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, "UMLG", 4);
+            header.version = UMBinaryLogHeader::currentVersion;
+            header.byteOrder = UMBinaryLogHeader::byteOrderMark;
+            header.eventSize = sizeof(UMEvent);
+            if (m_file.write(reinterpret_cast<const char*>(&header), sizeof(header))
+                == sizeof(header)) {
+                m_buffer = static_cast<char*>(
+                    alignedAlloc(binaryBufferAlignment, binaryBufferSize));
+                m_flags = Open | Binary;
+                return;
+            }
+            m_file.close();
+        }
+        m_flags = 0;
+        WARN("FileLogger: Can't open file %s '%s'.", fileName.toLatin1().constData(),
+             m_file.errorString().toLatin1().constData());
+        return;
+    }
+
     if (m_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered)) {
         m_textStream.setDevice(&m_file);
         m_textStream.setCodec("ISO 8859-1");
@@ -65,6 +110,8 @@ UMFileLogger::UMFileLogger(FILE* fileHandle, bool parsable)
 }
 
 UMFileLoggerPrivate::UMFileLoggerPrivate(FILE* fileHandle, bool parsable)
+    : m_buffer(nullptr)
+    , m_bufferSize(0)
 {
     if (m_file.open(fileHandle, QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered)) {
         m_textStream.setDevice(&m_file);
@@ -92,6 +139,14 @@ UMFileLogger::~UMFileLogger()
     delete d_ptr;
 }
 
+UMFileLoggerPrivate::~UMFileLoggerPrivate()
+{
+    if (m_flags & Binary) {
+        flushBinary();
+        free(m_buffer);
+    }
+}
+
 bool UMFileLogger::isOpen()
 {
     return !!(d_func()->m_flags & UMFileLoggerPrivate::Open);
@@ -105,8 +160,39 @@ void UMFileLogger::log(const UMEvent& event)
     d_func()->log(event);
 }
 
+void UMFileLoggerPrivate::logBinary(const UMEvent& event)
+{
+    DASSERT(m_flags & Binary);
+    DASSERT(m_buffer);
+
+    if (m_bufferSize == binaryBufferSize) {
+        flushBinary();
+    }
+    char* record = &m_buffer[m_bufferSize];
+    const quint32 header[2] = { sizeof(UMEvent), 0 };
+    memcpy(record, header, sizeof(header));
+    memcpy(&record[sizeof(header)], &event, sizeof(UMEvent));
+    m_bufferSize += binaryRecordSize;
+}
+
+void UMFileLoggerPrivate::flushBinary()
+{
+    if (m_bufferSize > 0 && (m_flags & Open)) {
+        if (m_file.write(m_buffer, m_bufferSize) != m_bufferSize) {
+            WARN("FileLogger: Can't write to file '%s'.",
+                 m_file.errorString().toLatin1().constData());
+        }
+    }
+    m_bufferSize = 0;
+}
+
 void UMFileLoggerPrivate::log(const UMEvent& event)
 {
+    if (m_flags & Binary) {
+        logBinary(event);
+        return;
+    }
+
     if (m_flags & Open) {
         // ANSI/VT100 terminal codes.
         const char* const dim = m_flags & Colored ? "\033[02m" : "";
@@ -208,6 +294,68 @@ void UMFileLoggerPrivate::log(const UMEvent& event)
             break;
         }
 
+        case UMEvent::Summary: {
+            const UMSummaryEvent& summary = event.summary;
+            if (m_flags & Parsable) {
+                m_textStream
+                    << "S "
+                    << event.timeStamp << ' '
+                    << summary.window << ' '
+                    << summary.frameCount;
+                for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+                    m_textStream
+                        << ' ' << summary.p50[i] << ' ' << summary.p95[i]
+                        << ' ' << summary.p99[i] << ' ' << summary.max[i];
+                }
+                m_textStream << '\n' << flush;
+            } else {
+                const char* const metricString[] = { "Delta", "Sync", "Render", "GPU", "Swap" };
+                Q_STATIC_ASSERT(ARRAY_SIZE(metricString) == UMSummaryEvent::MetricCount);
+                m_textStream
+                    << (m_flags & Colored ? "\033[34mS\033[00m " : "S ")
+                    << dim << timeString << reset << ' '
+                    << "Win" << dimColon << summary.window << ' '
+                    << "Frames" << dimColon << summary.frameCount;
+                for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+                    m_textStream
+                        << ' ' << metricString[i] << dimColon
+                        << summary.p50[i] / 1000000.0f << '/'
+                        << summary.p95[i] / 1000000.0f << '/'
+                        << summary.p99[i] / 1000000.0f << '/'
+                        << summary.max[i] / 1000000.0f << "ms";
+                }
+                m_textStream << '\n' << flush;
+            }
+            break;
+        }
+
+        case UMEvent::PaintNode: {
+            const UMPaintNodeEvent& paintNode = event.paintNode;
+            if (m_flags & Parsable) {
+                m_textStream
+                    << "N "
+                    << event.timeStamp << ' '
+                    << paintNode.frame << ' '
+                    << paintNode.itemCount << ' '
+                    << paintNode.frameTime << ' '
+                    << paintNode.time << ' '
+                    << paintNode.className << ' '
+                    << paintNode.objectName << '\n' << flush;
+            } else {
+                m_textStream
+                    << (m_flags & Colored ? "\033[31mN\033[00m " : "N ")
+                    << dim << timeString << reset << ' '
+                    << "Frame" << dimColon << paintNode.frame << ' '
+                    << "Items" << dimColon << paintNode.itemCount << ' '
+                    << "FrameTime" << dimColon << paintNode.frameTime / 1000000.0f << "ms "
+                    << "Time" << dimColon << paintNode.time / 1000000.0f << "ms "
+                    << "Class" << dimColon << paintNode.className << ' '
+                    << "Name" << dimColon << '"' << paintNode.objectName << '"'
+                    << '\n' << flush;
+            }
+            break;
+        }
+
         default:
             DNOT_REACHED();
             break;
@@ -231,8 +379,259 @@ bool UMFileLogger::parsable()
     return !!(d_func()->m_flags & UMFileLoggerPrivate::Parsable);
 }
 
+bool UMFileLogger::binary()
+{
+    return !!(d_func()->m_flags & UMFileLoggerPrivate::Binary);
+}
+
 #if defined(Q_OS_LINUX)
 
+UMRollingFileLogger::UMRollingFileLogger(
+    const QString& fileName, quint32 segmentSize, int segmentCount, quint32 segmentDuration)
+    : d_ptr(new UMRollingFileLoggerPrivate(fileName, segmentSize, segmentCount, segmentDuration))
+{
+}
+
+UMRollingFileLoggerPrivate::UMRollingFileLoggerPrivate(
+    const QString& fileName, quint32 segmentSize, int segmentCount, quint32 segmentDuration)
+    : m_segments{}
+    , m_segmentStart(0)
+    , m_segmentDuration(segmentDuration * Q_UINT64_C(1000000))
+    , m_offset(0)
+    , m_sequence(0)
+    , m_segmentCount(0)
+    , m_segmentIndex(0)
+{
+    const QString baseName = QDir::isRelativePath(fileName)
+        ? QString(QDir::currentPath() + QDir::separator() + fileName) : fileName;
+
+    // Round the segment size up to the page size, segments must at least be
+    // able to store the header and a record.
+    const quint32 pageSize = sysconf(_SC_PAGESIZE);
+    const quint32 minSize = sizeof(UMBinaryLogHeader) + binaryRecordSize + sizeof(quint32);
+    segmentSize = qMax(segmentSize, minSize);
+    m_segmentSize = ((segmentSize + pageSize - 1) / pageSize) * pageSize;
+    segmentCount = qBound(1, segmentCount, static_cast<int>(UMRollingFileLogger::maxSegmentCount));
+
+    // Pre-allocate and map all the segments so that rotating doesn't require
+    // any syscalls.
+    for (int i = 0; i < segmentCount; ++i) {
+        const QByteArray name = QFile::encodeName(baseName + QStringLiteral(".%1").arg(i));
+        const int fd = open(name.constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            WARN("RollingFileLogger: Can't open file '%s'.", name.constData());
+            break;
+        }
+        if (ftruncate(fd, m_segmentSize) == -1
+            || posix_fallocate(fd, 0, m_segmentSize) != 0) {
+            WARN("RollingFileLogger: Can't allocate file '%s'.", name.constData());
+            close(fd);
+            break;
+        }
+        void* segment = mmap(nullptr, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (segment == MAP_FAILED) {
+            WARN("RollingFileLogger: Can't map file '%s'.", name.constData());
+            break;
+        }
+        m_segments[m_segmentCount++] = static_cast<char*>(segment);
+    }
+    if (m_segmentCount != segmentCount) {
+        for (int i = 0; i < m_segmentCount; ++i) {
+            munmap(m_segments[i], m_segmentSize);
+            m_segments[i] = nullptr;
+        }
+        m_segmentCount = 0;
+        return;
+    }
+
+    // Keep the segments of a previous run (maybe crashed) by starting right
+    // after the most recent one.
+    int lastIndex = -1;
+    for (int i = 0; i < m_segmentCount; ++i) {
+        const UMBinaryLogHeader* header = reinterpret_cast<UMBinaryLogHeader*>(m_segments[i]);
+        if (!memcmp(header->magic, "UMLG", 4) && header->sequence > m_sequence) {
+            m_sequence = header->sequence;
+            lastIndex = i;
+        }
+    }
+    startSegment((lastIndex + 1) % m_segmentCount);
+}
+
+UMRollingFileLogger::~UMRollingFileLogger()
+{
+    delete d_ptr;
+}
+
+UMRollingFileLoggerPrivate::~UMRollingFileLoggerPrivate()
+{
+    for (int i = 0; i < m_segmentCount; ++i) {
+        msync(m_segments[i], m_segmentSize, MS_ASYNC);
+        munmap(m_segments[i], m_segmentSize);
+    }
+}
+
+bool UMRollingFileLogger::isOpen()
+{
+    return d_func()->m_segmentCount > 0;
+}
+
+void UMRollingFileLoggerPrivate::startSegment(int index)
+{
+    DASSERT(index >= 0 && index < m_segmentCount);
+
+    char* segment = m_segments[index];
+    UMBinaryLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "UMLG", 4);
+    header.version = UMBinaryLogHeader::currentVersion;
+    header.byteOrder = UMBinaryLogHeader::byteOrderMark;
+    header.eventSize = sizeof(UMEvent);
+    header.sequence = ++m_sequence;
+    // Terminate the records first so that a reader never sees the records of
+    // the segment's previous round with the new header.
+    memset(&segment[sizeof(header)], 0, sizeof(quint32));
+    memcpy(segment, &header, sizeof(header));
+
+    m_segmentIndex = index;
+    m_offset = sizeof(header);
+}
+
+void UMRollingFileLogger::log(const UMEvent& event)
+{
+    d_func()->log(event);
+}
+
+void UMRollingFileLoggerPrivate::log(const UMEvent& event)
+{
+    if (Q_UNLIKELY(m_segmentCount == 0)) {
+        return;
+    }
+
+    // Rotate by size or time.
+    if (m_offset == sizeof(UMBinaryLogHeader)) {
+        m_segmentStart = event.timeStamp;
+    } else if ((m_offset + binaryRecordSize > m_segmentSize)
+               || (m_segmentDuration && (event.timeStamp - m_segmentStart > m_segmentDuration))) {
+        startSegment((m_segmentIndex + 1) % m_segmentCount);
+        m_segmentStart = event.timeStamp;
+    }
+
+    // Write the event data, then the end marker after the record and then
+    // the record size so that an interrupted write never exposes a partial
+    // record (the decoder stops at the first null size).
+    char* record = &m_segments[m_segmentIndex][m_offset];
+    const quint32 header[2] = { sizeof(UMEvent), 0 };
+    memcpy(&record[sizeof(header)], &event, sizeof(UMEvent));
+    if (m_offset + binaryRecordSize + sizeof(quint32) <= m_segmentSize) {
+        memset(&record[binaryRecordSize], 0, sizeof(quint32));
+    }
+    memcpy(record, header, sizeof(header));
+    m_offset += binaryRecordSize;
+}
+
+UMSharedMemoryLogger::UMSharedMemoryLogger(const QString& name, quint32 ringSize)
+    : d_ptr(new UMSharedMemoryLoggerPrivate(name, ringSize))
+{
+}
+
+UMSharedMemoryLoggerPrivate::UMSharedMemoryLoggerPrivate(const QString& name, quint32 ringSize)
+    : m_segment(nullptr)
+    , m_size(0)
+    , m_header(nullptr)
+    , m_latest(nullptr)
+    , m_ring(nullptr)
+    , m_ringSize(qMax(ringSize, 1u))
+    , m_eventCount(0)
+{
+    m_name = name.isEmpty()
+        ? QByteArray("/ubuntu-metrics-") + QByteArray::number(getpid()) : QFile::encodeName(name);
+    if (!m_name.startsWith('/')) {
+        m_name.prepend('/');
+    }
+
+    // Readers only get read access, they can't disturb the writer.
+    const int fd = shm_open(m_name.constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        WARN("SharedMemoryLogger: Can't open shared memory segment '%s'.", m_name.constData());
+        return;
+    }
+    const size_t size = sizeof(UMSharedMemoryHeader)
+        + (UMEvent::TypeCount + m_ringSize) * sizeof(UMSharedMemorySlot);
+    if (ftruncate(fd, size) == -1) {
+        WARN("SharedMemoryLogger: Can't allocate shared memory segment '%s'.", m_name.constData());
+        close(fd);
+        shm_unlink(m_name.constData());
+        return;
+    }
+    void* segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        WARN("SharedMemoryLogger: Can't map shared memory segment '%s'.", m_name.constData());
+        shm_unlink(m_name.constData());
+        return;
+    }
+    m_segment = static_cast<char*>(segment);
+    m_size = size;
+
+    // The segment is zero-filled, the magic is written last so that readers
+    // never see a partially initialised header.
+    m_header = reinterpret_cast<UMSharedMemoryHeader*>(m_segment);
+    m_latest = reinterpret_cast<UMSharedMemorySlot*>(m_segment + sizeof(UMSharedMemoryHeader));
+    m_ring = m_latest + UMEvent::TypeCount;
+    m_header->version = UMSharedMemoryHeader::currentVersion;
+    m_header->eventSize = sizeof(UMEvent);
+    m_header->ringSize = m_ringSize;
+    m_header->pid = getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(m_header->magic, "UMSM", 4);
+}
+
+UMSharedMemoryLogger::~UMSharedMemoryLogger()
+{
+    delete d_ptr;
+}
+
+UMSharedMemoryLoggerPrivate::~UMSharedMemoryLoggerPrivate()
+{
+    if (m_segment) {
+        munmap(m_segment, m_size);
+        shm_unlink(m_name.constData());
+    }
+}
+
+bool UMSharedMemoryLogger::isOpen()
+{
+    return d_func()->m_segment != nullptr;
+}
+
+void UMSharedMemoryLogger::log(const UMEvent& event)
+{
+    d_func()->log(event);
+}
+
+// Seqlock write, the sequence is odd while the event is being copied.
+static void writeSlot(UMSharedMemorySlot* slot, quint32 sequence, const UMEvent& event)
+{
+    slot->sequence.store(sequence - 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot->event, &event, sizeof(UMEvent));
+    slot->sequence.storeRelease(sequence);
+}
+
+void UMSharedMemoryLoggerPrivate::log(const UMEvent& event)
+{
+    if (Q_UNLIKELY(!m_segment)) {
+        return;
+    }
+    DASSERT(event.type >= 0 && event.type < UMEvent::TypeCount);
+
+    UMSharedMemorySlot* latest = &m_latest[event.type];
+    writeSlot(latest, latest->sequence.load() + 2, event);
+    writeSlot(&m_ring[m_eventCount % m_ringSize], 2 * m_eventCount + 2, event);
+    m_header->eventCount.storeRelease(++m_eventCount);
+}
+
 UMLTTNGPlugin* UMLTTNGLogger::m_plugin = nullptr;
 bool UMLTTNGLogger::m_error = false;
 
@@ -316,6 +715,35 @@ void UMLTTNGLogger::log(const UMEvent& event)
             break;
         }
 
+        case UMEvent::Summary: {
+            UMLTTNGSummaryEvent summaryEvent;
+            Q_STATIC_ASSERT(sizeof(summaryEvent.p50) == sizeof(event.summary.p50));
+            summaryEvent.window = event.summary.window;
+            summaryEvent.frameCount = event.summary.frameCount;
+            memcpy(summaryEvent.p50, event.summary.p50, sizeof(summaryEvent.p50));
+            memcpy(summaryEvent.p95, event.summary.p95, sizeof(summaryEvent.p95));
+            memcpy(summaryEvent.p99, event.summary.p99, sizeof(summaryEvent.p99));
+            memcpy(summaryEvent.max, event.summary.max, sizeof(summaryEvent.max));
+            m_plugin->logSummaryEvent(&summaryEvent);
+            break;
+        }
+
+        case UMEvent::PaintNode: {
+            UMLTTNGPaintNodeEvent paintNodeEvent;
+            Q_STATIC_ASSERT(sizeof(paintNodeEvent.className) == UMPaintNodeEvent::maxNameSize);
+            Q_STATIC_ASSERT(sizeof(paintNodeEvent.objectName) == UMPaintNodeEvent::maxNameSize);
+            paintNodeEvent.frame = event.paintNode.frame;
+            paintNodeEvent.itemCount = event.paintNode.itemCount;
+            paintNodeEvent.frameTime = event.paintNode.frameTime;
+            paintNodeEvent.time = event.paintNode.time;
+            memcpy(paintNodeEvent.className, event.paintNode.className,
+                   sizeof(paintNodeEvent.className));
+            memcpy(paintNodeEvent.objectName, event.paintNode.objectName,
+                   sizeof(paintNodeEvent.objectName));
+            m_plugin->logPaintNodeEvent(&paintNodeEvent);
+            break;
+        }
+
         default:
             DNOT_REACHED();
             break;
@@ -18,11 +18,15 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <QtCore/QAtomicInteger>
 #include <QtCore/QFile>
 
+#include <UbuntuMetrics/events.h>
 #include <UbuntuMetrics/ubuntumetricsglobal.h>
 
 class UMFileLoggerPrivate;
+class UMRollingFileLoggerPrivate;
+class UMSharedMemoryLoggerPrivate;
 struct UMLTTNGPlugin;
 struct UMEvent;
 
@@ -39,20 +43,58 @@ public:
     virtual bool isOpen() = 0;
 };
 
+// Header of the binary log files written by UMFileLogger. The header is
+// followed by records made of a quint32 storing the size in bytes of the
+// event, 4 bytes of padding and the UMEvent data. Values are stored in the
+// byte order of the writer.
+struct UBUNTU_METRICS_EXPORT UMBinaryLogHeader
+{
+    static const quint32 currentVersion = 1;
+    static const quint32 byteOrderMark = 0x01020304;
+
+    // 'U', 'M', 'L', 'G'.
+    char magic[4];
+
+    // Version of the file format.
+    quint32 version;
+
+    // byteOrderMark stored in the byte order of the writer.
+    quint32 byteOrder;
+
+    // Size of the UMEvent struct.
+    quint32 eventSize;
+
+    // Sequence number of the segment for logs written by UMRollingFileLogger
+    // (starting at 1), 0 otherwise. A record size of 0 marks the end of the
+    // records in a segment.
+    quint32 sequence;
+
+    quint8 __reserved[12];
+};
+Q_STATIC_ASSERT(sizeof(UMBinaryLogHeader) == 32);
+
 // Log events to a file.
 class UBUNTU_METRICS_EXPORT UMFileLogger : public UMLogger
 {
 public:
     UMFileLogger(const QString& filename, bool parsable = true);
+    // When binary is true, events are logged as fixed-size binary records
+    // written in large blocks (see UMBinaryLogHeader) and parsable is ignored.
+    // Events still in the block when the process crashes are lost. Binary logs
+    // can be converted to text using the log decoder tool.
+    UMFileLogger(const QString& filename, bool parsable, bool binary);
     UMFileLogger(FILE* fileHandle, bool parsable = false);
     ~UMFileLogger();
 
     void log(const UMEvent& event) Q_DECL_OVERRIDE;
     bool isOpen() Q_DECL_OVERRIDE;
 
+    // Ignored by binary file loggers.
     void setParsable(bool parsable);
     bool parsable();
 
+    bool binary();
+
 private:
     UMFileLoggerPrivate* const d_ptr;
     Q_DECLARE_PRIVATE(UMFileLogger)
@@ -60,6 +102,98 @@ private:
 
 #if defined(Q_OS_LINUX)
 
+// Log events to a fixed set of pre-allocated and memory-mapped segment files
+// used as a ring, so that the disk space used is bounded. Segments are named
+// after fileName with a ".N" suffix, they use the binary format (see
+// UMBinaryLogHeader) and the header sequence number gives their order. The
+// logger moves to the next segment when the current one is full or, if
+// segmentDuration isn't 0, when the first event logged in the current segment
+// is older than segmentDuration milliseconds. Logging doesn't allocate memory
+// nor does it do any syscalls, the data being written back by the kernel it
+// survives a crash of the application.
+class UBUNTU_METRICS_EXPORT UMRollingFileLogger : public UMLogger
+{
+public:
+    static const int maxSegmentCount = 64;
+
+    UMRollingFileLogger(const QString& fileName, quint32 segmentSize = 4 * 1024 * 1024,
+                        int segmentCount = 4, quint32 segmentDuration = 0);
+    ~UMRollingFileLogger();
+
+    void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    bool isOpen() Q_DECL_OVERRIDE;
+
+private:
+    UMRollingFileLoggerPrivate* const d_ptr;
+    Q_DECLARE_PRIVATE(UMRollingFileLogger)
+};
+
+// Header of the POSIX shared memory segment written by UMSharedMemoryLogger,
+// named "/ubuntu-metrics-<pid>" by default. The header is followed by
+// UMEvent::TypeCount slots storing the latest event of each type and by a ring
+// of ringSize slots storing the last events. Slots are written using a seqlock
+// so that readers never block the writer: a slot sequence is odd while the
+// event is being written, readers must read the sequence, copy the event and
+// read the sequence again, the copy being consistent if both reads match and
+// are even. The ring slot of the nth event written (starting at 0) is at index
+// n % ringSize and its sequence is 2 * n + 2 once written. Values are stored
+// in the byte order of the writer.
+struct UBUNTU_METRICS_EXPORT UMSharedMemoryHeader
+{
+    static const quint32 currentVersion = 1;
+
+    // 'U', 'M', 'S', 'M'.
+    char magic[4];
+
+    // Version of the segment layout.
+    quint32 version;
+
+    // Size of the UMEvent struct.
+    quint32 eventSize;
+
+    // Number of slots in the ring.
+    quint32 ringSize;
+
+    // Process ID of the writer.
+    quint32 pid;
+
+    // Number of events written to the ring.
+    QBasicAtomicInteger<quint32> eventCount;
+
+    quint8 __reserved[40];
+};
+Q_STATIC_ASSERT(sizeof(UMSharedMemoryHeader) == 64);
+
+struct UBUNTU_METRICS_EXPORT UMSharedMemorySlot
+{
+    // Seqlock sequence, odd while the event is being written.
+    QBasicAtomicInteger<quint32> sequence;
+
+    quint32 __padding;
+
+    UMEvent event;
+};
+
+// Publish events to a POSIX shared memory segment (see UMSharedMemoryHeader)
+// that external tools can read while the application is running, like the
+// metrics monitor tool. Logging doesn't allocate memory, doesn't do any
+// syscalls and never waits for readers. The segment is removed when the logger
+// is destroyed.
+class UBUNTU_METRICS_EXPORT UMSharedMemoryLogger : public UMLogger
+{
+public:
+    // An empty name uses the default "/ubuntu-metrics-<pid>" name.
+    UMSharedMemoryLogger(const QString& name = QString(), quint32 ringSize = 1024);
+    ~UMSharedMemoryLogger();
+
+    void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    bool isOpen() Q_DECL_OVERRIDE;
+
+private:
+    UMSharedMemoryLoggerPrivate* const d_ptr;
+    Q_DECLARE_PRIVATE(UMSharedMemoryLogger)
+};
+
 // Log events to LTTng.
 class UBUNTU_METRICS_EXPORT UMLTTNGLogger : public UMLogger
 {
@@ -32,17 +32,65 @@ public:
     enum {
         Open     = (1 << 0),
         Colored  = (1 << 1),
-        Parsable = (1 << 2)
+        Parsable = (1 << 2),
+        Binary   = (1 << 3)
     };
 
-    UMFileLoggerPrivate(const QString& fileName, bool parsable);
+    UMFileLoggerPrivate(const QString& fileName, bool parsable, bool binary);
     UMFileLoggerPrivate(FILE* fileHandle, bool parsable);
+    ~UMFileLoggerPrivate();
 
     void log(const UMEvent& event);
+    void logBinary(const UMEvent& event);
+    void flushBinary();
 
     QFile m_file;
     QTextStream m_textStream;
+    char* m_buffer;
+    int m_bufferSize;
     quint8 m_flags;
 };
 
+#if defined(Q_OS_LINUX)
+
+class UBUNTU_METRICS_PRIVATE_EXPORT UMRollingFileLoggerPrivate
+{
+public:
+    UMRollingFileLoggerPrivate(
+        const QString& fileName, quint32 segmentSize, int segmentCount, quint32 segmentDuration);
+    ~UMRollingFileLoggerPrivate();
+
+    void log(const UMEvent& event);
+    void startSegment(int index);
+
+    char* m_segments[UMRollingFileLogger::maxSegmentCount];
+    quint64 m_segmentStart;
+    quint64 m_segmentDuration;
+    quint32 m_segmentSize;
+    quint32 m_offset;
+    quint32 m_sequence;
+    int m_segmentCount;
+    int m_segmentIndex;
+};
+
+class UBUNTU_METRICS_PRIVATE_EXPORT UMSharedMemoryLoggerPrivate
+{
+public:
+    UMSharedMemoryLoggerPrivate(const QString& name, quint32 ringSize);
+    ~UMSharedMemoryLoggerPrivate();
+
+    void log(const UMEvent& event);
+
+    QByteArray m_name;
+    char* m_segment;
+    size_t m_size;
+    UMSharedMemoryHeader* m_header;
+    UMSharedMemorySlot* m_latest;
+    UMSharedMemorySlot* m_ring;
+    quint32 m_ringSize;
+    quint32 m_eventCount;
+};
+
+#endif  // defined(Q_OS_LINUX)
+
 #endif  // LOGGER_P_H
@@ -38,9 +38,21 @@ static void logGenericEvent(UMLTTNGGenericEvent* event)
     tracepoint(UbuntuMetrics, generic, event);
 }
 
+static void logSummaryEvent(UMLTTNGSummaryEvent* event)
+{
+    tracepoint(UbuntuMetrics, summary, event);
+}
+
+static void logPaintNodeEvent(UMLTTNGPaintNodeEvent* event)
+{
+    tracepoint(UbuntuMetrics, paint_node, event);
+}
+
 const struct UMLTTNGPlugin umLttngPlugin = {
     &logProcessEvent,
     &logFrameEvent,
     &logWindowEvent,
     &logGenericEvent,
+    &logSummaryEvent,
+    &logPaintNodeEvent,
 };
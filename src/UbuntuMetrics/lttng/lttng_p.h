@@ -25,12 +25,16 @@ typedef struct _UMLTTNGProcessEvent UMLTTNGProcessEvent;
 typedef struct _UMLTTNGFrameEvent UMLTTNGFrameEvent;
 typedef struct _UMLTTNGWindowEvent UMLTTNGWindowEvent;
 typedef struct _UMLTTNGGenericEvent UMLTTNGGenericEvent;
+typedef struct _UMLTTNGSummaryEvent UMLTTNGSummaryEvent;
+typedef struct _UMLTTNGPaintNodeEvent UMLTTNGPaintNodeEvent;
 
 struct UMLTTNGPlugin {
     void (*logProcessEvent)(UMLTTNGProcessEvent*);
     void (*logFrameEvent)(UMLTTNGFrameEvent*);
     void (*logWindowEvent)(UMLTTNGWindowEvent*);
     void (*logGenericEvent)(UMLTTNGGenericEvent*);
+    void (*logSummaryEvent)(UMLTTNGSummaryEvent*);
+    void (*logPaintNodeEvent)(UMLTTNGPaintNodeEvent*);
 };
 
 struct _UMLTTNGProcessEvent {
@@ -65,4 +69,24 @@ struct _UMLTTNGGenericEvent {
     char string[64];
 };
 
+struct _UMLTTNGSummaryEvent {
+    uint32_t window;
+    uint32_t frameCount;
+    // Keep the sizes in sync with UMSummaryEvent::MetricCount.
+    uint32_t p50[5];
+    uint32_t p95[5];
+    uint32_t p99[5];
+    uint32_t max[5];
+};
+
+struct _UMLTTNGPaintNodeEvent {
+    uint32_t frame;
+    uint32_t itemCount;
+    uint64_t frameTime;
+    uint64_t time;
+    // Keep the sizes in sync with UMPaintNodeEvent::maxNameSize.
+    char className[44];
+    char objectName[44];
+};
+
 #endif  // LTTNG_P_H
@@ -79,5 +79,35 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    UbuntuMetrics, summary,
+    TP_ARGS(
+        UMLTTNGSummaryEvent*, summaryEvent
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, window, summaryEvent->window)
+        ctf_integer(uint32_t, frame_count, summaryEvent->frameCount)
+        ctf_array(uint32_t, p50, summaryEvent->p50, 5)
+        ctf_array(uint32_t, p95, summaryEvent->p95, 5)
+        ctf_array(uint32_t, p99, summaryEvent->p99, 5)
+        ctf_array(uint32_t, max, summaryEvent->max, 5)
+    )
+)
+
+TRACEPOINT_EVENT(
+    UbuntuMetrics, paint_node,
+    TP_ARGS(
+        UMLTTNGPaintNodeEvent*, paintNodeEvent
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, frame, paintNodeEvent->frame)
+        ctf_integer(uint32_t, item_count, paintNodeEvent->itemCount)
+        ctf_integer(uint64_t, frame_time, paintNodeEvent->frameTime)
+        ctf_integer(uint64_t, time, paintNodeEvent->time)
+        ctf_string(class_name, paintNodeEvent->className)
+        ctf_string(object_name, paintNodeEvent->objectName)
+    )
+)
+
 #endif  // TRACEPOINTS_P_H
 #include <lttng/tracepoint-event.h>
@@ -51,24 +51,37 @@ static const struct {
     quint16 defaultWidth;
     UMEvent::Type type;
 } metricInfo[] = {
-    { "cpuUsage",    sizeof("cpuUsage") - 1,    3, UMEvent::Process },
-    { "threadCount", sizeof("threadCount") - 1, 3, UMEvent::Process },
-    { "vszMemory",   sizeof("vszMemory") - 1,   8, UMEvent::Process },
-    { "rssMemory",   sizeof("rssMemory") - 1,   8, UMEvent::Process },
-    { "windowId",    sizeof("windowId") - 1,    2, UMEvent::Window  },
-    { "windowSize",  sizeof("windowSize") - 1,  9, UMEvent::Window  },
-    { "frameNumber", sizeof("frameNumber") - 1, 7, UMEvent::Frame   },
-    { "deltaTime",   sizeof("deltaTime") - 1,   7, UMEvent::Frame   },
-    { "syncTime",    sizeof("syncTime") - 1,    7, UMEvent::Frame   },
-    { "renderTime",  sizeof("renderTime") - 1,  7, UMEvent::Frame   },
-    { "gpuTime",     sizeof("gpuTime") - 1,     7, UMEvent::Frame   },
-    { "totalTime",   sizeof("totalTime") - 1,   7, UMEvent::Frame   }
+    { "cpuUsage",       sizeof("cpuUsage") - 1,       3, UMEvent::Process },
+    { "threadCount",    sizeof("threadCount") - 1,    3, UMEvent::Process },
+    { "vszMemory",      sizeof("vszMemory") - 1,      8, UMEvent::Process },
+    { "rssMemory",      sizeof("rssMemory") - 1,      8, UMEvent::Process },
+    { "guiCpuUsage",    sizeof("guiCpuUsage") - 1,    3, UMEvent::Process },
+    { "renderCpuUsage", sizeof("renderCpuUsage") - 1, 3, UMEvent::Process },
+    { "qmlCpuUsage",    sizeof("qmlCpuUsage") - 1,    3, UMEvent::Process },
+    { "loggerCpuUsage", sizeof("loggerCpuUsage") - 1, 3, UMEvent::Process },
+    { "guiSwitches",    sizeof("guiSwitches") - 1,    5, UMEvent::Process },
+    { "renderSwitches", sizeof("renderSwitches") - 1, 5, UMEvent::Process },
+    { "qmlSwitches",    sizeof("qmlSwitches") - 1,    5, UMEvent::Process },
+    { "loggerSwitches", sizeof("loggerSwitches") - 1, 5, UMEvent::Process },
+    { "windowId",       sizeof("windowId") - 1,       2, UMEvent::Window  },
+    { "windowSize",     sizeof("windowSize") - 1,     9, UMEvent::Window  },
+    { "frameNumber",    sizeof("frameNumber") - 1,    7, UMEvent::Frame   },
+    { "deltaTime",      sizeof("deltaTime") - 1,      7, UMEvent::Frame   },
+    { "syncTime",       sizeof("syncTime") - 1,       7, UMEvent::Frame   },
+    { "renderTime",     sizeof("renderTime") - 1,     7, UMEvent::Frame   },
+    { "gpuTime",        sizeof("gpuTime") - 1,        7, UMEvent::Frame   },
+    { "totalTime",      sizeof("totalTime") - 1,      7, UMEvent::Frame   }
 };
 enum {
-    CpuUsage = 0, ThreadCount, VszMemory, RssMemory, WindowId, WindowSize, FrameNumber, DeltaTime,
-    SyncTime, RenderTime, GpuTime, TotalTime, MetricCount
+    CpuUsage = 0, ThreadCount, VszMemory, RssMemory, GuiCpuUsage, RenderCpuUsage, QmlCpuUsage,
+    LoggerCpuUsage, GuiSwitches, RenderSwitches, QmlSwitches, LoggerSwitches, WindowId, WindowSize,
+    FrameNumber, DeltaTime, SyncTime, RenderTime, GpuTime, TotalTime, MetricCount
 };
 Q_STATIC_ASSERT(ARRAY_SIZE(metricInfo) == MetricCount);
+// Per-thread metrics are indexed by UMProcessEvent::Thread.
+Q_STATIC_ASSERT(
+    LoggerCpuUsage - GuiCpuUsage == UMProcessEvent::LoggerThread
+    && LoggerSwitches - GuiSwitches == UMProcessEvent::LoggerThread);
 
 const int maxMetricWidth = 32;
 const int maxKeywordStringSize = 128;
@@ -343,6 +356,23 @@ void Overlay::updateProcessMetrics()
         case RssMemory:
             integerMetricToText(m_processEvent.process.rssMemory, text, textWidth);
             break;
+        case GuiCpuUsage:
+        case RenderCpuUsage:
+        case QmlCpuUsage:
+        case LoggerCpuUsage: {
+            const int thread = m_metrics[UMEvent::Process][i].index - GuiCpuUsage;
+            integerMetricToText(m_processEvent.process.threadCpuUsage[thread], text, textWidth);
+            break;
+        }
+        case GuiSwitches:
+        case RenderSwitches:
+        case QmlSwitches:
+        case LoggerSwitches: {
+            const int thread = m_metrics[UMEvent::Process][i].index - GuiSwitches;
+            integerMetricToText(
+                m_processEvent.process.threadContextSwitches[thread], text, textWidth);
+            break;
+        }
         default:
             DNOT_REACHED();
             break;
@@ -0,0 +1,332 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+// Converts binary logs written by UMFileLogger to the parsable text format
+// (one event per line, space separated values) or to CSV.
+//
+// Usage: metrics-log-decoder [--csv] [-o <output>] <input> [<input>...]
+//
+// The segments of a rolling log (written by UMRollingFileLogger) can be passed
+// at once, they are decoded in sequence order.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QTextStream>
+
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/logger.h>
+
+// The CSV output has a column group per event type, columns of the other
+// groups are left empty.
+enum CsvGroup {
+    ProcessGroup, WindowGroup, FrameGroup, GenericGroup, SummaryGroup, PaintNodeGroup, GroupCount
+};
+static const int csvGroupSize[GroupCount] = {
+    4, 4, 7, 2, 2 + 4 * UMSummaryEvent::MetricCount, 6
+};
+
+static const char* const csvHeader =
+    "type,timeStamp,"
+    "cpuUsage,vszMemory,rssMemory,threadCount,"
+    "windowId,windowState,width,height,"
+    "frameWindow,frameNumber,deltaTime,syncTime,renderTime,gpuTime,swapTime,"
+    "genericId,genericString,"
+    "summaryWindow,summaryFrameCount,"
+    "deltaTimeP50,deltaTimeP95,deltaTimeP99,deltaTimeMax,"
+    "syncTimeP50,syncTimeP95,syncTimeP99,syncTimeMax,"
+    "renderTimeP50,renderTimeP95,renderTimeP99,renderTimeMax,"
+    "gpuTimeP50,gpuTimeP95,gpuTimeP99,gpuTimeMax,"
+    "swapTimeP50,swapTimeP95,swapTimeP99,swapTimeMax,"
+    "paintNodeFrame,paintNodeItemCount,paintNodeFrameTime,paintNodeTime,"
+    "paintNodeClassName,paintNodeObjectName\n";
+
+static void writeText(QTextStream& out, const UMEvent& event)
+{
+    switch (event.type) {
+    case UMEvent::Process:
+        out << "P "
+            << event.timeStamp << ' '
+            << event.process.cpuUsage << ' '
+            << event.process.vszMemory << ' '
+            << event.process.rssMemory << ' '
+            << event.process.threadCount << '\n';
+        break;
+    case UMEvent::Frame:
+        out << "F "
+            << event.timeStamp << ' '
+            << event.frame.window << ' '
+            << event.frame.number << ' '
+            << event.frame.deltaTime << ' '
+            << event.frame.syncTime << ' '
+            << event.frame.renderTime << ' '
+            << event.frame.gpuTime << ' '
+            << event.frame.swapTime << '\n';
+        break;
+    case UMEvent::Window:
+        out << "W "
+            << event.timeStamp << ' '
+            << event.window.id << ' '
+            << event.window.state << ' '
+            << event.window.width << ' '
+            << event.window.height << '\n';
+        break;
+    case UMEvent::Generic:
+        out << "G "
+            << event.timeStamp << ' '
+            << event.generic.id << ' '
+            << event.generic.string << '\n';
+        break;
+    case UMEvent::Summary:
+        out << "S "
+            << event.timeStamp << ' '
+            << event.summary.window << ' '
+            << event.summary.frameCount;
+        for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+            out << ' ' << event.summary.p50[i] << ' ' << event.summary.p95[i]
+                << ' ' << event.summary.p99[i] << ' ' << event.summary.max[i];
+        }
+        out << '\n';
+        break;
+    case UMEvent::PaintNode:
+        out << "N "
+            << event.timeStamp << ' '
+            << event.paintNode.frame << ' '
+            << event.paintNode.itemCount << ' '
+            << event.paintNode.frameTime << ' '
+            << event.paintNode.time << ' '
+            << event.paintNode.className << ' '
+            << event.paintNode.objectName << '\n';
+        break;
+    default:
+        break;
+    }
+}
+
+// Quote a CSV string, doubling inner quotes.
+static QByteArray quoteCsv(const char* string)
+{
+    QByteArray quoted(string);
+    quoted.replace('"', "\"\"");
+    return '"' + quoted + '"';
+}
+
+static void writeCsvRow(
+    QTextStream& out, char type, quint64 timeStamp, CsvGroup group, const QList<QByteArray>& values)
+{
+    Q_ASSERT(values.size() == csvGroupSize[group]);
+
+    out << type << ',' << timeStamp;
+    for (int i = 0; i < GroupCount; ++i) {
+        for (int j = 0; j < csvGroupSize[i]; ++j) {
+            out << ',';
+            if (i == group) {
+                out << values[j];
+            }
+        }
+    }
+    out << '\n';
+}
+
+static void writeCsv(QTextStream& out, const UMEvent& event)
+{
+    QList<QByteArray> values;
+
+    switch (event.type) {
+    case UMEvent::Process:
+        values << QByteArray::number(event.process.cpuUsage)
+               << QByteArray::number(event.process.vszMemory)
+               << QByteArray::number(event.process.rssMemory)
+               << QByteArray::number(event.process.threadCount);
+        writeCsvRow(out, 'P', event.timeStamp, ProcessGroup, values);
+        break;
+    case UMEvent::Window:
+        values << QByteArray::number(event.window.id)
+               << QByteArray::number(event.window.state)
+               << QByteArray::number(event.window.width)
+               << QByteArray::number(event.window.height);
+        writeCsvRow(out, 'W', event.timeStamp, WindowGroup, values);
+        break;
+    case UMEvent::Frame:
+        values << QByteArray::number(event.frame.window)
+               << QByteArray::number(event.frame.number)
+               << QByteArray::number(event.frame.deltaTime)
+               << QByteArray::number(event.frame.syncTime)
+               << QByteArray::number(event.frame.renderTime)
+               << QByteArray::number(event.frame.gpuTime)
+               << QByteArray::number(event.frame.swapTime);
+        writeCsvRow(out, 'F', event.timeStamp, FrameGroup, values);
+        break;
+    case UMEvent::Generic:
+        values << QByteArray::number(event.generic.id)
+               << quoteCsv(event.generic.string);
+        writeCsvRow(out, 'G', event.timeStamp, GenericGroup, values);
+        break;
+    case UMEvent::Summary:
+        values << QByteArray::number(event.summary.window)
+               << QByteArray::number(event.summary.frameCount);
+        for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+            values << QByteArray::number(event.summary.p50[i])
+                   << QByteArray::number(event.summary.p95[i])
+                   << QByteArray::number(event.summary.p99[i])
+                   << QByteArray::number(event.summary.max[i]);
+        }
+        writeCsvRow(out, 'S', event.timeStamp, SummaryGroup, values);
+        break;
+    case UMEvent::PaintNode:
+        values << QByteArray::number(event.paintNode.frame)
+               << QByteArray::number(event.paintNode.itemCount)
+               << QByteArray::number(event.paintNode.frameTime)
+               << QByteArray::number(event.paintNode.time)
+               << quoteCsv(event.paintNode.className)
+               << quoteCsv(event.paintNode.objectName);
+        writeCsvRow(out, 'N', event.timeStamp, PaintNodeGroup, values);
+        break;
+    default:
+        break;
+    }
+}
+
+static bool readHeader(QFile& input, UMBinaryLogHeader* header)
+{
+    const QByteArray name = QFile::encodeName(input.fileName());
+    if (input.read(reinterpret_cast<char*>(header), sizeof(*header)) != sizeof(*header)
+        || memcmp(header->magic, "UMLG", 4)) {
+        fprintf(stderr, "'%s' is not a binary metrics log.\n", name.constData());
+        return false;
+    }
+    if (header->byteOrder != UMBinaryLogHeader::byteOrderMark) {
+        fprintf(stderr, "'%s' has been written with a different byte order.\n", name.constData());
+        return false;
+    }
+    if (header->version > UMBinaryLogHeader::currentVersion) {
+        fprintf(stderr, "'%s' has an unsupported version %u.\n", name.constData(),
+                header->version);
+        return false;
+    }
+    return true;
+}
+
+static void decode(QFile& input, QTextStream& out, bool csv)
+{
+    // Records written by a newer version can be bigger, the additional bytes
+    // are skipped. Smaller records are zero-extended. A size of 0 marks the end
+    // of a rolling log segment.
+    quint32 recordHeader[2];
+    UMEvent event;
+    while (input.read(reinterpret_cast<char*>(recordHeader), sizeof(recordHeader))
+           == sizeof(recordHeader)) {
+        const quint32 size = recordHeader[0];
+        if (size == 0) {
+            break;
+        }
+        const quint32 readSize = qMin(size, quint32(sizeof(UMEvent)));
+        memset(&event, 0, sizeof(UMEvent));
+        if (input.read(reinterpret_cast<char*>(&event), readSize) != readSize) {
+            fprintf(stderr, "Truncated record at the end of '%s'.\n",
+                    QFile::encodeName(input.fileName()).constData());
+            break;
+        }
+        if (size > readSize && !input.seek(input.pos() + size - readSize)) {
+            break;
+        }
+        // Ensure event strings are null-terminated.
+        if (event.type == UMEvent::Generic) {
+            event.generic.string[UMGenericEvent::maxStringSize - 1] = '\0';
+        } else if (event.type == UMEvent::PaintNode) {
+            event.paintNode.className[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+            event.paintNode.objectName[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+        }
+        if (csv) {
+            writeCsv(out, event);
+        } else {
+            writeText(out, event);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool csv = false;
+    const char* outputName = nullptr;
+    QList<const char*> inputNames;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--csv")) {
+            csv = true;
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            outputName = argv[++i];
+        } else {
+            inputNames.append(argv[i]);
+        }
+    }
+    if (inputNames.isEmpty()) {
+        fprintf(stderr, "Usage: %s [--csv] [-o <output>] <input> [<input>...]\n", argv[0]);
+        return 1;
+    }
+
+    // Open the inputs and sort them by sequence number, so that the segments
+    // of a rolling log can be given in any order.
+    QList<QPair<quint32, QFile*> > inputs;
+    for (int i = 0; i < inputNames.size(); ++i) {
+        QFile* input = new QFile(QString::fromLocal8Bit(inputNames[i]));
+        UMBinaryLogHeader header;
+        if (!input->open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "Can't open file '%s'.\n", inputNames[i]);
+            delete input;
+            continue;
+        }
+        if (!readHeader(*input, &header)) {
+            delete input;
+            continue;
+        }
+        inputs.append(qMakePair(header.sequence, input));
+    }
+    std::stable_sort(inputs.begin(), inputs.end(),
+                     [](const QPair<quint32, QFile*>& a, const QPair<quint32, QFile*>& b) {
+                         return a.first < b.first;
+                     });
+
+    QFile output;
+    const bool outputOpen = outputName
+        ? (output.setFileName(QString::fromLocal8Bit(outputName)),
+           output.open(QIODevice::WriteOnly | QIODevice::Text))
+        : output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    if (!outputOpen) {
+        fprintf(stderr, "Can't open output '%s'.\n", outputName ? outputName : "stdout");
+        for (int i = 0; i < inputs.size(); ++i) {
+            delete inputs[i].second;
+        }
+        return 1;
+    }
+
+    QTextStream out(&output);
+    out.setCodec("ISO 8859-1");
+    if (csv) {
+        out << csvHeader;
+    }
+    for (int i = 0; i < inputs.size(); ++i) {
+        decode(*inputs[i].second, out, csv);
+        delete inputs[i].second;
+    }
+
+    return inputs.size() == inputNames.size() ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = metrics-log-decoder
+QT = core
+CONFIG += c++11
+INCLUDEPATH += $$PWD/../../..
+SOURCES += logdecoder.cpp
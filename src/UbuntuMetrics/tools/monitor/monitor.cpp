@@ -0,0 +1,228 @@
+// Copyright © 2016 Canonical Ltd.
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+// Shows the live metrics of an application logging to shared memory (see
+// UMSharedMemoryLogger, enabled with UC_METRICS_LOGGING=shm). The segment is
+// mapped read-only and polled, the application's threads are never disturbed.
+//
+// Usage: metrics-monitor [--all] [--history] [-i <interval>] <pid>
+//
+// Frame events are shown by default, --all shows all the event types and
+// --history starts with the events still in the ring. The polling interval is
+// in milliseconds (100 by default).
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <QtCore/QByteArray>
+
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/logger.h>
+
+static const int maxReadAttempts = 16;
+
+// Seqlock read of a slot. expectedSequence is the sequence the slot must have,
+// 0 accepts any written event. Returns false if the slot doesn't store the
+// expected event or if it's constantly being written.
+static bool readSlot(const UMSharedMemorySlot* slot, quint32 expectedSequence, UMEvent* event)
+{
+    for (int i = 0; i < maxReadAttempts; ++i) {
+        const quint32 sequence = slot->sequence.loadAcquire();
+        if (sequence & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(event, &slot->event, sizeof(UMEvent));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load() != sequence) {
+            continue;
+        }
+        if (expectedSequence ? sequence != expectedSequence : sequence == 0) {
+            return false;
+        }
+        // Ensure event strings are null-terminated.
+        if (event->type == UMEvent::Generic) {
+            event->generic.string[UMGenericEvent::maxStringSize - 1] = '\0';
+        } else if (event->type == UMEvent::PaintNode) {
+            event->paintNode.className[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+            event->paintNode.objectName[UMPaintNodeEvent::maxNameSize - 1] = '\0';
+        }
+        return true;
+    }
+    return false;
+}
+
+static double toMs(quint64 ns)
+{
+    return ns / 1000000.0;
+}
+
+static void printEvent(const UMEvent& event)
+{
+    switch (event.type) {
+    case UMEvent::Frame:
+        printf("frame   window %u #%-6u delta %7.2f ms  sync %6.2f  render %6.2f  gpu %6.2f  "
+               "swap %6.2f\n", event.frame.window, event.frame.number,
+               toMs(event.frame.deltaTime), toMs(event.frame.syncTime),
+               toMs(event.frame.renderTime), toMs(event.frame.gpuTime),
+               toMs(event.frame.swapTime));
+        break;
+    case UMEvent::Process:
+        printf("process cpu %u%%  vsz %u kB  rss %u kB  threads %u\n", event.process.cpuUsage,
+               event.process.vszMemory, event.process.rssMemory, event.process.threadCount);
+        printf("threads gui %u%% (%u cs)  render %u%% (%u cs)  qml %u%% (%u cs)  "
+               "logger %u%% (%u cs)\n",
+               event.process.threadCpuUsage[UMProcessEvent::GuiThread],
+               event.process.threadContextSwitches[UMProcessEvent::GuiThread],
+               event.process.threadCpuUsage[UMProcessEvent::RenderThread],
+               event.process.threadContextSwitches[UMProcessEvent::RenderThread],
+               event.process.threadCpuUsage[UMProcessEvent::QmlThread],
+               event.process.threadContextSwitches[UMProcessEvent::QmlThread],
+               event.process.threadCpuUsage[UMProcessEvent::LoggerThread],
+               event.process.threadContextSwitches[UMProcessEvent::LoggerThread]);
+        break;
+    case UMEvent::Window:
+        printf("window  %u %s %ux%u\n", event.window.id,
+               event.window.state == UMWindowEvent::Hidden ? "hidden"
+               : event.window.state == UMWindowEvent::Shown ? "shown" : "resized",
+               event.window.width, event.window.height);
+        break;
+    case UMEvent::Generic:
+        printf("generic %u %s\n", event.generic.id, event.generic.string);
+        break;
+    case UMEvent::Summary:
+        printf("summary window %u frames %u  delta p50 %.2f p95 %.2f p99 %.2f max %.2f ms\n",
+               event.summary.window, event.summary.frameCount,
+               toMs(event.summary.p50[UMSummaryEvent::DeltaTime]),
+               toMs(event.summary.p95[UMSummaryEvent::DeltaTime]),
+               toMs(event.summary.p99[UMSummaryEvent::DeltaTime]),
+               toMs(event.summary.max[UMSummaryEvent::DeltaTime]));
+        break;
+    case UMEvent::PaintNode:
+        printf("node    frame %u %s '%s' %.3f ms\n", event.paintNode.frame,
+               event.paintNode.className, event.paintNode.objectName,
+               toMs(event.paintNode.time));
+        break;
+    default:
+        break;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool all = false;
+    bool history = false;
+    int interval = 100;
+    long pid = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--all")) {
+            all = true;
+        } else if (!strcmp(argv[i], "--history")) {
+            history = true;
+        } else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+            interval = qMax(atoi(argv[++i]), 1);
+        } else {
+            pid = strtol(argv[i], nullptr, 10);
+        }
+    }
+    if (pid <= 0) {
+        fprintf(stderr, "Usage: %s [--all] [--history] [-i <interval>] <pid>\n", argv[0]);
+        return 1;
+    }
+
+    const QByteArray name = QByteArray("/ubuntu-metrics-") + QByteArray::number(qint64(pid));
+    const int fd = shm_open(name.constData(), O_RDONLY | O_CLOEXEC, 0);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        fprintf(stderr, "Can't open shared memory segment '%s', is process %ld logging with "
+                "UC_METRICS_LOGGING=shm?\n", name.constData(), pid);
+        return 1;
+    }
+    void* segment = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED || static_cast<size_t>(info.st_size) < sizeof(UMSharedMemoryHeader)) {
+        fprintf(stderr, "Can't map shared memory segment '%s'.\n", name.constData());
+        return 1;
+    }
+
+    const UMSharedMemoryHeader* header = static_cast<const UMSharedMemoryHeader*>(segment);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (memcmp(header->magic, "UMSM", 4)) {
+        fprintf(stderr, "'%s' is not a metrics shared memory segment.\n", name.constData());
+        return 1;
+    }
+    if (header->version > UMSharedMemoryHeader::currentVersion
+        || header->eventSize != sizeof(UMEvent)) {
+        fprintf(stderr, "'%s' has an unsupported version %u.\n", name.constData(),
+                header->version);
+        return 1;
+    }
+    const quint32 ringSize = header->ringSize;
+    if (static_cast<size_t>(info.st_size) < sizeof(UMSharedMemoryHeader)
+        + (UMEvent::TypeCount + ringSize) * sizeof(UMSharedMemorySlot)) {
+        fprintf(stderr, "'%s' is truncated.\n", name.constData());
+        return 1;
+    }
+    const UMSharedMemorySlot* latest = reinterpret_cast<const UMSharedMemorySlot*>(
+        static_cast<const char*>(segment) + sizeof(UMSharedMemoryHeader));
+    const UMSharedMemorySlot* ring = latest + UMEvent::TypeCount;
+
+    // Start with the current state of the process.
+    UMEvent event;
+    if (readSlot(&latest[UMEvent::Process], 0, &event)) {
+        printEvent(event);
+    }
+
+    const quint32 eventCount = header->eventCount.loadAcquire();
+    quint32 next = history ? eventCount - qMin(eventCount, ringSize) : eventCount;
+    quint64 missed = 0;
+    while (true) {
+        const quint32 count = header->eventCount.loadAcquire();
+        // Events overwritten since the last poll are reported as missed.
+        if (count - next > ringSize) {
+            missed += count - next - ringSize;
+            next = count - ringSize;
+        }
+        for (; next != count; ++next) {
+            if (!readSlot(&ring[next % ringSize], 2 * next + 2, &event)) {
+                ++missed;
+            } else if (all || event.type == UMEvent::Frame) {
+                printEvent(event);
+            }
+        }
+        fflush(stdout);
+
+        if (kill(pid, 0) == -1 && errno == ESRCH) {
+            break;
+        }
+        usleep(interval * 1000);
+    }
+    if (missed > 0) {
+        fprintf(stderr, "%llu events missed, try a shorter interval.\n",
+                static_cast<unsigned long long>(missed));
+    }
+    fprintf(stderr, "Process %ld exited.\n", pid);
+    return 0;
+}
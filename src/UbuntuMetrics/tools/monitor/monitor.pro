@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = metrics-monitor
+QT = core
+CONFIG += c++11
+INCLUDEPATH += $$PWD/../../..
+LIBS += -lrt
+SOURCES += monitor.cpp
@@ -32,6 +32,7 @@ HEADERS += \
     $$PWD/exclusivegroup_p.h \
     $$PWD/filterbehavior_p.h \
     $$PWD/i18n_p.h \
+    $$PWD/imagecache_p.h \
     $$PWD/inversemouseareatype_p.h \
     $$PWD/label_p.h \
     $$PWD/listener_p.h \
@@ -62,6 +63,7 @@ HEADERS += \
     $$PWD/qquickclipboard_p_p.h \
     $$PWD/qquickmimedata_p.h \
     $$PWD/quickutils_p.h \
+    $$PWD/selectionranges_p.h \
     $$PWD/sortbehavior_p.h \
     $$PWD/sortfiltermodel_p.h \
     $$PWD/splitview_p.h \
@@ -149,6 +151,7 @@ SOURCES += \
     $$PWD/exclusivegroup.cpp \
     $$PWD/filterbehavior.cpp \
     $$PWD/i18n.cpp \
+    $$PWD/imagecache.cpp \
     $$PWD/inversemouseareatype.cpp \
     $$PWD/listener.cpp \
     $$PWD/livetimer.cpp \
@@ -174,6 +177,7 @@ SOURCES += \
     $$PWD/qquickclipboard.cpp \
     $$PWD/qquickmimedata.cpp \
     $$PWD/quickutils.cpp \
+    $$PWD/selectionranges.cpp \
     $$PWD/sortbehavior.cpp \
     $$PWD/sortfiltermodel.cpp \
     $$PWD/splitview.cpp \
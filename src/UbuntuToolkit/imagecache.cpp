@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imagecache_p.h"
+
+#include <QtCore/QMutexLocker>
+#include <UbuntuMetrics/applicationmonitor.h>
+
+#include <climits>
+#include <cstdio>
+
+UT_NAMESPACE_BEGIN
+
+ImageCache *ImageCache::instance()
+{
+    static ImageCache cache;
+    return &cache;
+}
+
+ImageCache::ImageCache()
+    : m_eventId(UMApplicationMonitor::instance()->registerGenericEvent())
+{
+    bool ok;
+    int size = qgetenv("UC_IMAGE_CACHE_SIZE").toInt(&ok);
+    // QCache costs are ints, the budget is clamped to about 2GB
+    m_images.setMaxCost(ok && size >= 0 ? qMin(size, INT_MAX / 1024) * 1024 : 8 * 1024 * 1024);
+}
+
+QImage ImageCache::image(const QString &path, const QSize &size, QRgb color)
+{
+    const Key key = { path, size, color };
+    QImage result;
+    {
+        QMutexLocker lock(&m_mutex);
+        // QCache::object() moves the image to the front of the LRU list
+        QImage *image = m_images.object(key);
+        if (image) {
+            result = *image;
+        }
+    }
+    if (result.isNull()) {
+        m_misses.ref();
+    } else {
+        m_hits.ref();
+    }
+    logStatistics(!result.isNull());
+    return result;
+}
+
+void ImageCache::insert(const QString &path, const QSize &size, const QImage &image, QRgb color)
+{
+    if (image.isNull()) {
+        return;
+    }
+    const Key key = { path, size, color };
+    QMutexLocker lock(&m_mutex);
+    // images larger than the budget are not kept
+    m_images.insert(key, new QImage(image), image.byteCount());
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_images.clear();
+}
+
+void ImageCache::setMaxCost(int bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_images.setMaxCost(bytes);
+}
+
+int ImageCache::maxCost() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_images.maxCost();
+}
+
+int ImageCache::totalCost() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_images.totalCost();
+}
+
+void ImageCache::logStatistics(bool hit)
+{
+    UMApplicationMonitor *monitor = UMApplicationMonitor::instance();
+    if (!monitor->logging() || !(monitor->loggingFilter() & UMApplicationMonitor::GenericEvent)) {
+        return;
+    }
+    char string[UMGenericEvent::maxStringSize];
+    int size = snprintf(string, sizeof(string), "ImageCache %s hits %d misses %d cost %dkB",
+                        hit ? "hit" : "miss", hits(), misses(), totalCost() / 1024);
+    monitor->logGenericEvent(m_eventId, string, qMin<quint32>(size + 1, sizeof(string)));
+}
+
+UT_NAMESPACE_END
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGECACHE_P_H
+#define IMAGECACHE_P_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCache>
+#include <QtCore/QMutex>
+#include <QtCore/QSize>
+#include <QtGui/QImage>
+
+#include <UbuntuToolkit/ubuntutoolkitglobal.h>
+
+UT_NAMESPACE_BEGIN
+
+/*
+ * Least recently used cache of decoded images, shared by the image providers.
+ * Images are keyed by file path, decoded size and the color they are tinted
+ * with (0 when not tinted), the least recently used ones are dropped once the
+ * byte budget is exceeded. The cache can be used from the image reader threads.
+ */
+class UBUNTUTOOLKIT_EXPORT ImageCache
+{
+public:
+    struct Key {
+        QString path;
+        QSize size;
+        QRgb color;
+
+        bool operator==(const Key &other) const
+        {
+            return path == other.path && size == other.size && color == other.color;
+        }
+    };
+
+    static ImageCache *instance();
+
+    // returns a null image if not cached
+    QImage image(const QString &path, const QSize &size, QRgb color = 0);
+    void insert(const QString &path, const QSize &size, const QImage &image, QRgb color = 0);
+    void clear();
+
+    // budget in bytes, defaults to 8MB, or UC_IMAGE_CACHE_SIZE in kB
+    void setMaxCost(int bytes);
+    int maxCost() const;
+    int totalCost() const;
+
+    int hits() const { return m_hits.load(); }
+    int misses() const { return m_misses.load(); }
+
+protected:
+    ImageCache();
+
+private:
+    void logStatistics(bool hit);
+
+    mutable QMutex m_mutex;
+    QCache<Key, QImage> m_images;
+    QAtomicInt m_hits;
+    QAtomicInt m_misses;
+    quint32 m_eventId;
+};
+
+inline uint qHash(const ImageCache::Key &key, uint seed = 0)
+{
+    return qHash(key.path, seed) ^ (uint(key.size.width()) << 16) ^ uint(key.size.height()) ^ key.color;
+}
+
+UT_NAMESPACE_END
+
+#endif // IMAGECACHE_P_H
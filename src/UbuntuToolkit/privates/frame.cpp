@@ -22,6 +22,7 @@
 #include <QtGui/QOpenGLFunctions>
 
 #include "privates/textures_p.h"
+#include "ucperformancemonitor_p.h"
 
 UT_NAMESPACE_BEGIN
 
@@ -459,6 +460,7 @@ void UCFrame::setColor(const QColor& color)
 QSGNode* UCFrame::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data)
 {
     Q_UNUSED(data);
+    UCPaintNodeTimer paintNodeTimer(this);
 
     const QSizeF itemSize(width(), height());
     if (itemSize.isEmpty() || m_thickness <= 0.0f) {
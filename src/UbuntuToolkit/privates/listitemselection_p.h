@@ -41,7 +41,7 @@ public:
     void setSelected(bool selected);
 
     void onSelectModeChanged();
-    void onSelectedIndicesChanged(const QList<int> &indices);
+    void onSelectionRangesChanged(int first, int last, bool selected);
 
 private:
     QPointer<UCViewItemsAttached> viewItems;
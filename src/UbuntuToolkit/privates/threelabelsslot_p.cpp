@@ -192,8 +192,8 @@ QColor UCThreeLabelsSlot::getSubtitleColor(QQuickItem *item, UCTheme *theme)
 {
     // FIXME: replace the code below with automatic color
     // change detection based on teh item's state
-    const char *valueSet = item->isEnabled() ? "normal" : "disabled";
-    return theme ? theme->getPaletteColor(valueSet, "backgroundSecondaryText") : QColor();
+    UCTheme::PaletteProfile valueSet = item->isEnabled() ? UCTheme::Normal : UCTheme::Disabled;
+    return theme ? theme->paletteColor(valueSet, UCTheme::BackgroundSecondaryText) : QColor();
 }
 
 UCLabel *UCThreeLabelsSlot::subtitle()
@@ -222,8 +222,8 @@ QColor UCThreeLabelsSlot::getSummaryColor(QQuickItem *item, UCTheme *theme)
 {
     // FIXME: replace the code below with automatic color
     // change detection based on teh item's state
-    const char *valueSet = item->isEnabled() ? "normal" : "disabled";
-    return theme ? theme->getPaletteColor(valueSet, "backgroundTertiaryText") : QColor();
+    UCTheme::PaletteProfile valueSet = item->isEnabled() ? UCTheme::Normal : UCTheme::Disabled;
+    return theme ? theme->paletteColor(valueSet, UCTheme::BackgroundTertiaryText) : QColor();
 }
 
 UCLabel *UCThreeLabelsSlot::summary()
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "selectionranges_p.h"
+
+#include <algorithm>
+
+UT_NAMESPACE_BEGIN
+
+SelectionRanges::SelectionRanges()
+    : m_count(0)
+{
+}
+
+// returns the position of the first range ending at or after index
+int SelectionRanges::lowerBound(int index) const
+{
+    int low = 0;
+    int high = m_ranges.size();
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (m_ranges[middle].last < index) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// returns the position of the first range starting after index
+int SelectionRanges::upperBound(int index) const
+{
+    int low = 0;
+    int high = m_ranges.size();
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (m_ranges[middle].first <= index) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// moves the ranges starting at position from by delta
+void SelectionRanges::shift(int from, int delta)
+{
+    for (int i = from; i < m_ranges.size(); i++) {
+        m_ranges[i].first += delta;
+        m_ranges[i].last += delta;
+    }
+}
+
+bool SelectionRanges::contains(int index) const
+{
+    int i = lowerBound(index);
+    return i < m_ranges.size() && m_ranges[i].first <= index;
+}
+
+// adds the indices between first and last (inclusive), merging the ranges
+// overlapping or touching it; returns true if any index got added
+bool SelectionRanges::insert(int first, int last)
+{
+    if (first > last) {
+        return false;
+    }
+    // ranges from i to j - 1 overlap or touch the new one
+    int i = lowerBound(first - 1);
+    int j = upperBound(last + 1);
+    if (i == j) {
+        Range range = {first, last};
+        m_ranges.insert(i, range);
+        m_count += last - first + 1;
+        return true;
+    }
+    if ((j - i) == 1 && m_ranges[i].first <= first && m_ranges[i].last >= last) {
+        return false;
+    }
+
+    Range merged = {qMin(first, m_ranges[i].first), qMax(last, m_ranges[j - 1].last)};
+    for (int k = i; k < j; k++) {
+        m_count -= m_ranges[k].last - m_ranges[k].first + 1;
+    }
+    m_count += merged.last - merged.first + 1;
+    m_ranges[i] = merged;
+    m_ranges.remove(i + 1, j - i - 1);
+    return true;
+}
+
+// removes the indices between first and last (inclusive); returns true if
+// any index got removed
+bool SelectionRanges::remove(int first, int last)
+{
+    if (first > last) {
+        return false;
+    }
+    // ranges from i to j - 1 overlap the removed one
+    int i = lowerBound(first);
+    int j = upperBound(last);
+    if (i == j) {
+        return false;
+    }
+
+    Range head = {m_ranges[i].first, first - 1};
+    Range tail = {last + 1, m_ranges[j - 1].last};
+    for (int k = i; k < j; k++) {
+        m_count -= qMin(m_ranges[k].last, last) - qMax(m_ranges[k].first, first) + 1;
+    }
+    m_ranges.remove(i, j - i);
+    if (tail.first <= tail.last) {
+        m_ranges.insert(i, tail);
+    }
+    if (head.first <= head.last) {
+        m_ranges.insert(i, head);
+    }
+    return true;
+}
+
+void SelectionRanges::clear()
+{
+    m_ranges.clear();
+    m_count = 0;
+}
+
+// removes index and moves the indices following it one position down
+void SelectionRanges::removeIndex(int index)
+{
+    remove(index, index);
+    int i = upperBound(index);
+    shift(i, -1);
+    // the ranges surrounding the removed index may touch now
+    if (i > 0 && i < m_ranges.size() && m_ranges[i - 1].last + 1 == m_ranges[i].first) {
+        m_ranges[i - 1].last = m_ranges[i].last;
+        m_ranges.remove(i);
+    }
+}
+
+// moves index and the indices following it one position up, and sets
+// the selection state of the new index
+void SelectionRanges::insertIndex(int index, bool selected)
+{
+    int i = lowerBound(index);
+    if (i < m_ranges.size() && m_ranges[i].first < index) {
+        // split the range containing the index
+        Range tail = {index, m_ranges[i].last};
+        m_ranges[i].last = index - 1;
+        m_ranges.insert(++i, tail);
+    }
+    shift(i, 1);
+    if (selected) {
+        insert(index, index);
+    }
+}
+
+// moves the index from to the position to, shifting the indices in between
+void SelectionRanges::move(int from, int to)
+{
+    if (from == to) {
+        return;
+    }
+    bool selected = contains(from);
+    removeIndex(from);
+    insertIndex(to, selected);
+}
+
+QList<int> SelectionRanges::toList() const
+{
+    QList<int> result;
+    result.reserve(m_count);
+    for (int i = 0; i < m_ranges.size(); i++) {
+        for (int index = m_ranges[i].first; index <= m_ranges[i].last; index++) {
+            result.append(index);
+        }
+    }
+    return result;
+}
+
+SelectionRanges SelectionRanges::fromList(const QList<int> &indices)
+{
+    QList<int> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    SelectionRanges result;
+    for (int i = 0; i < sorted.size(); i++) {
+        int first = sorted[i];
+        int last = first;
+        while ((i + 1) < sorted.size() && sorted[i + 1] <= last + 1) {
+            last = sorted[++i];
+        }
+        Range range = {first, last};
+        result.m_ranges.append(range);
+        result.m_count += last - first + 1;
+    }
+    return result;
+}
+
+// returns the ranges of indices which have different states in the two sets,
+// walking through the range boundaries only
+QVector<SelectionRanges::Change> SelectionRanges::diff(const SelectionRanges &before, const SelectionRanges &after)
+{
+    QVector<int> bounds;
+    bounds.reserve(2 * (before.m_ranges.size() + after.m_ranges.size()));
+    for (int i = 0; i < before.m_ranges.size(); i++) {
+        bounds << before.m_ranges[i].first << before.m_ranges[i].last + 1;
+    }
+    for (int i = 0; i < after.m_ranges.size(); i++) {
+        bounds << after.m_ranges[i].first << after.m_ranges[i].last + 1;
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    QVector<Change> changes;
+    // the state is constant between two consecutive bounds
+    for (int i = 0; (i + 1) < bounds.size(); i++) {
+        bool selected = after.contains(bounds[i]);
+        if (before.contains(bounds[i]) == selected) {
+            continue;
+        }
+        if (!changes.isEmpty() && changes.last().selected == selected
+                && changes.last().last + 1 == bounds[i]) {
+            changes.last().last = bounds[i + 1] - 1;
+        } else {
+            Change change = {bounds[i], bounds[i + 1] - 1, selected};
+            changes.append(change);
+        }
+    }
+    return changes;
+}
+
+bool SelectionRanges::operator==(const SelectionRanges &other) const
+{
+    if (m_count != other.m_count || m_ranges.size() != other.m_ranges.size()) {
+        return false;
+    }
+    for (int i = 0; i < m_ranges.size(); i++) {
+        if (m_ranges[i].first != other.m_ranges[i].first || m_ranges[i].last != other.m_ranges[i].last) {
+            return false;
+        }
+    }
+    return true;
+}
+
+UT_NAMESPACE_END
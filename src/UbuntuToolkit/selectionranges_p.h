@@ -0,0 +1,95 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SELECTIONRANGES_P_H
+#define SELECTIONRANGES_P_H
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+#include <UbuntuToolkit/ubuntutoolkitglobal.h>
+
+UT_NAMESPACE_BEGIN
+
+/*
+ * Set of indices stored as sorted, disjoint and non-adjacent ranges, so that
+ * selecting or deselecting a block of items costs the same as a single one.
+ */
+class UBUNTUTOOLKIT_EXPORT SelectionRanges
+{
+public:
+    // inclusive range of indices
+    struct Range {
+        int first;
+        int last;
+    };
+    // range of indices which changed their selection state
+    struct Change {
+        int first;
+        int last;
+        bool selected;
+    };
+
+    SelectionRanges();
+
+    bool contains(int index) const;
+    int count() const
+    {
+        return m_count;
+    }
+    bool isEmpty() const
+    {
+        return m_ranges.isEmpty();
+    }
+    const QVector<Range> &ranges() const
+    {
+        return m_ranges;
+    }
+
+    bool insert(int first, int last);
+    bool remove(int first, int last);
+    void clear();
+
+    // index shifting, as happening when the model rows are moved
+    void removeIndex(int index);
+    void insertIndex(int index, bool selected);
+    void move(int from, int to);
+
+    QList<int> toList() const;
+    static SelectionRanges fromList(const QList<int> &indices);
+    static QVector<Change> diff(const SelectionRanges &before, const SelectionRanges &after);
+
+    bool operator==(const SelectionRanges &other) const;
+    bool operator!=(const SelectionRanges &other) const
+    {
+        return !operator==(other);
+    }
+
+private:
+    int lowerBound(int index) const;
+    int upperBound(int index) const;
+    void shift(int from, int delta);
+
+    QVector<Range> m_ranges;
+    int m_count;
+};
+
+UT_NAMESPACE_END
+
+Q_DECLARE_TYPEINFO(UT_PREPEND_NAMESPACE(SelectionRanges)::Range, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(UT_PREPEND_NAMESPACE(SelectionRanges)::Change, Q_PRIMITIVE_TYPE);
+
+#endif // SELECTIONRANGES_P_H
@@ -16,27 +16,33 @@
 
 uniform highp mat4 matrix;  // mediump was interpreted as lowp on PowerVR Rogue G6200 (arale).
 uniform bool textured;
+uniform mediump float distanceAAScale;
 
 attribute highp vec4 positionAttrib;  // highp because of matrix precision qualifier.
 attribute mediump vec2 shapeCoordAttrib;
 attribute mediump vec4 sourceCoordAttrib;
 attribute lowp float yCoordAttrib;
 attribute lowp vec4 backgroundColorAttrib;
+attribute lowp vec2 shapeParamsAttrib;  // Distance AA factor and source opacity.
 
 // FIXME(loicm) Optimize by reducing/packing varyings.
 varying mediump vec2 shapeCoord;
 varying mediump vec4 sourceCoord;
 varying lowp float yCoord;
 varying lowp vec4 backgroundColor;
+varying mediump float distanceAA;
+varying lowp float sourceOpacity;
 
 void main()
 {
     shapeCoord = shapeCoordAttrib;
     if (textured) {
         sourceCoord = sourceCoordAttrib;
+        sourceOpacity = shapeParamsAttrib.y;
     }
     yCoord = yCoordAttrib;
     backgroundColor = backgroundColorAttrib;
+    distanceAA = shapeParamsAttrib.x * distanceAAScale;
 
     gl_Position = matrix * positionAttrib;
 }
@@ -19,7 +19,13 @@
 #include "statesaverbackend_p.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSettings>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QStringList>
 #include <QtQml/QtQml>
@@ -34,13 +40,100 @@
 
 UT_NAMESPACE_BEGIN
 
+/*
+ * The archive is a binary file with the layout
+ *   quint32 magic, quint32 version, quint32 count,
+ *   count x { QString id, QByteArray properties }
+ * where properties is a serialized QVariantHash, decoded only when the id is
+ * restored. QVariant keeps the type of the values, so no type hints are needed.
+ */
+static const quint32 ArchiveMagic = 0x55535341; // "USSA"
+static const quint32 ArchiveVersion = 1;
+static const QDataStream::Version ArchiveStreamVersion = QDataStream::Qt_5_4;
+
+static QByteArray serializeState(const QVariantHash &values)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(ArchiveStreamVersion);
+    stream << values;
+    return data;
+}
+
+static QVariantHash deserializeState(const QByteArray &data)
+{
+    QVariantHash values;
+    QDataStream stream(data);
+    stream.setVersion(ArchiveStreamVersion);
+    stream >> values;
+    return values;
+}
+
+/*
+ * Writes a snapshot of the states into the archive. The file is replaced
+ * atomically, so a reader never sees a partially written archive.
+ */
+class ArchiveWriter : public QRunnable
+{
+public:
+    ArchiveWriter(const QString &fileName, const QHash<QString, QVariantHash> &states,
+                  const QHash<QString, QByteArray> &archivedStates)
+        : m_fileName(fileName)
+        , m_states(states)
+        , m_archivedStates(archivedStates)
+    {
+    }
+
+    void run() override
+    {
+        if (m_states.isEmpty() && m_archivedStates.isEmpty()) {
+            QFile::remove(m_fileName);
+            return;
+        }
+
+        QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+        QSaveFile file(m_fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCritical() << "[StateSaver] Cannot write appstate file" << m_fileName << file.errorString();
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(ArchiveStreamVersion);
+        stream << ArchiveMagic << ArchiveVersion
+               << quint32(m_states.count() + m_archivedStates.count());
+        for (auto i = m_states.constBegin(); i != m_states.constEnd(); ++i) {
+            stream << i.key() << serializeState(i.value());
+        }
+        for (auto i = m_archivedStates.constBegin(); i != m_archivedStates.constEnd(); ++i) {
+            stream << i.key() << i.value();
+        }
+
+        if (stream.status() != QDataStream::Ok || !file.commit()) {
+            qCritical() << "[StateSaver] Failed to write appstate file" << m_fileName;
+        }
+    }
+
+private:
+    QString m_fileName;
+    QHash<QString, QVariantHash> m_states;
+    QHash<QString, QByteArray> m_archivedStates;
+};
+
 StateSaverBackend *StateSaverBackend::m_instance = nullptr;
 
 StateSaverBackend::StateSaverBackend(QObject *parent)
     : QObject(parent)
-    , m_archive(0)
     , m_globalEnabled(true)
 {
+    m_writer.setMaxThreadCount(1);
+    // saves requested within the same event loop iteration (i.e. all StateSavers
+    // reacting on initiateStateSaving()) end up in a single archive write
+    m_writeTimer.setSingleShot(true);
+    m_writeTimer.setInterval(0);
+    QObject::connect(&m_writeTimer, &QTimer::timeout,
+                     this, &StateSaverBackend::writeArchive);
+
     // connect to application quit signal so when that is called, we can clean the states saved
     QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
                      this, &StateSaverBackend::cleanup);
@@ -63,20 +156,21 @@ StateSaverBackend::StateSaverBackend(QObject *parent)
 
 StateSaverBackend::~StateSaverBackend()
 {
-    if (m_archive) {
-        delete m_archive;
-    }
+    // let a pending write complete, the archive is needed by the next run
+    flush();
     m_instance = nullptr;
 }
 
 void StateSaverBackend::initialize()
 {
-    if (m_archive) {
+    if (!m_archiveFile.isEmpty()) {
         // delete previous archive
-        QFile archiveFile(m_archive.data()->fileName());
-        archiveFile.remove();
-        delete m_archive.data();
-        m_archive.clear();
+        m_writeTimer.stop();
+        m_writer.waitForDone();
+        QFile::remove(m_archiveFile);
+        m_archiveFile.clear();
+        m_states.clear();
+        m_archivedStates.clear();
     }
     QString applicationName(UCApplication::instance()->applicationName());
     if (applicationName.isEmpty()) {
@@ -97,22 +191,104 @@ void StateSaverBackend::initialize()
         qCritical() << "[StateSaver] No XDG_RUNTIME_DIR path set, cannot create appstate file.";
         return;
     }
-    m_archive = new QSettings(QStringLiteral("%1/%2/statesaver.appstate").
+    m_archiveFile = QStringLiteral("%1/%2/statesaver.appstate").
                               arg(runtimeDir).
-                              arg(applicationName), QSettings::NativeFormat);
-    m_archive->setFallbacksEnabled(false);
+                              arg(applicationName);
+    readArchive();
+}
+
+/*
+ * Reads the ids and their serialized properties from the archive. Archives
+ * written with QSettings by earlier versions are imported.
+ */
+void StateSaverBackend::readArchive()
+{
+    QFile file(m_archiveFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(ArchiveStreamVersion);
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic;
+    if (magic != ArchiveMagic) {
+        file.close();
+        importSettings();
+        return;
+    }
+    stream >> version >> count;
+    if (version != ArchiveVersion) {
+        qWarning() << "[StateSaver] Unsupported appstate file version" << version;
+        return;
+    }
+
+    m_archivedStates.reserve(count);
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        QString id;
+        QByteArray properties;
+        stream >> id >> properties;
+        m_archivedStates.insert(id, properties);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "[StateSaver] Corrupt appstate file, dropping saved states.";
+        m_archivedStates.clear();
+    }
+}
+
+void StateSaverBackend::importSettings()
+{
+    QSettings settings(m_archiveFile, QSettings::NativeFormat);
+    settings.setFallbacksEnabled(false);
+    Q_FOREACH(const QString &id, settings.childGroups()) {
+        settings.beginGroup(id);
+        QVariantHash values;
+        Q_FOREACH(const QString &propertyName, settings.childKeys()) {
+            if (propertyName.endsWith(QStringLiteral("_TYPE"))) {
+                continue;
+            }
+            // QSettings deserializes most values as QString, restore the type saved along
+            QVariant value = settings.value(propertyName);
+            QVariant type = settings.value(propertyName + "_TYPE");
+            if (type.isValid()) {
+                value.convert(type.toInt());
+            }
+            values.insert(propertyName, value);
+        }
+        settings.endGroup();
+        m_states.insert(id, values);
+    }
+}
+
+void StateSaverBackend::writeArchive()
+{
+    m_writeTimer.stop();
+    if (m_archiveFile.isEmpty()) {
+        return;
+    }
+    m_writer.start(new ArchiveWriter(m_archiveFile, m_states, m_archivedStates));
+}
+
+void StateSaverBackend::flush()
+{
+    if (m_writeTimer.isActive()) {
+        writeArchive();
+    }
+    m_writer.waitForDone();
 }
 
 void StateSaverBackend::cleanup()
 {
     reset();
-    m_archive.clear();
+    m_archiveFile.clear();
 }
 
 void StateSaverBackend::signalHandler(int type)
 {
     if (type == UnixSignalHandler::Interrupt) {
         Q_EMIT initiateStateSaving();
+        // the event loop may not get to the coalesced write anymore
+        flush();
         // disconnect aboutToQuit() so the state file doesn't get wiped upon quit
         QObject::disconnect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
                          this, &StateSaverBackend::cleanup);
@@ -151,31 +327,32 @@ void StateSaverBackend::removeId(const QString &id)
 
 int StateSaverBackend::load(const QString &id, QObject *item, const QStringList &properties)
 {
-    if (m_archive.isNull()) {
-        return 0;
+    QVariantHash values;
+    auto state = m_states.find(id);
+    if (state != m_states.end()) {
+        values = state.value();
+        m_states.erase(state);
+    } else {
+        auto archived = m_archivedStates.find(id);
+        if (archived == m_archivedStates.end()) {
+            return 0;
+        }
+        values = deserializeState(archived.value());
+        m_archivedStates.erase(archived);
     }
+    // drop cache once properties are restored
+    m_writeTimer.start();
 
     int result = 0;
-    // save the previous group
-    bool restorePreviousGroup = !m_archive->group().isEmpty();
-    if (restorePreviousGroup) {
-        m_groupStack.push(m_archive->group());
-        // leave the group so we can read the next one
-        m_archive->endGroup();
-    }
-    m_archive.data()->beginGroup(id);
-    QStringList propertyNames = m_archive.data()->childKeys();
-    Q_FOREACH(const QString &propertyName, propertyNames) {
-        QVariant value = m_archive.data()->value(propertyName);
+    for (auto i = values.constBegin(); i != values.constEnd(); ++i) {
+        const QString &propertyName = i.key();
         if (!properties.contains(propertyName)) {
             // skip the property
             continue;
         }
-        QQmlProperty qmlProperty(
-            item, QString::fromLatin1(propertyName.toLocal8Bit().constData()), qmlContext(item));
+        QQmlProperty qmlProperty(item, propertyName, qmlContext(item));
         if (qmlProperty.isValid() && qmlProperty.isWritable()) {
-            QVariant type = m_archive.data()->value(propertyName + "_TYPE");
-            value.convert(type.toInt());
+            const QVariant &value = i.value();
             bool writeSuccess = qmlProperty.write(value);
             if (writeSuccess) {
                 result++;
@@ -193,49 +370,43 @@ int StateSaverBackend::load(const QString &id, QObject *item, const QStringList
                              .arg(propertyName).arg(qmlContext(item)->nameForObject(item));
         }
     }
-    // drop cache once properties are successfully restored
-    m_archive.data()->remove(QStringLiteral(""));
-    m_archive.data()->endGroup();
-    // restore leaved group if needed
-    if (restorePreviousGroup) {
-        m_archive->beginGroup(m_groupStack.pop());
-    }
     return result;
 }
 
 int StateSaverBackend::save(const QString &id, QObject *item, const QStringList &properties)
 {
-    if (m_archive.isNull()) {
+    if (m_archiveFile.isEmpty()) {
         return 0;
     }
-    m_archive.data()->beginGroup(id);
-    int result = 0;
+    QVariantHash values;
+    values.reserve(properties.count());
+    const QMetaObject *metaObject = item->metaObject();
     Q_FOREACH(const QString &propertyName, properties) {
-        QQmlProperty qmlProperty(
-            item, QString::fromLatin1(propertyName.toLocal8Bit().constData()));
-        if (qmlProperty.isValid()) {
-            QVariant value = qmlProperty.read();
-            if (static_cast<QMetaType::Type>(value.type()) != QMetaType::QObjectStar) {
-                if (value.userType() == qMetaTypeId<QJSValue>()) {
-                    value = value.value<QJSValue>().toVariant();
-                }
-                m_archive.data()->setValue(propertyName, value);
-                /* Save the type of the property along with its value.
-                 * This is important because QSettings deserializes values as QString.
-                 * Setting these strings to QML properties usually works because the
-                 * implicit type conversion from string to the type of the QML property
-                 * usually works. In some cases cases however (e.g. enum) it fails.
-                 *
-                 * See Qt Bug: https://bugreports.qt-project.org/browse/QTBUG-40474
-                 */
-                m_archive.data()->setValue(propertyName + "_TYPE", QVariant::fromValue((int)value.type()));
-                result++;
+        QVariant value;
+        // plain properties are read straight from the meta object, grouped and
+        // enum properties go through QQmlProperty, which knows how to deal with them
+        int index = propertyName.contains('.') ? -1 : metaObject->indexOfProperty(propertyName.toLatin1().constData());
+        if (index >= 0 && !metaObject->property(index).isEnumType()) {
+            value = metaObject->property(index).read(item);
+        } else {
+            QQmlProperty qmlProperty(item, propertyName);
+            if (!qmlProperty.isValid()) {
+                continue;
             }
+            value = qmlProperty.read();
         }
+        if (QMetaType::typeFlags(value.userType()) & QMetaType::PointerToQObject) {
+            continue;
+        }
+        if (value.userType() == qMetaTypeId<QJSValue>()) {
+            value = value.value<QJSValue>().toVariant();
+        }
+        values.insert(propertyName, value);
     }
-    m_archive.data()->endGroup();
-    m_archive.data()->sync();
-    return result;
+    m_archivedStates.remove(id);
+    m_states.insert(id, values);
+    m_writeTimer.start();
+    return values.count();
 }
 
 /*
@@ -244,9 +415,13 @@ int StateSaverBackend::save(const QString &id, QObject *item, const QStringList
 bool StateSaverBackend::reset()
 {
     m_register.clear();
-    if (m_archive) {
-        QFile archiveFile(m_archive.data()->fileName());
-        return archiveFile.remove();
+    m_writeTimer.stop();
+    m_writer.waitForDone();
+    m_states.clear();
+    m_archivedStates.clear();
+    if (!m_archiveFile.isEmpty()) {
+        QFile archiveFile(m_archiveFile);
+        return !archiveFile.exists() || archiveFile.remove();
     }
     return true;
 }
@@ -19,12 +19,12 @@
 #ifndef STATESAVERBACKEND_P_H
 #define STATESAVERBACKEND_P_H
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
-#include <QtCore/QPointer>
 #include <QtCore/QSet>
-#include <QtCore/QSettings>
-#include <QtCore/QStack>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTimer>
+#include <QtCore/QVariant>
 
 #include <UbuntuToolkit/ubuntutoolkitglobal.h>
 
@@ -55,8 +55,15 @@ public:
     int load(const QString &id, QObject *item, const QStringList &properties);
     int save(const QString &id, QObject *item, const QStringList &properties);
 
+    QString archiveFileName() const
+    {
+        return m_archiveFile;
+    }
+
 public Q_SLOTS:
     bool reset();
+    // writes pending states and waits till the archive is on disk
+    void flush();
 
 Q_SIGNALS:
     void enabledChanged(bool enabled);
@@ -69,11 +76,21 @@ private Q_SLOTS:
     void initialize();
     void cleanup();
     void signalHandler(int type);
+    void writeArchive();
 
 private:
-    QPointer<QSettings> m_archive;
+    void readArchive();
+    void importSettings();
+
+    // states saved in this session, not yet restored
+    QHash<QString, QVariantHash> m_states;
+    // states read from the archive, deserialized only when restored
+    QHash<QString, QByteArray> m_archivedStates;
     QSet<QString> m_register;
-    QStack<QString> m_groupStack;
+    QString m_archiveFile;
+    // single threaded, so archive writes never overlap
+    QThreadPool m_writer;
+    QTimer m_writeTimer;
     bool m_globalEnabled;
 
     static StateSaverBackend *m_instance;
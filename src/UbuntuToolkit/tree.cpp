@@ -16,22 +16,190 @@
 
 #include "tree_p.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QVector>
 #include <QtCore/private/qobject_p.h>
 #include <QtQml/QQmlEngine>
 
+#include <algorithm>
+
 UT_NAMESPACE_BEGIN
 
 class TreePrivate : public QObjectPrivate
 {
 public:
-    // list<object> of nodes
-    QList<QObject*> m_nodes;
-    // list<int> of parent nodes
-    QList<QObject*> m_parents;
-    // list<int> of stems
-    QList<int> m_stems;
+    // A node lives in a slot of m_nodes. Live slots are chained in insertion
+    // order (prev/next) and per stem (stemPrev/stemNext), free slots are
+    // chained through next and reused by add().
+    struct Node {
+        QObject *object;
+        QObject *parent;
+        quint64 sequence;
+        int stem;
+        int prev;
+        int next;
+        int stemPrev;
+        int stemNext;
+        // position in insertion order, valid while !m_positionsDirty
+        int position;
+    };
+    struct Stem {
+        int head;
+        int tail;
+    };
+
+    TreePrivate()
+        : m_head(-1)
+        , m_tail(-1)
+        , m_free(-1)
+        , m_count(0)
+        , m_sequence(0)
+        , m_positionsDirty(false)
+    {
+    }
+
+    int slot(QObject *node) const
+    {
+        return m_slots.value(node, -1);
+    }
+
+    void append(const int stem, QObject *parentNode, QObject *newNode);
+    QList<QObject *> remove(const int stem, const quint64 fromSequence);
+    void unlink(int slot);
+    void updatePositions() const;
+
+    QVector<Node> m_nodes;
+    QHash<QObject *, int> m_slots;
+    QMap<int, Stem> m_stems;
+    int m_head;
+    int m_tail;
+    int m_free;
+    int m_count;
+    quint64 m_sequence;
+    mutable bool m_positionsDirty;
 };
 
+void TreePrivate::append(const int stem, QObject *parentNode, QObject *newNode)
+{
+    int i = m_free;
+    if (i >= 0) {
+        m_free = m_nodes[i].next;
+    } else {
+        i = m_nodes.size();
+        m_nodes.append(Node());
+    }
+
+    QMap<int, Stem>::iterator list = m_stems.find(stem);
+    if (list == m_stems.end()) {
+        list = m_stems.insert(stem, Stem{-1, -1});
+    }
+    Node &node = m_nodes[i];
+    node.object = newNode;
+    node.parent = parentNode;
+    node.sequence = m_sequence++;
+    node.stem = stem;
+    node.position = m_count;
+    node.prev = m_tail;
+    node.next = -1;
+    if (m_tail >= 0) {
+        m_nodes[m_tail].next = i;
+    } else {
+        m_head = i;
+    }
+    m_tail = i;
+    node.stemPrev = list->tail;
+    node.stemNext = -1;
+    if (list->tail >= 0) {
+        m_nodes[list->tail].stemNext = i;
+    } else {
+        list->head = i;
+    }
+    list->tail = i;
+
+    m_slots.insert(newNode, i);
+    m_count++;
+}
+
+// Unlink the node in the given slot from both chains and put the slot on
+// the free list.
+void TreePrivate::unlink(int slot)
+{
+    Node &node = m_nodes[slot];
+
+    if (slot != m_tail) {
+        // removing from the middle shifts the positions of later nodes
+        m_positionsDirty = true;
+        m_nodes[node.next].prev = node.prev;
+    } else {
+        m_tail = node.prev;
+    }
+    if (node.prev >= 0) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_head = node.next;
+    }
+
+    QMap<int, Stem>::iterator list = m_stems.find(node.stem);
+    if (node.stemNext >= 0) {
+        m_nodes[node.stemNext].stemPrev = node.stemPrev;
+    } else {
+        list->tail = node.stemPrev;
+    }
+    if (node.stemPrev >= 0) {
+        m_nodes[node.stemPrev].stemNext = node.stemNext;
+    } else {
+        list->head = node.stemNext;
+    }
+    if (list->head < 0) {
+        m_stems.erase(list);
+    }
+
+    m_slots.remove(node.object);
+    node.object = nullptr;
+    node.parent = nullptr;
+    node.next = m_free;
+    m_free = slot;
+    m_count--;
+}
+
+// Remove the nodes in the given and higher stems that were added at or after
+// fromSequence. Only the removed nodes are visited.
+//
+// Returns the removed nodes in the order they were added.
+QList<QObject *> TreePrivate::remove(const int stem, const quint64 fromSequence)
+{
+    QVector<int> removed;
+    for (QMap<int, Stem>::const_iterator list = m_stems.lowerBound(stem); list != m_stems.constEnd(); ++list) {
+        for (int i = list->tail; i >= 0 && m_nodes[i].sequence >= fromSequence; i = m_nodes[i].stemPrev) {
+            removed.append(i);
+        }
+    }
+    std::sort(removed.begin(), removed.end(), [this](int a, int b) {
+        return m_nodes[a].sequence < m_nodes[b].sequence;
+    });
+
+    QList<QObject *> removedNodes;
+    removedNodes.reserve(removed.size());
+    for (int i : removed) {
+        removedNodes.append(m_nodes[i].object);
+    }
+    // unlink newest first so that popping the top keeps positions valid
+    for (int i = removed.size() - 1; i >= 0; i--) {
+        unlink(removed[i]);
+    }
+    return removedNodes;
+}
+
+void TreePrivate::updatePositions() const
+{
+    int position = 0;
+    for (int i = m_head; i >= 0; i = m_nodes[i].next) {
+        const_cast<Node&>(m_nodes[i]).position = position++;
+    }
+    m_positionsDirty = false;
+}
+
 Tree::Tree(QObject *parent) :
     QObject((*new TreePrivate), parent)
 {
@@ -42,7 +210,15 @@ Tree::Tree(QObject *parent) :
 // Returns -1 the node was not found.
 int Tree::index(QObject *node) const
 {
-    return d_func()->m_nodes.indexOf(node);
+    const Q_D(Tree);
+    int i = d->slot(node);
+    if (i < 0) {
+        return -1;
+    }
+    if (d->m_positionsDirty) {
+        d->updatePositions();
+    }
+    return d->m_nodes[i].position;
 }
 
 // Add newNode to the tree in the specified stem, with the specified parent node.
@@ -52,11 +228,11 @@ bool Tree::add(const int stem, QObject *parentNode, QObject *newNode)
 {
     Q_D(Tree);
 
-    if (index(newNode) != -1) {
+    if (d->slot(newNode) != -1) {
         qWarning("Cannot add the same node twice to a tree.");
         return false;
     }
-    if (d->m_nodes.size() == 0) {
+    if (d->m_count == 0) {
         // adding root node
         if (parentNode != nullptr) {
             qWarning("Root node must have parentNode null.");
@@ -68,15 +244,13 @@ bool Tree::add(const int stem, QObject *parentNode, QObject *newNode)
             qWarning("Only root node has parentNode null.");
             return false;
         }
-        if (index(parentNode) == -1) {
+        if (d->slot(parentNode) == -1) {
             qWarning("Cannot add non-root node if parentNode is not in the tree.");
             return false;
         }
     }
 
-    d->m_nodes.push_back(newNode);
-    d->m_stems.push_back(stem);
-    d->m_parents.push_back(parentNode);
+    d->append(stem, parentNode, newNode);
     return true;
 }
 
@@ -86,25 +260,7 @@ bool Tree::add(const int stem, QObject *parentNode, QObject *newNode)
 QList<QObject *> Tree::prune(const int stem)
 {
     Q_D(Tree);
-    QList<QObject *> newNodes;
-    QList<QObject *> newParents;
-    QList<QObject *> removedNodes;
-    QList<int> newStems;
-
-    for (int i = 0; i < d->m_nodes.length(); i++) {
-        if (d->m_stems[i] < stem) {
-            newNodes.push_back(d->m_nodes.at(i));
-            newStems.push_back(d->m_stems.at(i));
-            newParents.push_back(d->m_parents.at(i));
-        } else  {
-            removedNodes.push_back(d->m_nodes.at(i));
-        }
-    }
-
-    d->m_nodes = newNodes;
-    d->m_parents = newParents;
-    d->m_stems = newStems;
-    return removedNodes;
+    return d->remove(stem, 0);
 }
 
 // Chops all nodes with an index higher than the given node which
@@ -129,48 +285,16 @@ QList<QObject *> Tree::chop(const QVariant &jsNode, const QVariant &jsInclusive)
     if (jsInclusive.isValid() && jsInclusive.canConvert<bool>())
         inclusive = jsInclusive.toBool();
 
-    int nodeIndex = index(node);
-    if (nodeIndex < 0) {
+    int i = d->slot(node);
+    if (i < 0) {
         // given node is not in the tree.
         return QList<QObject *>();
     }
 
-    int size = 0;
-    if (inclusive) {
-        size = nodeIndex;
-    } else {
-        size = nodeIndex + 1;
-    }
-
-    // Nodes with index(node) >= nodeIndex && stem >= stems[nodeIndex];
-    QList<QObject *> badNodes; // to fill below
-
-    // Nodes with index(node) >= nodeIndex (any stem).
-    // Potential bad nodes to be removed.
-    QList<QObject *> uglyNodes = d->m_nodes.mid(size);
-    QList<QObject *> uglyParents = d->m_parents.mid(size);
-    QList<int> uglyStems = d->m_stems.mid(size); // to check below
-
-    int stem = d->m_stems[nodeIndex];
-    // Good nodes, with index(node) < nodeIndex && stem < stems[nodeIndex]:
-    d->m_nodes = d->m_nodes.mid(0, size);
-    d->m_stems = d->m_stems.mid(0, size);
-    d->m_parents = d->m_parents.mid(0, size);
-
-    // Add nodes with index(node) > nodeIndex && stem < stems[nodeIndex] back:
-    for (int i = 0; i < uglyNodes.length(); i++) {
-        if (uglyStems.at(i) < stem) {
-            // Because the stem of the parentNode <= stem of the node,
-            //  the node that is added back has the parentNode in nodes.
-            d->m_nodes.push_back(uglyNodes.at(i));
-            d->m_stems.push_back(uglyStems.at(i));
-            d->m_parents.push_back(uglyParents.at(i));
-        } else {
-            badNodes.push_back(uglyNodes.at(i));
-        }
-    }
-    return badNodes;
-
+    // Nodes added after the given node in a lower stem stay in the tree;
+    //  their parentNode has a stem <= their own stem, so it stays as well.
+    const TreePrivate::Node &chopped = d->m_nodes[i];
+    return d->remove(chopped.stem, inclusive ? chopped.sequence : chopped.sequence + 1);
 }
 
 // Returns the n'th node when traversing one or more stems from the
@@ -201,15 +325,27 @@ QObject *Tree::top(const QVariant &jsStem, const QVariant &jsExactMatch, const Q
     if (jsN.isValid() && jsN.canConvert<int>())
         n = jsN.value<int>();
 
-    int st;
-    int count = n;
-    for (int i = d->m_nodes.size() - 1; i >= 0; i--) {
-        st = d->m_stems[i];
-        if ((exactMatch && st == stem) || (!exactMatch && st >= stem)) {
-            count--;
+    if (n < 0) {
+        // a negative n matches the last node, whatever its stem
+        return d->m_tail >= 0 ? d->m_nodes[d->m_tail].object : nullptr;
+    }
+
+    if (exactMatch) {
+        QMap<int, TreePrivate::Stem>::const_iterator list = d->m_stems.constFind(stem);
+        if (list == d->m_stems.constEnd()) {
+            return nullptr;
         }
-        if (count < 0) {
-            return d->m_nodes.at(i);
+        for (int i = list->tail; i >= 0; i = d->m_nodes[i].stemPrev) {
+            if (n-- == 0) {
+                return d->m_nodes[i].object;
+            }
+        }
+        return nullptr;
+    }
+
+    for (int i = d->m_tail; i >= 0; i = d->m_nodes[i].prev) {
+        if (d->m_nodes[i].stem >= stem && n-- == 0) {
+            return d->m_nodes[i].object;
         }
     }
     return nullptr;
@@ -220,12 +356,12 @@ QObject *Tree::parent(QObject *node) const
 {
     const Q_D(Tree);
 
-    int i = index(node);
+    int i = d->slot(node);
     if (i == -1 //Specified node not found in tree.
-        || i == 0 ) { //Root node has no parent node.
+        || i == d->m_head ) { //Root node has no parent node.
         return nullptr;
     }
-    return d->m_parents.at(i);
+    return d->m_nodes[i].parent;
 }
 
 UT_NAMESPACE_END
@@ -276,8 +276,14 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
 
     engine->addImageProvider(QLatin1String("scaling"), new UCScalingImageProvider);
 
-    // register icon provider
+    // register icon providers, "theme-async" decodes off the GUI thread where
+    // supported and is used by Icon when asynchronous is set
     engine->addImageProvider(QLatin1String("theme"), new UnityThemeIconProvider);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    engine->addImageProvider(QLatin1String("theme-async"), new UnityThemeAsyncIconProvider);
+#else
+    engine->addImageProvider(QLatin1String("theme-async"), new UnityThemeIconProvider);
+#endif
 
     // Necessary for Screen.orientation (from import QtQuick.Window 2.0) to work
     QGuiApplication::primaryScreen()->setOrientationUpdateMask( Qt::ScreenOrientations(
@@ -309,10 +315,22 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
                 filter |= UMApplicationMonitor::FrameEvent;
             } else if (filterList[i] == QStringLiteral("generic")) {
                 filter |= UMApplicationMonitor::GenericEvent;
+            } else if (filterList[i] == QStringLiteral("summary")) {
+                filter |= UMApplicationMonitor::SummaryEvent;
+            } else if (filterList[i] == QStringLiteral("paintnode")) {
+                filter |= UMApplicationMonitor::PaintNodeEvent;
             }
         }
         applicationMonitor->setLoggingFilter(filter);
     }
+    const QByteArray metricsOverflowPolicy = qgetenv("UC_METRICS_OVERFLOW_POLICY");
+    if (metricsOverflowPolicy == "drop-oldest") {
+        applicationMonitor->setOverflowPolicy(UMApplicationMonitor::DropOldest);
+    } else if (metricsOverflowPolicy == "drop-newest") {
+        applicationMonitor->setOverflowPolicy(UMApplicationMonitor::DropNewest);
+    } else if (metricsOverflowPolicy == "block") {
+        applicationMonitor->setOverflowPolicy(UMApplicationMonitor::Block);
+    }
     const QByteArray metricsLogging = qgetenv("UC_METRICS_LOGGING");
     if (!metricsLogging.isNull()) {
         UMLogger* logger;
@@ -321,6 +339,37 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
 #if defined(Q_OS_LINUX)
         } else if (metricsLogging == "lttng") {
             logger = new UMLTTNGLogger();
+        } else if (metricsLogging == "shm") {
+            logger = new UMSharedMemoryLogger();
+#endif  // defined(Q_OS_LINUX)
+        } else if (qgetenv("UC_METRICS_LOGGING_FORMAT") == "binary") {
+            logger = new UMFileLogger(QString::fromLocal8Bit(metricsLogging), true, true);
+#if defined(Q_OS_LINUX)
+        } else if (qgetenv("UC_METRICS_LOGGING_FORMAT") == "rolling") {
+            // Segment size in kB, segment count and segment duration in
+            // seconds (0 to rotate by size only). Size and duration are
+            // clamped so that their conversion to bytes and milliseconds
+            // fits the 32-bit logger parameters.
+            const int maxSegmentSize = 1024 * 1024;  // 1 GiB.
+            const int maxSegmentDuration = 24 * 60 * 60;  // 1 day.
+            bool ok;
+            int segmentSize = qgetenv("UC_METRICS_LOGGING_SEGMENT_SIZE").toInt(&ok);
+            if (!ok || segmentSize <= 0) {
+                segmentSize = 4096;
+            }
+            segmentSize = qMin(segmentSize, maxSegmentSize);
+            int segmentCount = qgetenv("UC_METRICS_LOGGING_SEGMENT_COUNT").toInt(&ok);
+            if (!ok || segmentCount <= 0) {
+                segmentCount = 4;
+            }
+            int segmentDuration = qgetenv("UC_METRICS_LOGGING_SEGMENT_DURATION").toInt(&ok);
+            if (!ok || segmentDuration < 0) {
+                segmentDuration = 0;
+            }
+            segmentDuration = qMin(segmentDuration, maxSegmentDuration);
+            logger = new UMRollingFileLogger(
+                QString::fromLocal8Bit(metricsLogging), quint32(segmentSize) * 1024u, segmentCount,
+                quint32(segmentDuration) * 1000u);
 #endif  // defined(Q_OS_LINUX)
         } else {
             logger = new UMFileLogger(QString::fromLocal8Bit(metricsLogging));
@@ -335,6 +384,15 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
     if (qEnvironmentVariableIsSet("UC_METRICS_OVERLAY")) {
         applicationMonitor->setOverlay(true);
     }
+    if (qEnvironmentVariableIsSet("UC_METRICS_HISTOGRAMS")) {
+        // Optional summary interval in milliseconds.
+        bool ok;
+        const int summaryInterval = qgetenv("UC_METRICS_HISTOGRAMS").toInt(&ok);
+        if (ok) {
+            applicationMonitor->setUpdateInterval(UMEvent::Summary, summaryInterval);
+        }
+        applicationMonitor->setHistograms(true);
+    }
 
     // register performance monitor
     engine->rootContext()->setContextProperty(
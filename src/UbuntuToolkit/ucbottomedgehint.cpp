@@ -138,6 +138,8 @@ void UCBottomEdgeHint::init()
 
     // direction
     d->swipeArea->setDirection(UCSwipeArea::Upwards);
+    // follow the finger at frame rate, predicting where it will be when the frame is shown
+    UCSwipeAreaPrivate::get(d->swipeArea)->setTouchResampling(true);
 
     // grid unit sync
     connect(UCUnits::instance(), &UCUnits::gridUnitChanged, this, &UCBottomEdgeHint::onGridUnitChanged);
@@ -117,8 +117,8 @@ QColor UCLabelPrivate::getDefaultColor(QQuickItem *item, UCTheme *theme)
 {
     // FIXME: replace the code below with automatic color
     // change detection based on the item's state
-    const char *valueSet = item->isEnabled() ? "normal" : "disabled";
-    return theme ? theme->getPaletteColor(valueSet, "backgroundText") : QColor();
+    UCTheme::PaletteProfile valueSet = item->isEnabled() ? UCTheme::Normal : UCTheme::Disabled;
+    return theme ? theme->paletteColor(valueSet, UCTheme::BackgroundText) : QColor();
 }
 
 void UCLabel::classBegin()
@@ -38,6 +38,7 @@
 #include "ucaction_p.h"
 #include "uclistitemactions_p_p.h"
 #include "uclistitemstyle_p.h"
+#include "ucperformancemonitor_p.h"
 #include "uctheme_p.h"
 #include "ucubuntuanimation_p.h"
 #include "ucunits_p.h"
@@ -99,7 +100,7 @@ void UCListItemDivider::paletteChanged()
         QColor themeColor;
         UCTheme *theme = d->listItem->getTheme();
         if (theme) {
-            themeColor = d->listItem->getTheme()->getPaletteColor("normal", "base");
+            themeColor = theme->paletteColor(UCTheme::Normal, UCTheme::Base);
         }
         if (!themeColor.isValid()) {
             return;
@@ -130,6 +131,7 @@ void UCListItemDivider::updateGradient()
 QSGNode *UCListItemDivider::updatePaintNode(QSGNode *node, UpdatePaintNodeData *data)
 {
     Q_UNUSED(data);
+    UCPaintNodeTimer paintNodeTimer(this);
     Q_D(UCListItemDivider);
     QSGRectangleNode *dividerNode = static_cast<QSGRectangleNode*>(node);
     if (!dividerNode) {
@@ -1135,6 +1137,7 @@ void UCListItem::itemChange(ItemChange change, const ItemChangeData &data)
 QSGNode *UCListItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
 {
     Q_UNUSED(data);
+    UCPaintNodeTimer paintNodeTimer(this);
 
     Q_D(UCListItem);
     QColor color = d->highlighted ? d->highlightColor : d->color;
@@ -1157,7 +1160,7 @@ QSGNode *UCListItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data
     if (paintFocus) {
         QColor penColor;
         if (getTheme()) {
-            penColor = getTheme()->getPaletteColor(isEnabled() ? "normal" : "disabled", "focus");
+            penColor = getTheme()->paletteColor(isEnabled() ? UCTheme::Normal : UCTheme::Disabled, UCTheme::Focus);
         }
         rectNode->setPenColor(penColor);
         rectNode->setColor(Qt::transparent);
@@ -1804,7 +1807,7 @@ void UCListItem::resetHighlightColor()
     d->customColor = false;
     UCTheme *theme = getTheme();
     if (theme) {
-        d->highlightColor = theme->getPaletteColor("highlighted", "background");
+        d->highlightColor = theme->paletteColor(UCTheme::Highlighted, UCTheme::Background);
     }
     update();
     Q_EMIT highlightColorChanged();
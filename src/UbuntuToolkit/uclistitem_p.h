@@ -226,6 +226,7 @@ private Q_SLOTS:
 Q_SIGNALS:
     void selectModeChanged();
     void selectedIndicesChanged(const QList<int> &indices);
+    void selectionRangesChanged(int first, int last, bool selected);
     void dragModeChanged();
 
     void dragUpdated(UCDragEvent *event);
@@ -23,6 +23,7 @@
 #include <QtCore/QBasicTimer>
 #include <QtQuick/private/qquickrectangle_p.h>
 
+#include <UbuntuToolkit/private/selectionranges_p.h>
 #include <UbuntuToolkit/private/uclistitemstyle_p.h>
 #include <UbuntuToolkit/private/ucstyleditembase_p_p.h>
 
@@ -156,6 +157,8 @@ public:
     bool addSelectedItem(UCListItem *item);
     bool removeSelectedItem(UCListItem *item);
     bool isItemSelected(UCListItem *item);
+    void notifySelectionChanges(const QVector<SelectionRanges::Change> &changes);
+    bool isSelectedIndicesChangedConnected();
     void enterDragMode();
     void leaveDragMode();
     bool isDragUpdatedConnected();
@@ -167,7 +170,9 @@ public:
     void collapseAll();
     void toggleExpansionFlags(bool enable);
 
-    QSet<int> selectedList;
+    SelectionRanges selection;
+    // selectedIndices materialized from the selection, built on demand
+    mutable QList<int> selectedIndicesCache;
     QMap<int, QPointer<UCListItem> > expansionList;
     QList< QPointer<QQuickFlickable> > flickables;
     QPointer<UCListItem> boundItem;
@@ -177,6 +182,7 @@ public:
     bool selectable:1;
     bool draggable:1;
     bool ready:1;
+    mutable bool selectedIndicesDirty:1;
 };
 
 UT_NAMESPACE_END
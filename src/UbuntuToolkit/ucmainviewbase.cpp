@@ -95,7 +95,7 @@ void UCMainViewBasePrivate::doAutoTheme()
     if (!theme)
         return;
 
-    if (m_backgroundColor != theme->getPaletteColor("normal", "background")) {
+    if (m_backgroundColor != theme->paletteColor(UCTheme::Normal, UCTheme::Background)) {
         QString themeName = ColorUtils::luminance(m_backgroundColor) >= 0.85 ? QStringLiteral("Ambiance")
                                                                    : QStringLiteral("SuruDark");
 
@@ -18,7 +18,13 @@
 
 #include "ucperformancemonitor_p.h"
 
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
 #include <QtGui/QGuiApplication>
+#include <QtQuick/QQuickItem>
+#include <UbuntuMetrics/applicationmonitor.h>
+
+#include <algorithm>
 
 Q_LOGGING_CATEGORY(ucPerformance, "[PERFORMANCE]")
 
@@ -28,6 +34,52 @@ static int singleFrameThreshold = 32;
 static int multipleFrameThreshold = 17;
 static int framesCountThreshold = 10;
 static int warningCountThreshold = 30;
+// Number of frames over which percentiles are evaluated, 0 to disable.
+static int percentileFramesCount = 0;
+
+// Maximum number of updatePaintNode() calls recorded per frame, and reported
+// in the slow frame warnings and logs.
+static const int maxPaintNodeRecords = 512;
+static const int maxWarnedPaintNodes = 3;
+static const int maxLoggedPaintNodes = 8;
+
+struct PaintNodeRecord
+{
+    const char* className;
+    QString objectName;
+    qint64 time;
+};
+
+struct PaintNodeRecords
+{
+    PaintNodeRecords() : count(0) { records.reserve(maxPaintNodeRecords); }
+    QVector<PaintNodeRecord> records;
+    quint32 count;
+};
+
+static QThreadStorage<PaintNodeRecords*> paintNodeRecords;
+
+bool UCPaintNodeTimer::m_enabled = false;
+
+// static. Called on the render thread while the GUI thread is blocked, it's
+// safe to access the item there.
+void UCPaintNodeTimer::record(const QQuickItem* item, qint64 time)
+{
+    if (!paintNodeRecords.hasLocalData()) {
+        paintNodeRecords.setLocalData(new PaintNodeRecords);
+    }
+    PaintNodeRecords* records = paintNodeRecords.localData();
+    records->count++;
+    if (records->records.size() < maxPaintNodeRecords) {
+        const PaintNodeRecord record = { item->metaObject()->className(), item->objectName(), time };
+        records->records.append(record);
+    }
+}
+
+static bool paintNodeRecordGreaterThan(const PaintNodeRecord& a, const PaintNodeRecord& b)
+{
+    return a.time > b.time;
+}
 
 // TODO Qt 5.5. switch to qEnvironmentVariableIntValue
 static int getenvInt(const char* name, int defaultValue)
@@ -46,6 +98,7 @@ UCPerformanceMonitor::UCPerformanceMonitor(QObject* parent) :
     QObject(parent),
     m_framesAboveThreshold(0),
     m_warningCount(0),
+    m_slowFrameCount(0),
     m_window(NULL)
 {
     QObject::connect((QGuiApplication*)QGuiApplication::instance(), &QGuiApplication::applicationStateChanged,
@@ -55,6 +108,8 @@ UCPerformanceMonitor::UCPerformanceMonitor(QObject* parent) :
     multipleFrameThreshold = getenvInt("UC_PERFORMANCE_MONITOR_MULTIPLE_FRAME_THRESHOLD", multipleFrameThreshold);
     framesCountThreshold = getenvInt("UC_PERFORMANCE_MONITOR_FRAMES_COUNT_THRESHOLD", framesCountThreshold);
     warningCountThreshold = getenvInt("UC_PERFORMANCE_MONITOR_WARNING_COUNT_THRESHOLD", warningCountThreshold);
+    percentileFramesCount = getenvInt("UC_PERFORMANCE_MONITOR_PERCENTILE_FRAMES", percentileFramesCount);
+    UCPaintNodeTimer::setEnabled(getenvInt("UC_PERFORMANCE_MONITOR_ATTRIBUTION", 0) != 0);
 }
 
 UCPerformanceMonitor::~UCPerformanceMonitor()
@@ -115,6 +170,12 @@ void UCPerformanceMonitor::connectToWindow(QQuickWindow* window)
 
 void UCPerformanceMonitor::startTimer()
 {
+    // Only keep the updatePaintNode() calls of the monitored frame.
+    if (UCPaintNodeTimer::isEnabled() && paintNodeRecords.hasLocalData()) {
+        PaintNodeRecords* records = paintNodeRecords.localData();
+        records->records.resize(0);
+        records->count = 0;
+    }
     m_timer.start();
 }
 
@@ -124,9 +185,20 @@ void UCPerformanceMonitor::stopTimer()
         return;
     }
 
-    const int totalTimeInMs = m_timer.elapsed();
+    const qint64 frameTime = m_timer.nsecsElapsed();
     m_timer.invalidate();
 
+    if (UCPaintNodeTimer::isEnabled()) {
+        attributeFrame(frameTime);
+    }
+
+    if (percentileFramesCount > 0) {
+        checkPercentiles(frameTime);
+        return;
+    }
+
+    const int totalTimeInMs = frameTime / 1000000;
+
     if (totalTimeInMs >= singleFrameThreshold) {
         qCWarning(ucPerformance, "Last frame took %d ms to render.", totalTimeInMs);
         m_warningCount++;
@@ -151,6 +223,84 @@ void UCPerformanceMonitor::stopTimer()
     }
 }
 
+// Percentile mode, frame times are aggregated over a window of frames and a
+// warning is given if the 95th percentile exceeds the multiple frame threshold
+// or if the 99th percentile exceeds the single frame threshold. That catches
+// sustained slowness without warning on isolated spikes.
+void UCPerformanceMonitor::checkPercentiles(quint64 frameTime)
+{
+    m_frameTimes.add(frameTime);
+    if (m_frameTimes.count() < static_cast<quint64>(percentileFramesCount)) {
+        return;
+    }
+
+    const int p95InMs = m_frameTimes.percentile(95.0f) / 1000000;
+    const int p99InMs = m_frameTimes.percentile(99.0f) / 1000000;
+    m_frameTimes.reset();
+
+    if (p99InMs >= singleFrameThreshold) {
+        qCWarning(ucPerformance, "1%% of the last %d frames took over %d ms to render.",
+                  percentileFramesCount, p99InMs);
+        m_warningCount++;
+    } else if (p95InMs >= multipleFrameThreshold) {
+        qCWarning(ucPerformance, "5%% of the last %d frames took over %d ms to render.",
+                  percentileFramesCount, p95InMs);
+        m_warningCount++;
+    }
+
+    if (m_warningCount >= warningCountThreshold && warningCountThreshold != -1) {
+        qCWarning(ucPerformance, "Too many warnings were given. Performance monitoring stops.");
+        connectToWindow(NULL);
+    }
+}
+
+// Report the slowest updatePaintNode() calls of a slow frame, as a warning and
+// as paint node events if the application monitor logs them.
+void UCPerformanceMonitor::attributeFrame(qint64 frameTime)
+{
+    if (!paintNodeRecords.hasLocalData()) {
+        return;
+    }
+    PaintNodeRecords* records = paintNodeRecords.localData();
+    const int frameTimeInMs = frameTime / 1000000;
+
+    if (frameTimeInMs >= singleFrameThreshold && !records->records.isEmpty()) {
+        std::sort(records->records.begin(), records->records.end(), paintNodeRecordGreaterThan);
+        const int size = records->records.size();
+        m_slowFrameCount++;
+
+        QString slowest;
+        for (int i = 0; i < qMin(size, maxWarnedPaintNodes); ++i) {
+            const PaintNodeRecord& record = records->records[i];
+            slowest += QStringLiteral("%1%2 \"%3\" (%4 ms)")
+                .arg(i > 0 ? QStringLiteral(", ") : QString())
+                .arg(QLatin1String(record.className)).arg(record.objectName)
+                .arg(record.time / 1000000.0, 0, 'f', 2);
+        }
+        qCWarning(ucPerformance, "Frame took %d ms, %u items updated, slowest: %s.",
+                  frameTimeInMs, records->count, qPrintable(slowest));
+
+        UMApplicationMonitor* applicationMonitor = UMApplicationMonitor::instance();
+        UMPaintNodeEvent event;
+        event.frame = m_slowFrameCount;
+        event.itemCount = records->count;
+        event.frameTime = frameTime;
+        for (int i = 0; i < qMin(size, maxLoggedPaintNodes); ++i) {
+            const PaintNodeRecord& record = records->records[i];
+            event.time = record.time;
+            qstrncpy(event.className, record.className, UMPaintNodeEvent::maxNameSize);
+            qstrncpy(event.objectName, record.objectName.toUtf8().constData(),
+                     UMPaintNodeEvent::maxNameSize);
+            if (!applicationMonitor->logPaintNodeEvent(event)) {
+                break;
+            }
+        }
+    }
+
+    records->records.resize(0);
+    records->count = 0;
+}
+
 void UCPerformanceMonitor::windowDestroyed()
 {
     connectToWindow(NULL);
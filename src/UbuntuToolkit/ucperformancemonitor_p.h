@@ -24,11 +24,43 @@
 #include <QtCore/QObject>
 #include <QtCore/QSharedPointer>
 #include <QtQuick/QQuickWindow>
+#include <UbuntuMetrics/histogram.h>
 
 #include <UbuntuToolkit/ubuntutoolkitglobal.h>
 
 UT_NAMESPACE_BEGIN
 
+// Times the updatePaintNode() call of an item when jank attribution is enabled
+// (UC_PERFORMANCE_MONITOR_ATTRIBUTION). Calls are recorded per render thread
+// and reported by the performance monitor when a frame is too slow.
+class UBUNTUTOOLKIT_EXPORT UCPaintNodeTimer
+{
+public:
+    UCPaintNodeTimer(const QQuickItem* item)
+        : m_item(m_enabled ? item : Q_NULLPTR)
+    {
+        if (m_item) {
+            m_timer.start();
+        }
+    }
+    ~UCPaintNodeTimer()
+    {
+        if (m_item) {
+            record(m_item, m_timer.nsecsElapsed());
+        }
+    }
+
+    static bool isEnabled() { return m_enabled; }
+    static void setEnabled(bool enabled) { m_enabled = enabled; }
+
+private:
+    static void record(const QQuickItem* item, qint64 time);
+
+    static bool m_enabled;
+    const QQuickItem* m_item;
+    QElapsedTimer m_timer;
+};
+
 class UBUNTUTOOLKIT_EXPORT UCPerformanceMonitor : public QObject
 {
     Q_OBJECT
@@ -46,12 +78,16 @@ private Q_SLOTS:
 
 private:
     QQuickWindow* findQQuickWindow();
+    void checkPercentiles(quint64 frameTime);
+    void attributeFrame(qint64 frameTime);
 
 private:
     int m_framesAboveThreshold;
     int m_warningCount;
+    quint32 m_slowFrameCount;
     QElapsedTimer m_timer;
     QQuickWindow* m_window;
+    UMHistogram m_frameTimes;
 };
 
 UT_NAMESPACE_END
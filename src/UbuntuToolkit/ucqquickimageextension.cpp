@@ -18,9 +18,13 @@
 
 #include "ucqquickimageextension_p.h"
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
 #include <QtGui/QGuiApplication>
 #include <QtQuick/private/qquickitem_p.h>
 #include <QtQuick/private/qquickimagebase_p.h>
@@ -34,7 +38,11 @@
 
 UT_NAMESPACE_BEGIN
 
-QHash<QUrl, QSharedPointer<QTemporaryFile> > UCQQuickImageExtension::s_rewrittenSciFiles;
+QHash<QString, QString> UCQQuickImageExtension::s_rewrittenSciFiles;
+
+// first line of the rewritten .sci files, followed by the modification time and
+// the path of the source .sci file; the .sci parser skips lines starting with '#'
+static const char sciHeader[] = "# ubuntu-ui-toolkit rewritten sci ";
 
 /*!
     \internal
@@ -117,7 +125,7 @@ void UCQQuickImageExtension::reloadSource()
     // If the url we're trying to load is already in the cache and
     // the devicePixelRatio is 1, we save calling UCUnits::resolveResource
     // and just set that image directly.
-    // UCUnits::resolveResource is not cheap (does a stat on disk)
+    // UCUnits::resolveResource still builds strings and hashes paths on every call
     if (qFuzzyCompare(qGuiApp->devicePixelRatio(), (qreal)1.0)) {
         QSize ss = m_image->sourceSize();
         if (ss.isNull() && m_image->image().isNull()) {
@@ -169,35 +177,18 @@ void UCQQuickImageExtension::reloadSource()
           // Regular image file
             m_image->setSource(QUrl("image://scaling/" + resolved + fragment));
         } else {
-            // .sci image file. Rewrite the .sci file into a temporary file.
-            bool rewritten = true;
-            QTemporaryFile* rewrittenSciFile;
-
-            /* Ensure that only one temporary rewritten .sci file is created
-               for each source .sci file by storing the path to the temporary
-               file in a global hash.
-            */
-            rewrittenSciFile = UCQQuickImageExtension::s_rewrittenSciFiles.value(m_source).data();
-            if (rewrittenSciFile == NULL) {
-                rewrittenSciFile = new QTemporaryFile;
-                rewrittenSciFile->setFileTemplate(QDir::tempPath() + "/XXXXXX.sci");
-                rewrittenSciFile->open();
-                QTextStream output(rewrittenSciFile);
-
-                if (qFuzzyCompare(qGuiApp->devicePixelRatio(), (qreal)1.0)) {
-                    rewritten = rewriteSciFile(selectedFilePath, scaleFactor, output);
-                } else {
-                    QString scaleFactorInDevicePixels = QString::number(scaleFactor.toFloat() / qGuiApp->devicePixelRatio());
-                    rewritten = rewriteSciFile(selectedFilePath, scaleFactorInDevicePixels, output);
-                }
-                rewrittenSciFile->close();
-
-                s_rewrittenSciFiles.insert(m_source, QSharedPointer<QTemporaryFile>(rewrittenSciFile));
+            // .sci image file. Rewrite the .sci file for the scale factor.
+            QString rewrittenSciFilePath;
+            if (qFuzzyCompare(qGuiApp->devicePixelRatio(), (qreal)1.0)) {
+                rewrittenSciFilePath = rewrittenSciFile(selectedFilePath, scaleFactor);
+            } else {
+                QString scaleFactorInDevicePixels = QString::number(scaleFactor.toFloat() / qGuiApp->devicePixelRatio());
+                rewrittenSciFilePath = rewrittenSciFile(selectedFilePath, scaleFactorInDevicePixels);
             }
 
-            if (rewritten) {
+            if (!rewrittenSciFilePath.isEmpty()) {
                 // Take care to pass the original fragment
-                QUrl rewrittenSciFileUrl(QUrl::fromLocalFile(rewrittenSciFile->fileName()));
+                QUrl rewrittenSciFileUrl(QUrl::fromLocalFile(rewrittenSciFilePath));
                 rewrittenSciFileUrl.setFragment(fragment);
                 m_image->setSource(rewrittenSciFileUrl);
             } else {
@@ -210,6 +201,96 @@ void UCQQuickImageExtension::reloadSource()
     }
 }
 
+/*
+ * Rewritten .sci files are kept in the cache directory of the application, named
+ * after the source path, its modification time and the scale factor. All the
+ * images using the same .sci file at the same scale share a single rewritten
+ * file, thus a single decoded image, also across runs.
+ */
+QString UCQQuickImageExtension::rewrittenSciFile(const QString &sciFilePath, const QString &scaleFactor)
+{
+    const QString key = sciFilePath + QLatin1Char('@') + scaleFactor;
+    QHash<QString, QString>::const_iterator cached = s_rewrittenSciFiles.constFind(key);
+    if (cached != s_rewrittenSciFiles.constEnd()) {
+        return cached.value();
+    }
+
+    // clean up once per run, before the first use
+    static const QString directory = [] {
+        const QString directory = sciCacheDirectory();
+        QDir().mkpath(directory);
+        collectStaleSciFiles(directory);
+        return directory;
+    }();
+
+    // the rewritten file refers to the images next to the source, the path must not
+    // depend on the current directory
+    const QFileInfo sciFileInfo(sciFilePath);
+    const QString absolutePath = sciFileInfo.absoluteFilePath();
+    const QString modified = QString::number(sciFileInfo.lastModified().toMSecsSinceEpoch());
+    const QByteArray hash = QCryptographicHash::hash(
+        QString(absolutePath + QLatin1Char('\n') + modified + QLatin1Char('\n') + scaleFactor).toUtf8(),
+        QCryptographicHash::Sha1);
+    QString fileName = directory + QLatin1Char('/') + QString::fromLatin1(hash.toHex()) + QStringLiteral(".sci");
+
+    if (!QFile::exists(fileName)) {
+        // written atomically, other instances of the application may share the file
+        QSaveFile file(fileName);
+        bool rewritten = file.open(QIODevice::WriteOnly | QIODevice::Text);
+        if (rewritten) {
+            QTextStream output(&file);
+            output << sciHeader << modified << ' ' << absolutePath << endl;
+            rewritten = rewriteSciFile(absolutePath, scaleFactor, output);
+            output.flush();
+            rewritten = rewritten && file.commit();
+        }
+        if (!rewritten) {
+            fileName.clear();
+        }
+    }
+
+    s_rewrittenSciFiles.insert(key, fileName);
+    return fileName;
+}
+
+QString UCQQuickImageExtension::sciCacheDirectory()
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (directory.isEmpty()) {
+        directory = QDir::tempPath();
+    }
+    return directory + QStringLiteral("/sci");
+}
+
+/*
+ * Removes the rewritten .sci files which source is gone or has been modified
+ * since. Files not written by us are left untouched.
+ */
+void UCQQuickImageExtension::collectStaleSciFiles(const QString &directory)
+{
+    const QString header = QString::fromLatin1(sciHeader);
+    const QFileInfoList files = QDir(directory).entryInfoList(QStringList(QStringLiteral("*.sci")), QDir::Files);
+    Q_FOREACH(const QFileInfo &fileInfo, files) {
+        QFile file(fileInfo.filePath());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        file.close();
+        if (!line.startsWith(header.trimmed())) {
+            continue;
+        }
+
+        const QString source = line.mid(header.length());
+        const int separator = source.indexOf(QLatin1Char(' '));
+        const QFileInfo sourceInfo(source.mid(separator + 1));
+        if (separator < 0 || !sourceInfo.exists()
+                || QString::number(sourceInfo.lastModified().toMSecsSinceEpoch()) != source.left(separator)) {
+            QFile::remove(fileInfo.filePath());
+        }
+    }
+}
+
 bool UCQQuickImageExtension::rewriteSciFile(const QString &sciFilePath, const QString &scaleFactor, QTextStream& output)
 {
     QFile sciFile(sciFilePath);
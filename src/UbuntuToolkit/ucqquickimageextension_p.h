@@ -21,9 +21,8 @@
 
 #include <QtCore/QEvent>
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
-#include <QtCore/QSharedPointer>
-#include <QtCore/QTemporaryFile>
 #include <QtCore/QTextStream>
 #include <QtCore/QUrl>
 
@@ -52,14 +51,19 @@ protected Q_SLOTS:
     void onSourceSizeChanged();
 
 protected:
-    bool rewriteSciFile(const QString &sciFilePath, const QString &scaleFactor, QTextStream& output);
-    QString scaledBorder(const QString &border, const QString &scaleFactor);
-    QString scaledSource(QString source, const QString &sciFilePath, const QString &scaleFactor);
+    static bool rewriteSciFile(const QString &sciFilePath, const QString &scaleFactor, QTextStream& output);
+    static QString scaledBorder(const QString &border, const QString &scaleFactor);
+    static QString scaledSource(QString source, const QString &sciFilePath, const QString &scaleFactor);
+    // returns the path of the .sci file rewritten for the scale factor, empty on failure
+    static QString rewrittenSciFile(const QString &sciFilePath, const QString &scaleFactor);
+    static QString sciCacheDirectory();
+    static void collectStaleSciFiles(const QString &directory);
 
 private:
     QQuickImageBase* m_image;
     QUrl m_source;
-    static QHash<QUrl, QSharedPointer<QTemporaryFile> > s_rewrittenSciFiles;
+    // rewritten .sci file for each source .sci file and scale factor
+    static QHash<QString, QString> s_rewrittenSciFiles;
 };
 
 UT_NAMESPACE_END
@@ -21,6 +21,8 @@
 #include <QtCore/QFile>
 #include <QtGui/QImageReader>
 
+#include "imagecache_p.h"
+
 UT_NAMESPACE_BEGIN
 
 /*!
@@ -69,14 +71,25 @@ QImage UCScalingImageProvider::requestImage(const QString &id, QSize *size, cons
             }
         }
 
+        QSize decodeSize = realSize;
         if (!constrainedSize.isEmpty()) {
-            imageReader.setScaledSize(constrainedSize);
+            decodeSize = constrainedSize;
         } else if (scaledSize != realSize) {
-            imageReader.setScaledSize(scaledSize);
+            decodeSize = scaledSize;
+        }
+        *size = scaledSize;
+
+        // only the header has been read so far, skip decoding if the image is cached
+        image = ImageCache::instance()->image(path, decodeSize);
+        if (!image.isNull()) {
+            return image;
         }
 
+        if (decodeSize != realSize) {
+            imageReader.setScaledSize(decodeSize);
+        }
         imageReader.read(&image);
-        *size = scaledSize;
+        ImageCache::instance()->insert(path, decodeSize, image);
         return image;
     } else {
         return QImage();
@@ -18,6 +18,8 @@
 
 #include "ucstyleditembase_p_p.h"
 
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSet>
 #include <QtQml/QQmlEngine>
 #include <QtQuick/private/qquickanchors_p.h>
 
@@ -356,6 +358,9 @@ void UCStyledItemBasePrivate::preStyleChanged()
     }
 }
 
+// shared theme style components between beginCreate() and completeCreate()
+static QSet<QQmlComponent*> creatingStyleComponents;
+
 // loads the style animated or not, depending on the loading time
 // returns true on successful style loading
 bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
@@ -367,9 +372,16 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
     Q_Q(UCStyledItemBase);
     // either styleComponent or styleName is valid
     QQmlComponent *component = styleComponent;
+    QScopedPointer<QQmlComponent> ownComponent;
     UCTheme *theme = q->getTheme();
     if (!component && theme) {
-        component = theme->createStyleComponent(styleDocument + ".qml", q, styleVersion);
+        component = theme->styleComponent(styleDocument + ".qml", q, styleVersion);
+        if (component && creatingStyleComponents.contains(component)) {
+            // the shared component is not re-entrant: a style being created
+            // instantiates an item with the same style, use a private component
+            ownComponent.reset(theme->createStyleComponent(styleDocument + ".qml", q, styleVersion));
+            component = ownComponent.data();
+        }
     }
     if (!component) {
         return false;
@@ -388,8 +400,15 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
     styleItemContext->setContextObject(q);
     styleItemContext->setContextProperty(QStringLiteral("styledItem"), q);
     styleItemContext->setContextProperty(QStringLiteral("animated"), animated);
+    const bool shared = !styleComponent && !ownComponent;
+    if (shared) {
+        creatingStyleComponents.insert(component);
+    }
     QObject *object = component->beginCreate(styleItemContext);
     if (!object) {
+        if (shared) {
+            creatingStyleComponents.remove(component);
+        }
         delete styleItemContext;
         return false;
     }
@@ -408,9 +427,8 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
         delete object;
     }
     component->completeCreate();
-    // delete temporary component
-    if (!styleComponent) {
-        delete component;
+    if (shared) {
+        creatingStyleComponents.remove(component);
     }
 
     // make sure we reset the animated property to true
@@ -400,6 +400,7 @@ UCTheme::UCTheme(QObject *parent)
     , m_parentTheme(Q_NULLPTR)
     , m_palette(Q_NULLPTR)
     , m_completed(false)
+    , m_paletteColorsDirty(true)
 {
     init();
 }
@@ -471,6 +472,7 @@ void UCTheme::_q_defaultThemeChanged()
 
 void UCTheme::updateThemePaths()
 {
+    clearStyleCache();
     m_themePaths.clear();
 
     QString themeName = name();
@@ -634,7 +636,39 @@ void UCTheme::resetPalette()
     setPalette(NULL);
 }
 
+/*
+ * Returns the URL of the style document, resolving it only once per theme
+ * paths change. Misses are cached as well, as those are the most expensive
+ * lookups, touching every theme path and version.
+ */
 QUrl UCTheme::styleUrl(const QString& styleName, quint16 version, bool *isFallback)
+{
+    const StyleKey key(styleName, version);
+    QHash<StyleKey, StyleUrlRecord>::const_iterator i = m_styleUrlCache.constFind(key);
+    if (i == m_styleUrlCache.constEnd()) {
+        StyleUrlRecord record;
+        record.url = lookupStyleUrl(styleName, version, &record.fallback);
+        i = m_styleUrlCache.insert(key, record);
+    }
+    if (isFallback) {
+        (*isFallback) = i->fallback;
+    }
+    return i->url;
+}
+
+void UCTheme::clearStyleCache()
+{
+    m_styleUrlCache.clear();
+    // components may be in use by a style creation triggering the theme change
+    Q_FOREACH(const QPointer<QQmlComponent> &component, m_styleComponentCache) {
+        if (component) {
+            component->deleteLater();
+        }
+    }
+    m_styleComponentCache.clear();
+}
+
+QUrl UCTheme::lookupStyleUrl(const QString& styleName, quint16 version, bool *isFallback)
 {
     if (isFallback) {
         (*isFallback) = false;
@@ -742,6 +776,22 @@ void UCTheme::checkMixedVersionImports(QQuickItem *item, quint16 version)
     previousVersion = version;
 }
 
+// resolves the style URL and reports fallbacks and missing styles on the parent
+QUrl UCTheme::resolveStyleUrl(const QString& styleName, QObject *parent, quint16 version)
+{
+    bool fallback = false;
+    QUrl url = styleUrl(styleName, version, &fallback);
+    if (!url.isValid()) {
+        qmlInfo(parent) <<
+           QStringLiteral("Warning: Style %1 not found in theme %2").arg(styleName).arg(name());
+    } else if (fallback) {
+        qmlInfo(parent) << QStringLiteral("Theme '%1' has no '%2' style for version %3.%4, fall back to version %5.%6.")
+                           .arg(name()).arg(styleName).arg(MAJOR_VERSION(version)).arg(MINOR_VERSION(version))
+                           .arg(MAJOR_VERSION(LATEST_UITK_VERSION)).arg(MINOR_VERSION(LATEST_UITK_VERSION));
+    }
+    return url;
+}
+
 /*
  * Returns an instance of the style component named \a styleName and parented
  * to \a parent.
@@ -759,14 +809,8 @@ QQmlComponent* UCTheme::createStyleComponent(const QString& styleName, QObject*
             return Q_NULLPTR;
         }
         // make sure we have the paths
-        bool fallback = false;
-        QUrl url = styleUrl(styleName, version, &fallback);
+        QUrl url = resolveStyleUrl(styleName, parent, version);
         if (url.isValid()) {
-            if (fallback) {
-                qmlInfo(parent) << QStringLiteral("Theme '%1' has no '%2' style for version %3.%4, fall back to version %5.%6.")
-                                   .arg(name()).arg(styleName).arg(MAJOR_VERSION(version)).arg(MINOR_VERSION(version))
-                                   .arg(MAJOR_VERSION(LATEST_UITK_VERSION)).arg(MINOR_VERSION(LATEST_UITK_VERSION));
-            }
             component = new QQmlComponent(engine, url, QQmlComponent::PreferSynchronous, parent);
             if (component->isError()) {
                 qmlInfo(parent) << component->errorString();
@@ -776,15 +820,51 @@ QQmlComponent* UCTheme::createStyleComponent(const QString& styleName, QObject*
                 // set context for the component
                 QQmlEngine::setContextForObject(component, qmlContext(parent));
             }
-        } else {
-            qmlInfo(parent) <<
-               QStringLiteral("Warning: Style %1 not found in theme %2").arg(styleName).arg(name());
         }
     }
 
     return component;
 }
 
+/*
+ * Returns the style component named \a styleName for the engine of \a parent.
+ * The component is compiled once and shared by all the styled items using the
+ * same style of the theme; it has no context of its own, so the items create
+ * their style instances in their own context.
+ */
+QQmlComponent* UCTheme::styleComponent(const QString& styleName, QObject* parent, quint16 version)
+{
+    Q_ASSERT(version);
+    QQmlEngine* engine = qmlEngine(parent);
+    if (!engine) {
+        // we may be in the phase when the qml context is not yet defined for the parent
+        return Q_NULLPTR;
+    }
+
+    const StyleKey key(styleName, version);
+    QPointer<QQmlComponent> component = m_styleComponentCache.value(key);
+    if (component && component->engine() == engine) {
+        return component;
+    }
+    if (component) {
+        component->deleteLater();
+    }
+    m_styleComponentCache.remove(key);
+
+    QUrl url = resolveStyleUrl(styleName, parent, version);
+    if (!url.isValid()) {
+        return Q_NULLPTR;
+    }
+    QQmlComponent *newComponent = new QQmlComponent(engine, url, QQmlComponent::PreferSynchronous, this);
+    if (newComponent->isError()) {
+        qmlInfo(parent) << newComponent->errorString();
+        delete newComponent;
+        return Q_NULLPTR;
+    }
+    m_styleComponentCache.insert(key, newComponent);
+    return newComponent;
+}
+
 void UCTheme::loadPalette(QQmlEngine *engine, bool notify)
 {
     if (!engine) {
@@ -827,4 +907,95 @@ QColor UCTheme::getPaletteColor(const char *profile, const char *color)
     return result;
 }
 
+/*
+ * Returns the \a role color of the \a profile value set of the palette. Unlike
+ * getPaletteColor() this does not look up the properties by name, but reads the
+ * colors from a table built on the first use after the palette or one of its
+ * values changes. Returns an invalid color if the palette has no such value.
+ */
+QColor UCTheme::paletteColor(PaletteProfile profile, PaletteRole role)
+{
+    Q_ASSERT(profile >= 0 && profile < PaletteProfileCount);
+    Q_ASSERT(role >= 0 && role < PaletteRoleCount);
+    if (m_paletteColorsDirty || !m_palette || m_palette != m_paletteColorsSource) {
+        buildPaletteColors();
+    }
+    return m_paletteColors[profile][role];
+}
+
+void UCTheme::_q_paletteColorsChanged()
+{
+    m_paletteColorsDirty = true;
+}
+
+void UCTheme::buildPaletteColors()
+{
+    // in the same order as the PaletteProfile and PaletteRole enums
+    static const char *profileNames[PaletteProfileCount] = {
+        "normal", "disabled", "focused", "selected", "selectedDisabled", "highlighted"
+    };
+    static const char *roleNames[PaletteRoleCount] = {
+        "background", "backgroundText", "backgroundSecondaryText", "backgroundTertiaryText",
+        "base", "baseText", "foreground", "foregroundText",
+        "raised", "raisedText", "raisedSecondaryText",
+        "overlay", "overlayText", "overlaySecondaryText",
+        "field", "fieldText", "positive", "positiveText", "negative", "negativeText",
+        "activity", "activityText", "selection", "selectionText",
+        "focus", "focusText", "position", "positionText"
+    };
+    static const QMetaMethod invalidate = staticMetaObject.method(
+        staticMetaObject.indexOfSlot("_q_paletteColorsChanged()"));
+
+    Q_FOREACH(const QPointer<QObject> &object, m_paletteColorsWatched) {
+        if (object) {
+            disconnect(object, QMetaMethod(), this, invalidate);
+        }
+    }
+    m_paletteColorsWatched.clear();
+    for (int p = 0; p < PaletteProfileCount; p++) {
+        for (int r = 0; r < PaletteRoleCount; r++) {
+            m_paletteColors[p][r] = QColor();
+        }
+    }
+
+    QObject *themePalette = palette();
+    m_paletteColorsSource = themePalette;
+    m_paletteColorsDirty = false;
+    if (!themePalette) {
+        return;
+    }
+
+    // get notified when the value sets get replaced, values change or the palette is gone
+    const QMetaObject *paletteMo = themePalette->metaObject();
+    m_paletteColorsWatched.append(themePalette);
+    connect(themePalette, QMetaMethod::fromSignal(&QObject::destroyed), this, invalidate);
+    for (int p = 0; p < PaletteProfileCount; p++) {
+        int profileIndex = paletteMo->indexOfProperty(profileNames[p]);
+        if (profileIndex < 0) {
+            continue;
+        }
+        const QMetaProperty profileProperty = paletteMo->property(profileIndex);
+        if (profileProperty.hasNotifySignal()) {
+            connect(themePalette, profileProperty.notifySignal(), this, invalidate);
+        }
+        QObject *values = profileProperty.read(themePalette).value<QObject*>();
+        if (!values) {
+            continue;
+        }
+        m_paletteColorsWatched.append(values);
+        const QMetaObject *valuesMo = values->metaObject();
+        for (int r = 0; r < PaletteRoleCount; r++) {
+            int roleIndex = valuesMo->indexOfProperty(roleNames[r]);
+            if (roleIndex < 0) {
+                continue;
+            }
+            const QMetaProperty roleProperty = valuesMo->property(roleIndex);
+            m_paletteColors[p][r] = roleProperty.read(values).value<QColor>();
+            if (roleProperty.hasNotifySignal()) {
+                connect(values, roleProperty.notifySignal(), this, invalidate);
+            }
+        }
+    }
+}
+
 UT_NAMESPACE_END
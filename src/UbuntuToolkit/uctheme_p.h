@@ -20,7 +20,9 @@
 #ifndef UCTHEME_P_H
 #define UCTHEME_P_H
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QPair>
 #include <QtCore/QPointer>
 #include <QtCore/QString>
 #include <QtCore/QUrl>
@@ -71,6 +73,48 @@ public:
         bool deprecated:1;
     };
 
+    // palette value sets and colors addressable by C++ components, see paletteColor()
+    enum PaletteProfile {
+        Normal,
+        Disabled,
+        Focused,
+        Selected,
+        SelectedDisabled,
+        Highlighted,
+        PaletteProfileCount
+    };
+    enum PaletteRole {
+        Background,
+        BackgroundText,
+        BackgroundSecondaryText,
+        BackgroundTertiaryText,
+        Base,
+        BaseText,
+        Foreground,
+        ForegroundText,
+        Raised,
+        RaisedText,
+        RaisedSecondaryText,
+        Overlay,
+        OverlayText,
+        OverlaySecondaryText,
+        Field,
+        FieldText,
+        Positive,
+        PositiveText,
+        Negative,
+        NegativeText,
+        Activity,
+        ActivityText,
+        Selection,
+        SelectionText,
+        Focus,
+        FocusText,
+        Position,
+        PositionText,
+        PaletteRoleCount
+    };
+
     explicit UCTheme(QObject *parent = 0);
     static UCTheme *defaultTheme(QQmlEngine *engine);
 
@@ -86,10 +130,13 @@ public:
 
     // internal, used by the deprecated Theme.createStyledComponent()
     QQmlComponent* createStyleComponent(const QString& styleName, QObject* parent, quint16 version = 0);
+    // returns a cached component owned by the theme, must not be deleted by the caller
+    QQmlComponent* styleComponent(const QString& styleName, QObject* parent, quint16 version);
     void attachItem(QQuickItem *item, bool attach);
 
     // helper functions
     QColor getPaletteColor(const char *profile, const char *color);
+    QColor paletteColor(PaletteProfile profile, PaletteRole role);
 
 Q_SIGNALS:
     void parentThemeChanged();
@@ -107,6 +154,7 @@ protected:
 private Q_SLOTS:
     void resetPalette();
     void _q_defaultThemeChanged();
+    void _q_paletteColorsChanged();
 
 private:
     static void createDefaultTheme(QQmlEngine* engine);
@@ -115,8 +163,12 @@ private:
     void updateEnginePaths(QQmlEngine *engine);
     void updateThemePaths();
     QUrl styleUrl(const QString& styleName, quint16 version, bool *isFallback = NULL);
+    QUrl lookupStyleUrl(const QString& styleName, quint16 version, bool *isFallback);
+    QUrl resolveStyleUrl(const QString& styleName, QObject *parent, quint16 version);
+    void clearStyleCache();
     void loadPalette(QQmlEngine *engine, bool notify = true);
     void updateThemedItems();
+    void buildPaletteColors();
 
     class PaletteConfig
     {
@@ -167,14 +219,28 @@ private:
         QList<Data> configList;
     };
 
+    struct StyleUrlRecord {
+        QUrl url;
+        bool fallback;
+    };
+    typedef QPair<QString, quint16> StyleKey;
+
     PaletteConfig m_config;
     QString m_name;
     QPointer<UCTheme> m_parentTheme;
     QPointer<QObject> m_palette; // the palette might be from the default style if the theme doesn't define palette
     QList<ThemeRecord> m_themePaths;
+    // style lookups resolved against m_themePaths, cleared whenever those change
+    QHash<StyleKey, StyleUrlRecord> m_styleUrlCache;
+    QHash<StyleKey, QPointer<QQmlComponent> > m_styleComponentCache;
     UCDefaultTheme m_defaultTheme;
     QPODVector<QQuickItem*, 4> m_attachedItems;
+    // flat copy of the palette colors, rebuilt when the palette or any of its values change
+    QColor m_paletteColors[PaletteProfileCount][PaletteRoleCount];
+    QPointer<QObject> m_paletteColorsSource;
+    QList<QPointer<QObject> > m_paletteColorsWatched;
     bool m_completed:1;
+    bool m_paletteColorsDirty:1;
 
     friend class UCDeprecatedTheme;
 };
@@ -29,6 +29,9 @@
 
 #include <math.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
 #include <QtCore/QPointer>
 #include <QtGui/QGuiApplication>
 #include <QtQml/QQmlInfo>
@@ -40,6 +43,7 @@
 
 #include "quickutils_p.h"
 #include "ubuntutoolkitglobal.h"
+#include "ucperformancemonitor_p.h"
 #include "ucunits_p.h"
 
 UT_NAMESPACE_BEGIN
@@ -54,9 +58,106 @@ const float radiusSizeOffset = 2.0f;
 // Factor by which the final fragment RGB color must be multiplied for the pressed aspect.
 const float pressedFactor = 0.85f;
 
+// --- Shape textures ---
+
+// Create and setup shape textures.
+static void createShapeTextures(bool useDistanceFields, quint32* ids)
+{
+    glGenTextures(shapeTextureCount, ids);
+
+    if (useDistanceFields) {
+        // Create distance field textures.
+        for (int i = 0; i < shapeTextureCount; i++) {
+            glBindTexture(GL_TEXTURE_2D, ids[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, shapeTextureWidth, shapeTextureHeight, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, shapeTextureData[i]);
+        }
+    } else {
+        // Create mipmap textures.
+        for (int i = 0; i < shapeTextureCount; i++) {
+            glBindTexture(GL_TEXTURE_2D, ids[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            for (int j = 0; j < shapeTextureMipmapCount; j++) {
+                glTexImage2D(GL_TEXTURE_2D, j, GL_RGBA, shapeTextureMipmapWidth >> j,
+                             shapeTextureMipmapHeight >> j, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                             &shapeTextureMipmapData[i][shapeTextureMipmapOffset[j]]);
+            }
+        }
+    }
+}
+
+// Registry of the shape textures, shared by all the contexts of a share group. Only the set
+// (distance fields or mipmaps) used by a context is uploaded, the first time a shape shader is
+// initialized for it, the static texture data of the other set is never paged in. The textures
+// are referenced by the shaders, not by the materials, so that creating materials doesn't
+// require any locking.
+class ShapeTextures {
+public:
+    ShapeTextures() : m_refCount(0) {}
+    quint32* ids() { return m_ids; }
+    quint32 ref() { Q_ASSERT(m_refCount < UINT_MAX); return ++m_refCount; }
+    quint32 unref() { Q_ASSERT(m_refCount > 0); return --m_refCount; }
+
+    static const quint32* acquire(QOpenGLContextGroup* shareGroup, bool useDistanceFields);
+    static void release(QOpenGLContextGroup* shareGroup, bool useDistanceFields);
+
+private:
+    typedef QPair<QOpenGLContextGroup*, bool> Key;
+    static QHash<Key, ShapeTextures*> m_registry;
+    static QMutex m_registryMutex;
+
+    quint32 m_refCount;
+    quint32 m_ids[shapeTextureCount];
+};
+
+QHash<ShapeTextures::Key, ShapeTextures*> ShapeTextures::m_registry;
+QMutex ShapeTextures::m_registryMutex;
+
+// static
+const quint32* ShapeTextures::acquire(QOpenGLContextGroup* shareGroup, bool useDistanceFields)
+{
+    QMutexLocker locker(&m_registryMutex);
+    ShapeTextures*& textures = m_registry[Key(shareGroup, useDistanceFields)];
+    if (!textures) {
+        textures = new ShapeTextures;
+        createShapeTextures(useDistanceFields, textures->ids());
+    }
+    textures->ref();
+    // The textures are heap allocated so that the ids stay valid across registry rehashes.
+    return textures->ids();
+}
+
+// static
+void ShapeTextures::release(QOpenGLContextGroup* shareGroup, bool useDistanceFields)
+{
+    QMutexLocker locker(&m_registryMutex);
+    auto it = m_registry.find(Key(shareGroup, useDistanceFields));
+    Q_ASSERT(it != m_registry.end());
+    if (it.value()->unref() == 0) {
+        // Textures are destroyed along with the share group when no context of the group is
+        // current anymore.
+        QOpenGLContext* context = QOpenGLContext::currentContext();
+        if (context && context->shareGroup() == shareGroup) {
+            glDeleteTextures(shapeTextureCount, it.value()->ids());
+        }
+        delete it.value();
+        m_registry.erase(it);
+    }
+}
+
 // --- Scene graph shader ---
 
 ShapeShader::ShapeShader() :
+    m_functions(NULL),
+    m_shareGroup(NULL),
+    m_shapeTextureIds(NULL),
     m_useDistanceFields(UCUbuntuShape::useDistanceFields(QOpenGLContext::currentContext()))
 {
     setShaderSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/uc/shaders/shape.vert"));
@@ -69,7 +170,7 @@ char const* const* ShapeShader::attributeNames() const
 {
     static char const* const attributes[] = {
         "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "yCoordAttrib",
-        "backgroundColorAttrib", 0
+        "backgroundColorAttrib", "shapeParamsAttrib", 0
     };
     return attributes;
 }
@@ -82,13 +183,31 @@ void ShapeShader::initialize()
     program()->setUniformValue("shapeTexture", 0);
     program()->setUniformValue("sourceTexture", 1);
 
-    m_functions = QOpenGLContext::currentContext()->functions();
+    // Shaders are created once per context, that's where the shape textures are acquired.
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    m_functions = context->functions();
+    m_shareGroup = context->shareGroup();
+    m_shapeTextureIds = ShapeTextures::acquire(m_shareGroup, m_useDistanceFields);
     m_matrixId = program()->uniformLocation("matrix");
     m_opacityFactorsId = program()->uniformLocation("opacityFactors");
-    m_sourceOpacityId = program()->uniformLocation("sourceOpacity");
-    m_distanceAAId = program()->uniformLocation("distanceAA");
     m_texturedId = program()->uniformLocation("textured");
     m_aspectId = program()->uniformLocation("aspect");
+
+    if (useDistanceFields()) {
+        // Anti-aliasing distance in distance field space, needs to be divided by 2 for the shader.
+        // It's scaled in the vertex shader by the per-shape distance AA factor, which is 1 most of
+        // the time apart when the radius size is low, it linearly goes from 1 to 0 to make the
+        // corners prettier and to prevent the opacity of the whole shape to slightly lower.
+        const float distanceAA = (shapeTextureDistanceAA * distanceAApx) / 2.0f;
+        program()->setUniformValue("distanceAAScale", distanceAA);
+    }
+}
+
+ShapeShader::~ShapeShader()
+{
+    if (m_shapeTextureIds) {
+        ShapeTextures::release(m_shareGroup, m_useDistanceFields);
+    }
 }
 
 void ShapeShader::updateState(
@@ -100,7 +219,7 @@ void ShapeShader::updateState(
     const ShapeMaterial::Data* data = material->constData();
 
     // Bind shape texture.
-    glBindTexture(GL_TEXTURE_2D, material->textureIds()[data->shapeTextureIndex]);
+    glBindTexture(GL_TEXTURE_2D, m_shapeTextureIds[data->shapeTextureIndex]);
 
     // Bind source texture on the 2nd texture unit and update uniforms.
     bool textured = false;
@@ -124,7 +243,6 @@ void ShapeShader::updateState(
             m_functions->glActiveTexture(GL_TEXTURE1);
             sourceTexture->bind();
             m_functions->glActiveTexture(GL_TEXTURE0);
-            program()->setUniformValue(m_sourceOpacityId, data->sourceOpacity / 255.0f);
             textured = true;
         }
     }
@@ -141,15 +259,6 @@ void ShapeShader::updateState(
         data->flags & ShapeMaterial::Data::Pressed ? pressedFactor * opacity : opacity, opacity);
     program()->setUniformValue(m_opacityFactorsId, opacityFactorsVector);
 
-    if (useDistanceFields()) {
-        // Send anti-aliasing distance in distance field space, needs to be divided by 2 for the
-        // shader and by 255 for distanceAAFactor dequantization. The factor is 1 most of the time
-        // apart when the radius size is low, it linearly goes from 1 to 0 to make the corners
-        // prettier and to prevent the opacity of the whole shape to slightly lower.
-        const float distanceAA = (shapeTextureDistanceAA * distanceAApx) / (2.0 * 255.0f);
-        program()->setUniformValue(m_distanceAAId, data->distanceAAFactor * distanceAA);
-    }
-
     // Update QtQuick engine uniforms.
     if (state.isMatrixDirty()) {
         program()->setUniformValue(m_matrixId, state.combinedMatrix());
@@ -158,82 +267,12 @@ void ShapeShader::updateState(
 
 // --- Scene graph material ---
 
-// Create and setup shape textures.
-static void createShapeTextures(QOpenGLContext* openglContext, quint32* ids)
-{
-    glGenTextures(shapeTextureCount, ids);
-
-    if (UCUbuntuShape::useDistanceFields(openglContext)) {
-        // Create distance field textures.
-        for (int i = 0; i < shapeTextureCount; i++) {
-            glBindTexture(GL_TEXTURE_2D, ids[i]);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, shapeTextureWidth, shapeTextureHeight, 0,
-                         GL_RGBA, GL_UNSIGNED_BYTE, shapeTextureData[i]);
-        }
-    } else {
-        // Create mipmap textures.
-        for (int i = 0; i < shapeTextureCount; i++) {
-            glBindTexture(GL_TEXTURE_2D, ids[i]);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            for (int j = 0; j < shapeTextureMipmapCount; j++) {
-                glTexImage2D(GL_TEXTURE_2D, j, GL_RGBA, shapeTextureMipmapWidth >> j,
-                             shapeTextureMipmapHeight >> j, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                             &shapeTextureMipmapData[i][shapeTextureMipmapOffset[j]]);
-            }
-        }
-    }
-}
-
-class ShapeTextures {
-public:
-    ShapeTextures() : m_refCount(0) {}
-    quint32* ids() { return m_ids; }
-    quint32 ref() { Q_ASSERT(m_refCount < UINT_MAX); return ++m_refCount; }
-    quint32 unref() { Q_ASSERT(m_refCount > 0); return --m_refCount; }
-private:
-    quint32 m_refCount;
-    quint32 m_ids[shapeTextureCount];
-};
-
-static QHash<QOpenGLContext*, ShapeTextures> shapeTexturesHash;
-static QMutex shapeTexturesHashMutex;
-
 ShapeMaterial::ShapeMaterial()
 {
     // The whole struct (with the padding bytes) must be initialized for memcmp() to work as
     // expected in ShapeMaterial::compare().
     memset(&m_data, 0x00, sizeof(Data));
     setFlag(Blending);
-
-    // Get or create the set of textures associated with the current context. We assume that QtQuick
-    // associates the same graphics context to a material for its entire lifetime.
-    QOpenGLContext* context = QOpenGLContext::currentContext();
-    shapeTexturesHashMutex.lock();
-    ShapeTextures& textures = shapeTexturesHash[context];
-    if (textures.ref() == 1) {
-        createShapeTextures(context, textures.ids());
-    }
-    memcpy(m_shapeTexturesId, textures.ids(), shapeTextureCount * sizeof(quint32));
-    shapeTexturesHashMutex.unlock();
-}
-
-ShapeMaterial::~ShapeMaterial()
-{
-    shapeTexturesHashMutex.lock();
-    auto it = shapeTexturesHash.find(QOpenGLContext::currentContext());
-    Q_ASSERT(it != shapeTexturesHash.end());
-    if (it.value().unref() == 0) {
-        glDeleteTextures(shapeTextureCount, it.value().ids());
-        shapeTexturesHash.erase(it);
-    }
-    shapeTexturesHashMutex.unlock();
 }
 
 QSGMaterialType* ShapeMaterial::type() const
@@ -247,14 +286,27 @@ QSGMaterialShader* ShapeMaterial::createShader() const
     return new ShapeShader;
 }
 
+static int textureId(QSGTextureProvider* provider)
+{
+    QSGTexture* texture = provider ? provider->texture() : NULL;
+    return texture ? texture->textureId() : 0;
+}
+
 int ShapeMaterial::compare(const QSGMaterial* other) const
 {
     // Repeat wrap modes require textures to be extracted from their atlases. Since we just store
     // the texture provider in the material data (not the texture as we want to do the extraction at
     // QSGShader::updateState() time), we make the comparison fail when repeat wrapping is set.
     const ShapeMaterial::Data* otherData = static_cast<const ShapeMaterial*>(other)->constData();
-    return memcmp(&m_data, otherData, sizeof(m_data))
-        | (m_data.flags & ShapeMaterial::Data::Repeated);
+    const int difference = (m_data.shapeTextureIndex - otherData->shapeTextureIndex)
+        | (m_data.flags - otherData->flags) | (m_data.flags & ShapeMaterial::Data::Repeated);
+    if (difference || !(m_data.flags & ShapeMaterial::Data::Textured)) {
+        return difference;
+    }
+
+    // Compare textures rather than providers so that shapes sourcing images packed in the same
+    // atlas are merged in the same batch by the renderer.
+    return textureId(m_data.sourceTextureProvider) - textureId(otherData->sourceTextureProvider);
 }
 
 void ShapeMaterial::updateTextures()
@@ -310,10 +362,11 @@ const QSGGeometry::AttributeSet& ShapeNode::attributeSet()
         QSGGeometry::Attribute::create(1, 2, GL_FLOAT),
         QSGGeometry::Attribute::create(2, 4, GL_FLOAT),
         QSGGeometry::Attribute::create(3, 1, GL_FLOAT),
-        QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE)
+        QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE),
+        QSGGeometry::Attribute::create(5, 2, GL_UNSIGNED_BYTE)
     };
     static const QSGGeometry::AttributeSet attributeSet = {
-        5, sizeof(Vertex), attributes
+        6, sizeof(Vertex), attributes
     };
     return attributeSet;
 }
@@ -1183,6 +1236,7 @@ static quint32 averageColor(QRgb c1, QRgb c2)
 QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data)
 {
     Q_UNUSED(data);
+    UCPaintNodeTimer paintNodeTimer(this);
 
     const QSizeF itemSize(width(), height());
     if (itemSize.isEmpty()) {
@@ -1251,7 +1305,15 @@ QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* d
                      / qGuiApp->devicePixelRatio();
     }
 
-    updateMaterial(node, radius, m_aspect != DropShadow ? 0 : 1, sourceTexture && m_sourceOpacity);
+    const bool textured = sourceTexture && m_sourceOpacity;
+    updateMaterial(node, radius, m_aspect != DropShadow ? 0 : 1, textured);
+
+    // Mapping of radius size range from [0, 4] to [0, 1] with clamping, plus quantization.
+    const float physicalRadius = radius * qGuiApp->devicePixelRatio();
+    const float start = 0.0f + radiusSizeOffset;
+    const float end = 4.0f + radiusSizeOffset;
+    const quint8 distanceAAFactor =
+        qMin((physicalRadius / (end - start)) - (start / (end - start)), 1.0f) * 255.0f;
 
     // Get the affine transformation for the source texture coordinates.
     const QVector4D sourceCoordTransform(
@@ -1296,7 +1358,7 @@ QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* d
 
     updateGeometry(
         node, itemSize, radius, shapeTextureOffset, sourceCoordTransform, sourceMaskTransform,
-        backgroundColor);
+        backgroundColor, distanceAAFactor, textured ? m_sourceOpacity : 0);
 
     return node;
 }
@@ -1315,7 +1377,6 @@ void UCUbuntuShape::updateMaterial(
     materialData->shapeTextureIndex = shapeTextureIndex;
     if (textured) {
         materialData->sourceTextureProvider = m_sourceTextureProvider;
-        materialData->sourceOpacity = m_sourceOpacity;
         if (m_sourceHorizontalWrapMode == Repeat) {
             flags |= ShapeMaterial::Data::HorizontallyRepeated;
         }
@@ -1325,18 +1386,10 @@ void UCUbuntuShape::updateMaterial(
         flags |= ShapeMaterial::Data::Textured;
     } else {
         materialData->sourceTextureProvider = NULL;
-        materialData->sourceOpacity = 0;
     }
 
     const float physicalRadius = radius * qGuiApp->devicePixelRatio();
 
-    // Mapping of radius size range from [0, 4] to [0, 1] with clamping, plus quantization.
-    const float start = 0.0f + radiusSizeOffset;
-    const float end = 4.0f + radiusSizeOffset;
-
-    materialData->distanceAAFactor =
-        qMin((physicalRadius / (end - start)) - (start / (end - start)), 1.0f) * 255.0f;
-
     // When the radius is equal to radiusSizeOffset (which means radius size is 0), no aspect is
     // flagged so that a dedicated (statically flow controlled) shaved off shader can be used for
     // optimal performance.
@@ -1357,14 +1410,14 @@ void UCUbuntuShape::updateMaterial(
 void UCUbuntuShape::updateGeometry(
     QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
     const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-    const quint32 backgroundColor[3])
+    const quint32 backgroundColor[3], quint8 distanceAAFactor, quint8 sourceOpacity)
 {
     // Used by subclasses, using the shapeTextureOffset constant directly allows slightly
     // better optimization here.
     Q_UNUSED(shapeOffset);
 
-    ShapeNode::Vertex* v = reinterpret_cast<ShapeNode::Vertex*>(
-        static_cast<ShapeNode*>(node)->geometry()->vertexData());
+    QSGGeometry* geometry = static_cast<ShapeNode*>(node)->geometry();
+    ShapeNode::Vertex* v = reinterpret_cast<ShapeNode::Vertex*>(geometry->vertexData());
 
     // Set top row of 3 vertices.
     v[0].position[0] = 0.0f;
@@ -1462,6 +1515,12 @@ void UCUbuntuShape::updateGeometry(
     v[8].yCoordinate = 1.0f;
     v[8].backgroundColor = backgroundColor[2];
 
+    for (int i = 0; i < ShapeNode::vertexCount; i++) {
+        v[i].distanceAAFactor = distanceAAFactor;
+        v[i].sourceOpacity = sourceOpacity;
+    }
+
+    geometry->markVertexDataDirty();
     node->markDirty(QSGNode::DirtyGeometry);
 }
 
@@ -35,6 +35,7 @@ class ShapeShader : public QSGMaterialShader
 {
 public:
     ShapeShader();
+    ~ShapeShader();
     char const* const* attributeNames() const override;
     void initialize() override;
     void updateState(
@@ -43,11 +44,11 @@ public:
 
 private:
     QOpenGLFunctions* m_functions;
+    QOpenGLContextGroup* m_shareGroup;
+    const quint32* m_shapeTextureIds;
     bool m_useDistanceFields;
     int m_matrixId;
     int m_opacityFactorsId;
-    int m_sourceOpacityId;
-    int m_distanceAAId;
     int m_texturedId;
     int m_aspectId;
 };
@@ -69,26 +70,23 @@ public:
             AspectMask           = (Flat | Inset | DropShadow),
             Pressed              = (1 << 6)
         };
+        // The distance AA factor and the source opacity are stored in the vertices so that shapes
+        // with different radii and source opacities can be batched.
         QSGTextureProvider* sourceTextureProvider;
         quint8 shapeTextureIndex;
-        quint8 distanceAAFactor;
-        quint8 sourceOpacity;
         quint8 flags;
     };
 
     ShapeMaterial();
-    ~ShapeMaterial();
     QSGMaterialType* type() const override;
     QSGMaterialShader* createShader() const override;
     int compare(const QSGMaterial* other) const override;
     virtual void updateTextures();
     const Data* constData() const { return &m_data; }
     Data* data() { return &m_data; }
-    quint32* textureIds() { return m_shapeTexturesId; }
 
 private:
     Data m_data;
-    quint32 m_shapeTexturesId[shapeTextureCount];
 };
 
 // --- Scene graph node ---
@@ -102,6 +100,9 @@ public:
         float sourceCoordinate[4];
         float yCoordinate;
         quint32 backgroundColor;
+        quint8 distanceAAFactor;
+        quint8 sourceOpacity;
+        quint8 __padding[2];
     };
 
     static const int indexCount = 14;
@@ -109,7 +110,8 @@ public:
     static const int indexTypeSize = sizeof(unsigned short);
     static const int vertexCount = 9;
     static const QSGGeometry::DataPattern indexDataPattern = QSGGeometry::StaticPattern;
-    static const QSGGeometry::DataPattern vertexDataPattern = QSGGeometry::AlwaysUploadPattern;
+    // Vertices are only uploaded when marked dirty, once per update of the item.
+    static const QSGGeometry::DataPattern vertexDataPattern = QSGGeometry::StaticPattern;
     static const GLenum drawingMode = GL_TRIANGLE_STRIP;
     static const unsigned short* indices();
     static const QSGGeometry::AttributeSet& attributeSet();
@@ -307,7 +309,7 @@ protected:
     virtual void updateGeometry(
         QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
         const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-        const quint32 backgroundColor[3]);
+        const quint32 backgroundColor[3], quint8 distanceAAFactor, quint8 sourceOpacity);
 
 private Q_SLOTS:
     void _q_imagePropertiesChanged();
@@ -38,7 +38,7 @@ char const* const* ShapeOverlayShader::attributeNames() const
 {
     static char const* const attributes[] = {
         "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "yCoordAttrib",
-        "backgroundColorAttrib", "overlayCoordAttrib", "overlayColorAttrib", 0
+        "backgroundColorAttrib", "overlayCoordAttrib", "overlayColorAttrib", "shapeParamsAttrib", 0
     };
     return attributes;
 }
@@ -87,10 +87,11 @@ const QSGGeometry::AttributeSet& ShapeOverlayNode::attributeSet()
         QSGGeometry::Attribute::create(3, 1, GL_FLOAT),
         QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE),
         QSGGeometry::Attribute::create(5, 2, GL_FLOAT),
-        QSGGeometry::Attribute::create(6, 4, GL_UNSIGNED_BYTE)
+        QSGGeometry::Attribute::create(6, 4, GL_UNSIGNED_BYTE),
+        QSGGeometry::Attribute::create(7, 2, GL_UNSIGNED_BYTE)
     };
     static const QSGGeometry::AttributeSet attributeSet = {
-        7, sizeof(Vertex), attributes
+        8, sizeof(Vertex), attributes
     };
     return attributeSet;
 }
@@ -225,10 +226,11 @@ static quint32 packColor(QRgb color)
 void UCUbuntuShapeOverlay::updateGeometry(
     QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
     const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-    const quint32 backgroundColor[3])
+    const quint32 backgroundColor[3], quint8 distanceAAFactor, quint8 sourceOpacity)
 {
+    QSGGeometry* geometry = static_cast<ShapeOverlayNode*>(node)->geometry();
     ShapeOverlayNode::Vertex* v = reinterpret_cast<ShapeOverlayNode::Vertex*>(
-        static_cast<ShapeOverlayNode*>(node)->geometry()->vertexData());
+        geometry->vertexData());
 
     // Get the affine transformation for the overlay coordinates, pixels lying inside the mask
     // (values in the range [-1, 1]) will be considered overlaid in the fragment shader.
@@ -368,6 +370,12 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[8].overlayCoordinate[1] = overlaySy + overlayTy;
     v[8].overlayColor = overlayColor;
 
+    for (int i = 0; i < ShapeNode::vertexCount; i++) {
+        v[i].distanceAAFactor = distanceAAFactor;
+        v[i].sourceOpacity = sourceOpacity;
+    }
+
+    geometry->markVertexDataDirty();
     node->markDirty(QSGNode::DirtyGeometry);
 }
 
@@ -54,6 +54,9 @@ public:
         quint32 backgroundColor;
         float overlayCoordinate[2];
         quint32 overlayColor;
+        quint8 distanceAAFactor;
+        quint8 sourceOpacity;
+        quint8 __padding[2];
     };
 
     static const QSGGeometry::AttributeSet& attributeSet();
@@ -98,7 +101,7 @@ protected:
     void updateGeometry(
         QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
         const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-        const quint32 backgroundColor[3]) override;
+        const quint32 backgroundColor[3], quint8 distanceAAFactor, quint8 sourceOpacity) override;
 
 private:
     quint16 m_overlayX;
@@ -18,9 +18,9 @@
 
 #include "ucunits_p.h"
 
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
-#include <QtCore/QRegularExpression>
 #include <QtCore/QtMath>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QScreen>
@@ -207,7 +207,7 @@ QString UCUnits::resolveResource(const QUrl& url)
         return QString();
     }
 
-    QString path = QQmlFile::urlToLocalFileOrQrc(url);
+    const QString path = QQmlFile::urlToLocalFileOrQrc(url);
 
     if (path.isEmpty()) {
         return QString();
@@ -222,20 +222,21 @@ QString UCUnits::resolveResource(const QUrl& url)
         }
     }
 
-    const QString prefix = fileInfo.dir().absolutePath() + "/" + fileInfo.baseName();
+    const QString dirPath = fileInfo.dir().absolutePath();
+    const QString baseName = fileInfo.baseName();
     const QString suffix = "." + fileInfo.completeSuffix();
+    const QString prefix = dirPath + "/" + baseName;
 
     /* Use file with expected grid unit suffix if it exists.
        For example, if m_gridUnit = 10, look for resource@10.png.
     */
-
-    path = prefix + suffixForGridUnit(m_gridUnit) + suffix;
-    if (QFile::exists(path)) {
-        return QStringLiteral("1/") + path;
+    const QString exactPath = prefix + suffixForGridUnit(m_gridUnit) + suffix;
+    if (QFile::exists(exactPath)) {
+        return QStringLiteral("1/") + exactPath;
     }
 
     /* No file with expected grid unit suffix exists.
-       List all the files of the form fileBaseName@[0-9]*.fileSuffix and select
+       Take all the files of the form fileBaseName@[0-9]*.fileSuffix and select
        the most appropriate one privileging downscaling high resolution assets
        over upscaling low resolution assets.
 
@@ -250,29 +251,60 @@ QString UCUnits::resolveResource(const QUrl& url)
        file would be resource@14.png since it is above 10 and smaller
        than resource@18.png.
     */
-    QStringList nameFilters;
-    nameFilters << fileInfo.baseName() + "@[0-9]*" + suffix;
-    const QStringList files = fileInfo.dir().entryList(nameFilters, QDir::Files);
+    const QVector<float> variants = resourceDirectory(dirPath).variants.value(baseName + suffix);
 
-    if (!files.empty()) {
-        float selectedGridUnitSuffix = gridUnitSuffixFromFileName(files.first());
+    if (!variants.isEmpty()) {
+        float selectedGridUnitSuffix = variants.first();
 
-        Q_FOREACH (const QString& fileName, files) {
-            float gridUnitSuffix = gridUnitSuffixFromFileName(fileName);
+        Q_FOREACH (float gridUnitSuffix, variants) {
             if ((selectedGridUnitSuffix >= m_gridUnit && gridUnitSuffix >= m_gridUnit && gridUnitSuffix < selectedGridUnitSuffix)
                 || (selectedGridUnitSuffix < m_gridUnit && gridUnitSuffix > selectedGridUnitSuffix)) {
                 selectedGridUnitSuffix = gridUnitSuffix;
             }
         }
 
-        path = prefix + suffixForGridUnit(selectedGridUnitSuffix) + suffix;
         float scaleFactor = m_gridUnit / selectedGridUnitSuffix;
-        return QString::number(scaleFactor) + "/" + path;
+        return QString::number(scaleFactor) + "/" + prefix + suffixForGridUnit(selectedGridUnitSuffix) + suffix;
     }
 
     return QString();
 }
 
+/*
+ * Lists the grid unit variants of the resources of a directory, sorted the way
+ * QDir lists them so the selection above stays deterministic. The listing is
+ * kept until the modification time of the directory changes. A listing taken
+ * less than a second after that time could miss files added within the same
+ * time stamp granularity, it is taken again at the next lookup.
+ */
+const UCUnits::ResourceDirectory &UCUnits::resourceDirectory(const QString &path)
+{
+    const QFileInfo dirInfo(path);
+    const qint64 modified = dirInfo.exists() ? dirInfo.lastModified().toMSecsSinceEpoch() : -1;
+    QHash<QString, ResourceDirectory>::iterator i = m_resourceDirectories.find(path);
+    if (i != m_resourceDirectories.end() && i.value().modified == modified
+            && i.value().listed > modified + 1000) {
+        return i.value();
+    }
+
+    ResourceDirectory directory;
+    directory.modified = modified;
+    directory.listed = QDateTime::currentMSecsSinceEpoch();
+    const QStringList entries = QDir(path).entryList(QDir::Files | QDir::Hidden, QDir::Name | QDir::IgnoreCase);
+    Q_FOREACH(const QString &fileName, entries) {
+        // fileBaseName@[0-9]*.fileSuffix
+        const int dot = fileName.indexOf(QLatin1Char('.'));
+        const QString stem = dot < 0 ? fileName : fileName.left(dot);
+        const int at = stem.lastIndexOf(QLatin1Char('@'));
+        if (at < 0 || at + 1 >= stem.length() || stem.at(at + 1) < QLatin1Char('0') || stem.at(at + 1) > QLatin1Char('9')) {
+            continue;
+        }
+        const QString key = stem.left(at) + (dot < 0 ? QStringLiteral(".") : fileName.mid(dot));
+        directory.variants[key].append(gridUnitSuffixFromFileName(fileName));
+    }
+    return m_resourceDirectories.insert(path, directory).value();
+}
+
 QString UCUnits::suffixForGridUnit(float gridUnit)
 {
     return "@" + QString::number(gridUnit);
@@ -280,13 +312,20 @@ QString UCUnits::suffixForGridUnit(float gridUnit)
 
 float UCUnits::gridUnitSuffixFromFileName(const QString& fileName)
 {
-    QRegularExpression re(QStringLiteral("^.*@([0-9]*).*$"));
-    QRegularExpressionMatch match = re.match(fileName);
-    if (match.hasMatch()) {
-        return match.captured(1).toFloat();
-    } else {
+    // the digits following the last '@', as in "^.*@([0-9]*).*$"
+    const int at = fileName.lastIndexOf(QLatin1Char('@'));
+    if (at < 0) {
         return 0;
     }
+    int value = 0;
+    for (int i = at + 1; i < fileName.length(); i++) {
+        const ushort c = fileName.at(i).unicode();
+        if (c < '0' || c > '9') {
+            break;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value;
 }
 
 void UCUnits::windowPropertyChanged(QPlatformWindow *window, const QString &propertyName)
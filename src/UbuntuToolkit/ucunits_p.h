@@ -23,6 +23,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QUrl>
+#include <QtCore/QVector>
 #include <QtGui/QWindow>
 
 #include <UbuntuToolkit/ubuntutoolkitglobal.h>
@@ -74,7 +75,17 @@ private Q_SLOTS:
     void devicePixelRatioChanged(qreal dpi);
 
 private:
+    // Grid unit variants of the resources of a directory, indexed by base name and
+    // suffix ("resource.png" for resource@18.png).
+    struct ResourceDirectory {
+        qint64 modified; // modification time of the directory, in ms
+        qint64 listed; // time of the listing, in ms
+        QHash<QString, QVector<float> > variants;
+    };
+    const ResourceDirectory &resourceDirectory(const QString &path);
+
     static UCUnits *m_units;
+    QHash<QString, ResourceDirectory> m_resourceDirectories;
     float m_devicePixelRatio;
     QScreen *m_screen;
     float m_gridUnit;
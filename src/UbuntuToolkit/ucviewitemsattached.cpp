@@ -111,6 +111,7 @@ UCViewItemsAttachedPrivate::UCViewItemsAttachedPrivate()
     , selectable(false)
     , draggable(false)
     , ready(false)
+    , selectedIndicesDirty(false)
 {
 }
 
@@ -302,40 +303,79 @@ void UCViewItemsAttached::setSelectMode(bool value)
 QList<int> UCViewItemsAttached::selectedIndices() const
 {
     Q_D(const UCViewItemsAttached);
-    return d->selectedList.toList();
+    if (d->selectedIndicesDirty) {
+        d->selectedIndicesCache = d->selection.toList();
+        d->selectedIndicesDirty = false;
+    }
+    return d->selectedIndicesCache;
 }
 void UCViewItemsAttached::setSelectedIndices(const QList<int> &list)
 {
     Q_D(UCViewItemsAttached);
-    if (d->selectedList.toList() == list) {
+    SelectionRanges selection = SelectionRanges::fromList(list);
+    if (d->selection == selection) {
         return;
     }
-    d->selectedList = QSet<int>::fromList(list);
-    Q_EMIT selectedIndicesChanged(list);
+    QVector<SelectionRanges::Change> changes = SelectionRanges::diff(d->selection, selection);
+    d->selection = selection;
+    d->notifySelectionChanges(changes);
 }
 
+/*!
+ * \qmlattachedsignal ViewItems::selectionRangesChanged(int first, int last, bool selected)
+ * \since Ubuntu.Components 1.3
+ * The signal is emitted for each continuous range of indexes, from \e first to
+ * \e last inclusive, which got selected or deselected. Unlike \l selectedIndicesChanged,
+ * it does not carry the entire selection, therefore it is the preferred way to
+ * track selection changes of large views.
+ */
+
 bool UCViewItemsAttachedPrivate::addSelectedItem(UCListItem *item)
 {
     int index = UCListItemPrivate::get(item)->index();
-    if (!selectedList.contains(index)) {
-        selectedList.insert(index);
-        Q_EMIT q_func()->selectedIndicesChanged(selectedList.toList());
-        return true;
+    if (!selection.insert(index, index)) {
+        return false;
     }
-    return false;
+    SelectionRanges::Change change = {index, index, true};
+    notifySelectionChanges(QVector<SelectionRanges::Change>() << change);
+    return true;
 }
 bool UCViewItemsAttachedPrivate::removeSelectedItem(UCListItem *item)
 {
-    if (selectedList.remove(UCListItemPrivate::get(item)->index()) > 0) {
-        Q_EMIT q_func()->selectedIndicesChanged(selectedList.toList());
-        return true;
+    int index = UCListItemPrivate::get(item)->index();
+    if (!selection.remove(index, index)) {
+        return false;
     }
-    return false;
+    SelectionRanges::Change change = {index, index, false};
+    notifySelectionChanges(QVector<SelectionRanges::Change>() << change);
+    return true;
 }
 
 bool UCViewItemsAttachedPrivate::isItemSelected(UCListItem *item)
 {
-    return selectedList.contains(UCListItemPrivate::get(item)->index());
+    return selection.contains(UCListItemPrivate::get(item)->index());
+}
+
+// emits the range changes, and the selectedIndices change only if anyone listens
+// to it, as that requires the materialization of the entire selection
+void UCViewItemsAttachedPrivate::notifySelectionChanges(const QVector<SelectionRanges::Change> &changes)
+{
+    Q_Q(UCViewItemsAttached);
+    selectedIndicesDirty = true;
+    for (int i = 0; i < changes.size(); i++) {
+        Q_EMIT q->selectionRangesChanged(changes[i].first, changes[i].last, changes[i].selected);
+    }
+    if (!changes.isEmpty() && isSelectedIndicesChangedConnected()) {
+        Q_EMIT q->selectedIndicesChanged(q->selectedIndices());
+    }
+}
+
+bool UCViewItemsAttachedPrivate::isSelectedIndicesChangedConnected()
+{
+    Q_Q(UCViewItemsAttached);
+    static QMetaMethod method = QMetaMethod::fromSignal(&UCViewItemsAttached::selectedIndicesChanged);
+    static int signalIdx = QMetaObjectPrivate::signalIndex(method);
+    return QObjectPrivate::get(q)->isSignalConnected(signalIdx);
 }
 
 /*!
@@ -535,38 +575,16 @@ bool UCViewItemsAttachedPrivate::isDragUpdatedConnected()
 // updates the selected indices list in ViewAttached which is changed due to dragging
 void UCViewItemsAttachedPrivate::updateSelectedIndices(int fromIndex, int toIndex)
 {
-    if (selectedList.count() == listView->count()) {
+    if (selection.count() == listView->count()) {
         // all indices selected, no need to reorder
         return;
     }
 
-    Q_Q(UCViewItemsAttached);
-    bool isFromSelected = selectedList.contains(fromIndex);
-    if (isFromSelected) {
-        selectedList.remove(fromIndex);
-        Q_EMIT q->selectedIndicesChanged(selectedList.toList());
-    }
-    // direction is -1 (forwards) or 1 (backwards)
-    int direction = (fromIndex < toIndex) ? -1 : 1;
-    int i = (direction < 0) ? fromIndex + 1 : fromIndex - 1;
-    // loop thru the selectedIndices and fix all indices
-    while (1) {
-        if (((direction < 0) && (i > toIndex)) ||
-            ((direction > 0) && (i < toIndex))) {
-            break;
-        }
-
-        if (selectedList.contains(i)) {
-            selectedList.remove(i);
-            selectedList.insert(i + direction);
-            Q_EMIT q->selectedIndicesChanged(selectedList.toList());
-        }
-        i -= direction;
-    }
-    if (isFromSelected) {
-        selectedList.insert(toIndex);
-        Q_EMIT q->selectedIndicesChanged(selectedList.toList());
-    }
+    // shift the selection ranges between the two indices and report the
+    // difference as a whole, instead of once per shifted index
+    SelectionRanges previous = selection;
+    selection.move(fromIndex, toIndex);
+    notifySelectionChanges(SelectionRanges::diff(previous, selection));
 }
 
 /*!
@@ -18,13 +18,23 @@
 
 #include "unitythemeiconprovider_p.h"
 
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
 #include <QtCore/QSettings>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
 #include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
 #include <QtCore/QtDebug>
 #include <QtGui/QImageReader>
 
+#include <algorithm>
+
+#include "imagecache_p.h"
+
 UT_NAMESPACE_BEGIN
 
 class IconTheme
@@ -33,9 +43,13 @@ public:
     typedef QSharedPointer<class IconTheme> IconThemePointer;
 
     // Returns the icon theme named @name, creating it if it didn't exist yet.
+    // Themes are only read once created, so they can be searched from any thread.
     static IconThemePointer get(const QString &name)
     {
+        // recursive, as creating a theme gets its parents
+        static QMutex mutex(QMutex::Recursive);
         static QHash<QString, IconThemePointer> themes;
+        QMutexLocker lock(&mutex);
 
         IconThemePointer theme = themes[name];
         if (theme.isNull()) {
@@ -81,6 +95,21 @@ private:
         int size, minSize, maxSize, threshold;
     };
 
+    // An icon file in the index, packed as directory index, base dir index and
+    // file type. Files of an icon are ordered the way they must be looked up:
+    // by directory, then by base dir, png before svg.
+    typedef quint32 IconFile;
+    static IconFile iconFile(int directory, int baseDir, bool svg)
+    {
+        return (quint32(directory) << 16) | (quint32(baseDir) << 1) | (svg ? 1 : 0);
+    }
+    static int iconFileDirectory(IconFile file) { return file >> 16; }
+    static int iconFileBaseDir(IconFile file) { return (file & 0xffff) >> 1; }
+    static bool iconFileIsSvg(IconFile file) { return file & 1; }
+
+    static const quint32 IndexMagic = 0x55544949; // "UTII"
+    static const quint32 IndexVersion = 1;
+
     IconTheme(const QString &name): name(name)
     {
         const QStringList paths = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
@@ -122,6 +151,127 @@ private:
                 break;
             }
         }
+
+        if (!readIndex()) {
+            buildIndex();
+            writeIndex();
+        }
+    }
+
+    // Modification times of the index.theme files and of every theme directory,
+    // whichever base dir they are in. Adding or removing an icon touches the
+    // directory, so a change here means the index is outdated.
+    QVector<qint64> directoryStamps() const
+    {
+        QVector<qint64> stamps;
+        stamps.reserve(baseDirs.count() * (directories.count() + 1));
+        Q_FOREACH(const QString &baseDir, baseDirs) {
+            QFileInfo info(baseDir + "/index.theme");
+            stamps.append(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1);
+            Q_FOREACH(const Directory &dir, directories) {
+                info.setFile(baseDir + "/" + dir.path);
+                stamps.append(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1);
+            }
+        }
+        return stamps;
+    }
+
+    QString indexFileName() const
+    {
+        const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+        if (cacheDir.isEmpty() || baseDirs.isEmpty()) {
+            return QString();
+        }
+        // the same theme may be installed in different data dirs for different apps
+        return QStringLiteral("%1/ubuntu-ui-toolkit/icons/%2-%3.index")
+                .arg(cacheDir)
+                .arg(name)
+                .arg(qHash(baseDirs.join(QLatin1Char(':'))), 0, 16);
+    }
+
+    // Scans every directory of the theme once, in lookup order.
+    void buildIndex()
+    {
+        icons.clear();
+        const QStringList filters = QStringList() << QStringLiteral("*.png") << QStringLiteral("*.svg");
+        for (int d = 0; d < directories.count(); d++) {
+            for (int b = 0; b < baseDirs.count(); b++) {
+                QDir dir(baseDirs[b] + "/" + directories[d].path);
+                const QStringList files = dir.entryList(filters, QDir::Files, QDir::Name);
+                Q_FOREACH(const QString &file, files) {
+                    const bool svg = file.endsWith(QLatin1String(".svg"));
+                    icons[file.left(file.length() - 4)].append(iconFile(d, b, svg));
+                }
+            }
+        }
+        for (IconIndex::iterator i = icons.begin(); i != icons.end(); ++i) {
+            std::sort(i.value().begin(), i.value().end());
+        }
+    }
+
+    bool readIndex()
+    {
+        QFile file(indexFileName());
+        if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        uchar *data = file.map(0, file.size());
+        if (!data) {
+            return false;
+        }
+
+        const QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(data), file.size());
+        QDataStream stream(buffer);
+        stream.setVersion(QDataStream::Qt_5_4);
+        quint32 magic = 0, version = 0;
+        QStringList indexedBaseDirs;
+        QStringList indexedDirectories;
+        QVector<qint64> stamps;
+        stream >> magic >> version;
+        bool valid = magic == IndexMagic && version == IndexVersion;
+        if (valid) {
+            stream >> indexedBaseDirs >> indexedDirectories >> stamps;
+            QStringList directoryPaths;
+            Q_FOREACH(const Directory &dir, directories) {
+                directoryPaths.append(dir.path);
+            }
+            valid = stream.status() == QDataStream::Ok
+                    && indexedBaseDirs == baseDirs
+                    && indexedDirectories == directoryPaths
+                    && stamps == directoryStamps();
+        }
+        if (valid) {
+            stream >> icons;
+            valid = stream.status() == QDataStream::Ok;
+            if (!valid) {
+                icons.clear();
+            }
+        }
+
+        file.unmap(data);
+        return valid;
+    }
+
+    void writeIndex()
+    {
+        const QString fileName = indexFileName();
+        if (fileName.isEmpty()) {
+            return;
+        }
+        QDir().mkpath(QFileInfo(fileName).absolutePath());
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+
+        QStringList directoryPaths;
+        Q_FOREACH(const Directory &dir, directories) {
+            directoryPaths.append(dir.path);
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_4);
+        stream << IndexMagic << IndexVersion << baseDirs << directoryPaths << directoryStamps() << icons;
+        file.commit();
     }
 
     SizeType sizeTypeFromString(const QString &string)
@@ -139,10 +289,11 @@ private:
     static QImage loadIcon(const QString &filename, QSize *impsize, const QSize &requestSize)
     {
         QImageReader imgio(filename);
+        QSize decodeSize = imgio.size();
 
         if (requestSize.width() > 0 || requestSize.height() > 0) {
             const bool force_scale = (imgio.format() == "svg") || (imgio.format() == "svgz");
-            QSize s = imgio.size();
+            QSize s = decodeSize;
             qreal ratio = 0.0;
 
             if (requestSize.width() > 0 && (force_scale || requestSize.width() < s.width())) {
@@ -157,38 +308,37 @@ private:
                 s.setHeight(qRound(s.height() * ratio));
                 s.setWidth(qRound(s.width() * ratio));
                 imgio.setScaledSize(s);
+                decodeSize = s;
             }
         }
 
+        // the same icon is usually shown by many items at the same size
+        QImage image = ImageCache::instance()->image(filename, decodeSize);
+        if (!image.isNull()) {
+            if (impsize)
+                *impsize = image.size();
+            return image;
+        }
+
         if (impsize)
             *impsize = imgio.scaledSize();
 
-        QImage image;
         if (imgio.read(&image)) {
             if (impsize)
                 *impsize = image.size();
+            ImageCache::instance()->insert(filename, decodeSize, image);
             return image;
         } else {
             return QImage();
         }
     }
 
-    QString lookupIconFile(const QString &dir, const QString &name)
+    QString iconFilePath(IconFile file, const QString &name)
     {
-        QString png = QStringLiteral("%1/%2.png").arg(dir, name);
-        QString svg = QStringLiteral("%1/%2.svg").arg(dir, name);
-
-        Q_FOREACH(const QString &baseDir, baseDirs) {
-            QString filename = baseDir + "/" + png;
-            if (QFileInfo::exists(filename))
-                return filename;
-
-            filename = baseDir + "/" + svg;
-            if (QFileInfo::exists(filename))
-                return filename;
-        }
-
-        return QString();
+        return QStringLiteral("%1/%2/%3.%4").arg(baseDirs[iconFileBaseDir(file)],
+                                                 directories[iconFileDirectory(file)].path,
+                                                 name,
+                                                 iconFileIsSvg(file) ? QStringLiteral("svg") : QStringLiteral("png"));
     }
 
     QImage lookupIcon(const QString &iconName, QSize *impsize, const QSize &size)
@@ -202,52 +352,59 @@ private:
 
     QImage lookupBestMatchingIcon(const QString &iconName, QSize *impsize, const QSize &size)
     {
+        const IconIndex::const_iterator files = icons.constFind(iconName);
+        if (files == icons.constEnd())
+            return QImage();
+
         int minDistance = 10000;
-        QString bestFilename;
+        IconFile bestFile = 0;
 
-        Q_FOREACH(const Directory &dir, directories) {
-            int dist = directorySizeDistance(dir, size);
+        // only the first file of a directory counts, the others have the same distance
+        Q_FOREACH(IconFile file, files.value()) {
+            int dist = directorySizeDistance(directories[iconFileDirectory(file)], size);
             if (dist >= minDistance)
                 continue;
 
-            QString filename = lookupIconFile(dir.path, iconName);
-            if (!filename.isNull()) {
-                minDistance = dist;
-                bestFilename = filename;
+            minDistance = dist;
+            bestFile = file;
 
-                // bail out early if we can't get a better size match
-                if (minDistance == 0)
-                    break;
-            }
+            // bail out early if we can't get a better size match
+            if (minDistance == 0)
+                break;
         }
 
-        if (!bestFilename.isNull())
-            return loadIcon(bestFilename, impsize, size);
+        if (minDistance < 10000)
+            return loadIcon(iconFilePath(bestFile, iconName), impsize, size);
 
         return QImage();
     }
 
     QImage lookupLargestIcon(const QString &iconName, QSize *impsize)
     {
+        const IconIndex::const_iterator files = icons.constFind(iconName);
+        if (files == icons.constEnd())
+            return QImage();
+
         int maxSize = 0;
-        QString bestFilename;
+        int previousDirectory = -1;
+        IconFile bestFile = 0;
 
-        Q_FOREACH(const Directory &dir, directories) {
+        Q_FOREACH(IconFile file, files.value()) {
+            // only the first file of a directory counts
+            if (iconFileDirectory(file) == previousDirectory)
+                continue;
+            previousDirectory = iconFileDirectory(file);
+
+            const Directory &dir = directories[previousDirectory];
             int size = dir.sizeType == Scalable ? dir.maxSize : dir.size;
             if (size < maxSize)
                 continue;
 
-            QString filename = lookupIconFile(dir.path, iconName);
-            if (!filename.isNull()) {
-                maxSize = size;
-                bestFilename = filename;
-            }
+            maxSize = size;
+            bestFile = file;
         }
 
-        if (!bestFilename.isNull())
-            return loadIcon(bestFilename, impsize, QSize(maxSize, maxSize));
-
-        return QImage();
+        return loadIcon(iconFilePath(bestFile, iconName), impsize, QSize(maxSize, maxSize));
     }
 
     int directorySizeDistance(const Directory &dir, const QSize &iconSize)
@@ -268,10 +425,13 @@ private:
         }
     }
 
+    typedef QHash<QString, QVector<IconFile> > IconIndex;
+
     QString name;
     QStringList baseDirs;
     QList<Directory> directories;
     QList<IconThemePointer> parents;
+    IconIndex icons;
 };
 
 UnityThemeIconProvider::UnityThemeIconProvider(const QString &themeName):
@@ -280,7 +440,7 @@ UnityThemeIconProvider::UnityThemeIconProvider(const QString &themeName):
     theme = IconTheme::get(themeName);
 }
 
-QImage UnityThemeIconProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+static QImage findThemeIcon(const IconTheme::IconThemePointer &theme, const QString &id, QSize *size, const QSize &requestedSize)
 {
     // The hicolor theme will be searched last as per
     // https://specifications.freedesktop.org/icon-theme-spec/icon-theme-spec-latest.html
@@ -296,4 +456,210 @@ QImage UnityThemeIconProvider::requestImage(const QString &id, QSize *size, cons
     return image;
 }
 
+QImage UnityThemeIconProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    return findThemeIcon(theme, id, size, requestedSize);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+
+class ThemeIconResponse;
+
+/*
+ * Decodes an icon for all the responses waiting for it. Responses leave the job
+ * when cancelled or destroyed; a job left without responses skips decoding.
+ */
+class ThemeIconJob
+{
+public:
+    ThemeIconJob(UnityThemeAsyncIconProvider *provider, const QString &key, const QString &id, const QSize &requestedSize)
+        : provider(provider)
+        , key(key)
+        , id(id)
+        , requestedSize(requestedSize)
+        , done(false)
+    {
+    }
+
+    // returns false if the job is already delivering its image
+    bool addResponse(ThemeIconResponse *response)
+    {
+        QMutexLocker lock(&mutex);
+        if (done) {
+            return false;
+        }
+        responses.append(response);
+        return true;
+    }
+
+    // returns false if the response already got its image
+    bool removeResponse(ThemeIconResponse *response)
+    {
+        QMutexLocker lock(&mutex);
+        return responses.removeOne(response);
+    }
+
+    void run();
+
+private:
+    UnityThemeAsyncIconProvider *provider;
+    QString key;
+    QString id;
+    QSize requestedSize;
+    QMutex mutex;
+    QList<ThemeIconResponse*> responses;
+    bool done;
+};
+
+class ThemeIconResponse : public QQuickImageResponse
+{
+public:
+    ThemeIconResponse()
+        : cancelled(false)
+    {
+    }
+
+    ~ThemeIconResponse()
+    {
+        if (job) {
+            job->removeResponse(this);
+        }
+    }
+
+    void setJob(const QSharedPointer<ThemeIconJob> &job)
+    {
+        this->job = job;
+    }
+
+    // called from the decoding thread, the signal gets queued to the requester
+    void deliver(const QImage &image)
+    {
+        this->image = image;
+        Q_EMIT finished();
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return image.isNull() ? nullptr : QQuickTextureFactory::textureFactoryForImage(image);
+    }
+
+    QString errorString() const override
+    {
+        if (cancelled) {
+            return QStringLiteral("Icon request cancelled");
+        }
+        return image.isNull() ? QStringLiteral("Icon not found in theme") : QString();
+    }
+
+    // the engine only deletes responses once finished, cancelled ones included
+    void cancel() override
+    {
+        if (job) {
+            const bool pending = job->removeResponse(this);
+            job.clear();
+            if (pending) {
+                cancelled = true;
+                Q_EMIT finished();
+            }
+        }
+    }
+
+private:
+    QSharedPointer<ThemeIconJob> job;
+    QImage image;
+    bool cancelled;
+};
+
+void ThemeIconJob::run()
+{
+    {
+        QMutexLocker lock(&mutex);
+        if (responses.isEmpty()) {
+            // all the requesters went away before we got a thread
+            done = true;
+            lock.unlock();
+            provider->removeJob(key, this);
+            return;
+        }
+    }
+
+    QSize size;
+    QImage image = findThemeIcon(provider->theme, id, &size, requestedSize);
+
+    // requests coming from now on start a new job
+    provider->removeJob(key, this);
+    // deliver while locked, so responses don't get destroyed meanwhile
+    QMutexLocker lock(&mutex);
+    done = true;
+    Q_FOREACH(ThemeIconResponse *response, responses) {
+        response->deliver(image);
+    }
+    responses.clear();
+}
+
+// keeps the job alive while it is queued or running
+class ThemeIconJobRunner : public QRunnable
+{
+public:
+    ThemeIconJobRunner(const QSharedPointer<ThemeIconJob> &job)
+        : job(job)
+    {
+    }
+
+    void run() override
+    {
+        job->run();
+    }
+
+private:
+    QSharedPointer<ThemeIconJob> job;
+};
+
+UnityThemeAsyncIconProvider::UnityThemeAsyncIconProvider(const QString &themeName)
+    : theme(IconTheme::get(themeName))
+    , sequence(0)
+{
+    // leave a core to the GUI and render threads
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+}
+
+UnityThemeAsyncIconProvider::~UnityThemeAsyncIconProvider()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+QQuickImageResponse *UnityThemeAsyncIconProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    ThemeIconResponse *response = new ThemeIconResponse;
+    const QString key = QStringLiteral("%1@%2x%3").arg(id).arg(requestedSize.width()).arg(requestedSize.height());
+
+    QMutexLocker lock(&mutex);
+    QSharedPointer<ThemeIconJob> job = jobs.value(key).toStrongRef();
+    if (job) {
+        response->setJob(job);
+    }
+    if (!job || !job->addResponse(response)) {
+        job = QSharedPointer<ThemeIconJob>(new ThemeIconJob(this, key, id, requestedSize));
+        response->setJob(job);
+        job->addResponse(response);
+        jobs.insert(key, job);
+        // higher priorities run first: the latest requests come from the items just shown,
+        // the earlier ones possibly from items already scrolled away
+        pool.start(new ThemeIconJobRunner(job), ++sequence);
+    }
+    return response;
+}
+
+void UnityThemeAsyncIconProvider::removeJob(const QString &key, ThemeIconJob *job)
+{
+    QMutexLocker lock(&mutex);
+    QHash<QString, QWeakPointer<ThemeIconJob> >::iterator i = jobs.find(key);
+    if (i != jobs.end() && i.value().data() == job) {
+        jobs.erase(i);
+    }
+}
+
+#endif
+
 UT_NAMESPACE_END
@@ -19,6 +19,10 @@
 #ifndef UNITYTHEMEICONPROVIDER_P_H
 #define UNITYTHEMEICONPROVIDER_P_H
 
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWeakPointer>
 #include <QtQuick/QQuickImageProvider>
 
 #include <UbuntuToolkit/ubuntutoolkitglobal.h>
@@ -35,6 +39,33 @@ private:
     QSharedPointer<class IconTheme> theme;
 };
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+class ThemeIconJob;
+/*
+ * Variant of UnityThemeIconProvider decoding the icons in its own bounded
+ * pool of threads. Identical requests in flight share a single decoding, and
+ * cancelled requests are dropped before being decoded. The most recent
+ * requests are served first, as they come from the items just shown.
+ */
+class UBUNTUTOOLKIT_EXPORT UnityThemeAsyncIconProvider: public QQuickAsyncImageProvider
+{
+public:
+    UnityThemeAsyncIconProvider(const QString &themeName = QStringLiteral("suru"));
+    ~UnityThemeAsyncIconProvider();
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+private:
+    friend class ThemeIconJob;
+    void removeJob(const QString &key, ThemeIconJob *job);
+
+    QSharedPointer<class IconTheme> theme;
+    QMutex mutex;
+    QHash<QString, QWeakPointer<ThemeIconJob> > jobs;
+    QThreadPool pool;
+    int sequence;
+};
+#endif
+
 UT_NAMESPACE_END
 
 #endif // UNITYTHEMEICONPROVIDER_P_H
@@ -124,7 +124,8 @@ Item {
         }
 
         property bool completed: false
-        source: completed && icon.name ? "image://theme/%1".arg(icon.name) : ""
+        source: completed && icon.name
+                ? "image://%1/%2".arg(asynchronous ? "theme-async" : "theme").arg(icon.name) : ""
 
         cache: true
         visible: !colorizedImage.visible
@@ -32,6 +32,8 @@ ULLayoutsPrivate::ULLayoutsPrivate(ULLayouts *qq)
     , previousLayoutItem(0)
     , contentItem(new QQuickItem)
     , currentLayoutIndex(-1)
+    , layoutItemIndex(-1)
+    , cacheSize(0)
     , ready(false)
 {
     // hidden container for the components that are not laid out
@@ -103,19 +105,9 @@ void ULLayoutsPrivate::statusChanged(Status status)
         // reset the layout
         currentLayoutItem = qobject_cast<QQuickItem*>(object());
         Q_ASSERT(currentLayoutItem);
+        layoutItemIndex = currentLayoutIndex;
 
-        //reparent components to be laid out
-        reparentItems();
-        // set parent item, then enable and show layout
-        changes.addChange(new ParentChange(currentLayoutItem, q, false));
-
-        // hide default layout, then show the new one
-        // there's no need to queue these property changes as we do not need
-        // to back up their previosus states
-        contentItem->setVisible(false);
-        currentLayoutItem->setVisible(true);
-        // apply changes
-        changes.apply();
+        applyCurrentLayout();
         // clear previous layout
         delete previousLayoutItem;
         previousLayoutItem = 0;
@@ -126,13 +118,39 @@ void ULLayoutsPrivate::statusChanged(Status status)
     }
 }
 
+/*
+ * Lays out the items in the current layout item and shows it.
+ */
+void ULLayoutsPrivate::applyCurrentLayout()
+{
+    Q_Q(ULLayouts);
+    //reparent components to be laid out
+    reparentItems();
+    // set parent item, then enable and show layout
+    changes.addChange(new ParentChange(currentLayoutItem, q, false));
+
+    // hide default layout, then show the new one
+    // there's no need to queue these property changes as we do not need
+    // to back up their previosus states
+    contentItem->setVisible(false);
+    currentLayoutItem->setVisible(true);
+    // apply changes
+    changes.apply();
+}
+
 /*
  * Re-parent items to the new layout.
  */
 void ULLayoutsPrivate::reparentItems()
 {
-    // create copy of items list, to keep track of which ones we change
-    LaidOutItemsMap unusedItems = itemsToLayout;
+    // create copy of items list, to keep track of which ones we change,
+    // leaving out the items destroyed since they were collected
+    LaidOutItemsMap unusedItems;
+    for (LaidOutItemsMap::const_iterator i = itemsToLayout.constBegin(); i != itemsToLayout.constEnd(); ++i) {
+        if (i.value()) {
+            unusedItems.insert(i.key(), i.value());
+        }
+    }
 
     // iterate through the Layout definition to find containers - ItemLayout items
     QList<ULItemLayout*> containers = collectContainers(currentLayoutItem);
@@ -268,11 +286,15 @@ void ULLayoutsPrivate::reLayout()
     }
 
     // redo changes
-    changes.revert();
-    changes.clear();
+    releaseCurrentLayout();
 
     // clear the incubator before using it
     clear();
+    bool restored = restoreCachedLayout(currentLayoutIndex);
+    trimLayoutCache();
+    if (restored) {
+        return;
+    }
     QQmlComponent *component = layouts[currentLayoutIndex]->layout();
     // create using incubation as it may be created asynchronously,
     // case when the attached properties are not yet enumerated
@@ -311,8 +333,8 @@ void ULLayoutsPrivate::updateLayout()
     // check if we need to switch back to default layout
     if (currentLayoutIndex >= 0) {
         // revert and clear changes
-        changes.revert();
-        changes.clear();
+        releaseCurrentLayout();
+        trimLayoutCache();
         // make contentItem visible
 
         contentItem->setVisible(true);
@@ -324,6 +346,67 @@ void ULLayoutsPrivate::updateLayout()
     }
 }
 
+/*
+ * Reverts and drops the changes of the current layout. When caching is enabled,
+ * the layout item is hidden and kept alive so it can be activated again without
+ * re-creating it; otherwise it is deleted by the caller. The caller must trim
+ * the cache.
+ */
+void ULLayoutsPrivate::releaseCurrentLayout()
+{
+    changes.revert();
+    changes.clear();
+    if (cacheSize <= 0 || !currentLayoutItem) {
+        return;
+    }
+
+    CachedLayout cached;
+    cached.index = layoutItemIndex;
+    cached.item = currentLayoutItem;
+    currentLayoutItem->setVisible(false);
+    layoutCache.prepend(cached);
+    currentLayoutItem = 0;
+    layoutItemIndex = -1;
+}
+
+/*
+ * Activates the cached layout item created for the given index, if any. The
+ * items are laid out again as for a newly created layout, so that the changes
+ * reflect their current state.
+ */
+bool ULLayoutsPrivate::restoreCachedLayout(int index)
+{
+    QQuickItem *item = 0;
+    for (int i = 0; i < layoutCache.count(); i++) {
+        if (layoutCache[i].index == index) {
+            item = layoutCache.takeAt(i).item;
+            break;
+        }
+    }
+    if (!item) {
+        return false;
+    }
+
+    Q_Q(ULLayouts);
+    delete currentLayoutItem;
+    currentLayoutItem = item;
+    layoutItemIndex = index;
+    applyCurrentLayout();
+
+    Q_EMIT q->currentLayoutChanged();
+    return true;
+}
+
+/*
+ * Drops the least recently used layouts exceeding the cache size.
+ */
+void ULLayoutsPrivate::trimLayoutCache()
+{
+    while (layoutCache.count() > qMax(cacheSize, 0)) {
+        delete layoutCache.takeLast().item.data();
+    }
+}
+
 void ULLayoutsPrivate::error(QObject *item, const QString &message)
 {
     qmlInfo(item) << "ERROR: " << message;
@@ -603,6 +686,34 @@ QString ULLayouts::currentLayout() const
     return d->currentLayoutIndex >= 0 ? d->layouts[d->currentLayoutIndex]->layoutName() : QString();
 }
 
+/*!
+ * \qmlproperty int Layouts::cacheSize
+ * The property holds the number of deactivated conditional layouts which are
+ * kept alive instead of being destroyed. Switching back to a cached layout only
+ * reparents the laid out items into the already created layout, which makes
+ * going back and forth between layouts, i.e. on rotation, considerably faster.
+ * Cached layouts are kept hidden and consume memory, the least recently used
+ * one is dropped when the limit is exceeded.
+ *
+ * The default value is 0, meaning no layout is cached.
+ */
+int ULLayouts::cacheSize() const
+{
+    Q_D(const ULLayouts);
+    return d->cacheSize;
+}
+void ULLayouts::setCacheSize(int size)
+{
+    Q_D(ULLayouts);
+    size = qMax(size, 0);
+    if (d->cacheSize == size) {
+        return;
+    }
+    d->cacheSize = size;
+    d->trimLayoutCache();
+    Q_EMIT cacheSizeChanged();
+}
+
 /*!
  * \internal
  * Provides a list of layouts for internal use.
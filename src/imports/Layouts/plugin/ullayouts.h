@@ -56,6 +56,7 @@ class ULLayouts : public QQuickItem
 
     Q_PROPERTY(QString currentLayout READ currentLayout NOTIFY currentLayoutChanged DESIGNABLE false)
     Q_PROPERTY(QQmlListProperty<ULConditionalLayout> layouts READ layouts DESIGNABLE false)
+    Q_PROPERTY(int cacheSize READ cacheSize WRITE setCacheSize NOTIFY cacheSizeChanged)
 
     Q_PROPERTY(QQmlListProperty<QObject> data READ data DESIGNABLE false)
     Q_PROPERTY(QQmlListProperty<QQuickItem> children READ children DESIGNABLE false)
@@ -67,11 +68,14 @@ public:
     static ULLayoutsAttached * qmlAttachedProperties(QObject *owner);
 
     QString currentLayout() const;
+    int cacheSize() const;
+    void setCacheSize(int size);
     QList<ULConditionalLayout*> layoutList();
     QQuickItem *contentItem() const;
 
 Q_SIGNALS:
     void currentLayoutChanged();
+    void cacheSizeChanged();
 
 protected:
     void componentComplete() override;
@@ -21,12 +21,13 @@
 
 #include "ullayouts.h"
 
+#include <QtCore/QPointer>
 #include <QtQml/QQmlIncubator>
 
 #include "propertychanges_p.h"
 
-typedef QHash<QString, QQuickItem*> LaidOutItemsMap;
-typedef QHashIterator<QString, QQuickItem*> LaidOutItemsMapIterator;
+typedef QHash<QString, QPointer<QQuickItem> > LaidOutItemsMap;
+typedef QHashIterator<QString, QPointer<QQuickItem> > LaidOutItemsMapIterator;
 
 class ULItemLayout;
 class ULLayoutsPrivate : QQmlIncubator {
@@ -56,8 +57,18 @@ private:
     QQuickItem* previousLayoutItem;
     QQuickItem* contentItem;
     int currentLayoutIndex;
+    // index of the layout currentLayoutItem was created from
+    int layoutItemIndex;
+    int cacheSize;
     bool ready:1;
 
+    // deactivated layout items kept alive, most recently used first
+    struct CachedLayout {
+        int index;
+        QPointer<QQuickItem> item;
+    };
+    QList<CachedLayout> layoutCache;
+
     // callbacks for the "layouts" QQmlListProperty of ULLayouts
     static void append_layout(QQmlListProperty<ULConditionalLayout>*, ULConditionalLayout*);
     static int count_layouts(QQmlListProperty<ULConditionalLayout>*);
@@ -65,6 +76,10 @@ private:
     static void clear_layouts(QQmlListProperty<ULConditionalLayout>*);
 
     void reLayout();
+    void applyCurrentLayout();
+    void releaseCurrentLayout();
+    bool restoreCachedLayout(int index);
+    void trimLayoutCache();
     void reparentItems();
     QList<ULItemLayout*> collectContainers(QQuickItem *fromItem);
     void reparentToItemLayout(LaidOutItemsMap &map, ULItemLayout *fragment);
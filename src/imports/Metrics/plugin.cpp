@@ -55,6 +55,8 @@ public:
         WindowEvent  = UMApplicationMonitor::WindowEvent,
         FrameEvent   = UMApplicationMonitor::FrameEvent,
         GenericEvent = UMApplicationMonitor::GenericEvent,
+        SummaryEvent = UMApplicationMonitor::SummaryEvent,
+        PaintNodeEvent = UMApplicationMonitor::PaintNodeEvent,
         AllEvents    = UMApplicationMonitor::AllEvents
     };
     Q_DECLARE_FLAGS(LoggingFilters, LoggingFilter)
@@ -101,6 +103,91 @@ private:
     UMApplicationMonitor* m_applicationMonitor;
 };
 
+// Exposes the frame histograms of the monitored windows. Times are returned in
+// milliseconds.
+class FrameHistogramsWrapper : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int summaryInterval READ summaryInterval WRITE setSummaryInterval
+               NOTIFY summaryIntervalChanged)
+
+public:
+    FrameHistogramsWrapper(QObject* parent = 0)
+        : QObject(parent)
+        , m_applicationMonitor(UMApplicationMonitor::instance())
+    {
+        QObject::connect(m_applicationMonitor, SIGNAL(histogramsChanged()),
+                         this, SIGNAL(enabledChanged()));
+        QObject::connect(m_applicationMonitor, SIGNAL(updateIntervalChanged(UMEvent::Type)),
+                         this, SLOT(updateIntervalChanged(UMEvent::Type)));
+    }
+    ~FrameHistogramsWrapper() {}
+
+    bool enabled() const { return m_applicationMonitor->histograms(); }
+    void setEnabled(bool enabled) { m_applicationMonitor->setHistograms(enabled); }
+    int summaryInterval() const {
+        return m_applicationMonitor->updateInterval(UMEvent::Summary); }
+    void setSummaryInterval(int interval) {
+        m_applicationMonitor->setUpdateInterval(UMEvent::Summary, interval); }
+
+    Q_INVOKABLE QVariant windowIds() {
+        QVariantList ids;
+        Q_FOREACH (quint32 id, m_applicationMonitor->windowIds()) {
+            ids.append(id);
+        }
+        return ids;
+    }
+
+    // Returns a map of metric names (deltaTime, syncTime, renderTime, gpuTime
+    // and swapTime) to maps of statistics (count, min, max, mean, p50, p95 and
+    // p99). Returns undefined if the window isn't monitored.
+    Q_INVOKABLE QVariant statistics(int windowId) {
+        static const char* const metricNames[UMSummaryEvent::MetricCount] = {
+            "deltaTime", "syncTime", "renderTime", "gpuTime", "swapTime"
+        };
+        // Allocated on the heap, that's about 10 kB.
+        QScopedPointer<UMFrameHistograms> histograms(new UMFrameHistograms);
+        if (!m_applicationMonitor->windowHistograms(windowId, histograms.data())) {
+            return QVariant();
+        }
+        QVariantMap statistics;
+        for (int i = 0; i < UMSummaryEvent::MetricCount; ++i) {
+            const UMHistogram& histogram = histograms->metrics[i];
+            QVariantMap metric;
+            metric[QStringLiteral("count")] = histogram.count();
+            metric[QStringLiteral("min")] = toMilliseconds(histogram.min());
+            metric[QStringLiteral("max")] = toMilliseconds(histogram.max());
+            metric[QStringLiteral("mean")] = toMilliseconds(histogram.mean());
+            metric[QStringLiteral("p50")] = toMilliseconds(histogram.percentile(50.0f));
+            metric[QStringLiteral("p95")] = toMilliseconds(histogram.percentile(95.0f));
+            metric[QStringLiteral("p99")] = toMilliseconds(histogram.percentile(99.0f));
+            statistics[QLatin1String(metricNames[i])] = metric;
+        }
+        return statistics;
+    }
+
+    Q_INVOKABLE void reset() { m_applicationMonitor->resetHistograms(); }
+
+Q_SIGNALS:
+    void enabledChanged();
+    void summaryIntervalChanged();
+
+private Q_SLOTS:
+    void updateIntervalChanged(UMEvent::Type type)
+    {
+        if (type == UMEvent::Summary) {
+            Q_EMIT summaryIntervalChanged();
+        }
+    }
+
+private:
+    static double toMilliseconds(quint64 nanoseconds) { return nanoseconds * 0.000001; }
+
+    UMApplicationMonitor* m_applicationMonitor;
+};
+
 static QObject* applicationMonitorSingletonProvider(QQmlEngine* engine, QJSEngine* scriptEngine)
 {
     Q_UNUSED(engine)
@@ -108,6 +195,13 @@ static QObject* applicationMonitorSingletonProvider(QQmlEngine* engine, QJSEngin
     return new ApplicationMonitorWrapper();
 }
 
+static QObject* frameHistogramsSingletonProvider(QQmlEngine* engine, QJSEngine* scriptEngine)
+{
+    Q_UNUSED(engine)
+    Q_UNUSED(scriptEngine)
+    return new FrameHistogramsWrapper();
+}
+
 class UbuntuMetricsPlugin : public QQmlExtensionPlugin
 {
     Q_OBJECT
@@ -121,6 +215,8 @@ public:
         Q_ASSERT(QLatin1String(uri) == QLatin1String("Ubuntu.Metrics"));
         qmlRegisterSingletonType<ApplicationMonitorWrapper>(
             uri, 1, 0, "ApplicationMonitor", applicationMonitorSingletonProvider);
+        qmlRegisterSingletonType<FrameHistogramsWrapper>(
+            uri, 1, 0, "FrameHistograms", frameHistogramsSingletonProvider);
     }
 };
 
@@ -28,6 +28,7 @@ Item {
     property color color: Qt.rgba(0.4, 0.73, 0.4, 1.0)
     property real threshold: 16.0
     property color aboveThresholdColor: "#ff4e00"
+    property color bandColor: Qt.rgba(1.0, 1.0, 1.0, 0.3)
     property string labelFormat: "%1"
 
     implicitWidth: units.gu(38)
@@ -39,48 +40,14 @@ Item {
         color: Qt.rgba(0.0, 0.0, 0.0, 0.8)
     }
 
-    PerformanceMetrics.TextureFromImage {
-        id: texture
-        image: graph.model.image
-    }
-
-    ShaderEffect {
+    PerformanceMetrics.Graph {
         anchors.fill: parent
-
-        property var texture: texture
-        property real shift: graph.model.shift / graph.model.samples
-        property real maximumValue: graph.maximumValue
-        property color color: graph.color
-        property real threshold: graph.threshold
-        property color aboveThresholdColor: graph.aboveThresholdColor
-
-        vertexShader: "
-                uniform mediump mat4 qt_Matrix;
-                uniform mediump float shift;
-                attribute mediump vec4 qt_Vertex;
-                attribute mediump vec2 qt_MultiTexCoord0;
-                varying mediump vec2 coord;
-                void main() {
-                    coord = qt_MultiTexCoord0 + vec2(shift, 0.0);
-                    gl_Position = qt_Matrix * qt_Vertex;
-                }"
-
-        fragmentShader: "
-                varying mediump vec2 coord;
-                uniform sampler2D texture;
-                uniform lowp float qt_Opacity;
-                uniform lowp float maximumValue;
-                uniform lowp vec4 color;
-                uniform lowp float threshold;
-                uniform lowp vec4 aboveThresholdColor;
-                void main() {
-                    lowp vec4 tex = texture2D(texture, vec2(coord.x, coord.y));
-                    lowp float value = tex.r * 255.0;
-                    lowp float isOn = 1.0 - step(value / maximumValue, 1.0 - coord.y);
-                    lowp float isAboveThreshold = step(threshold, value);
-
-                    gl_FragColor = mix(vec4(0.0), mix(color, aboveThresholdColor, isAboveThreshold), isOn) * qt_Opacity;
-                }"
+        model: graph.model
+        maximumValue: graph.maximumValue
+        color: graph.color
+        threshold: graph.threshold
+        aboveThresholdColor: graph.aboveThresholdColor
+        bandColor: graph.bandColor
     }
 
     Repeater {
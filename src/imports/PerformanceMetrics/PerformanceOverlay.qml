@@ -70,6 +70,20 @@ Item {
                     samplingInterval: 200
                 }
 
+                PerformanceMetrics.CpuUsage {
+                    id: guiThreadCpuUsage
+                    period: 5000
+                    samplingInterval: 250
+                    thread: PerformanceMetrics.CpuUsage.GuiThread
+                }
+
+                PerformanceMetrics.CpuUsage {
+                    id: renderThreadCpuUsage
+                    period: 5000
+                    samplingInterval: 250
+                    thread: PerformanceMetrics.CpuUsage.RenderThread
+                }
+
                 Column {
                     anchors.left: parent.left
                     anchors.right: parent.right
@@ -99,6 +113,32 @@ Item {
                                  {"color": "red", "value": 75, "label": "75%"}]
                         labelFormat: "%1 %"
                     }
+
+                    BarGraph {
+                        id: guiThreadCpuUsageGraph
+                        anchors.left: parent.left
+                        anchors.right: parent.right
+                        model: guiThreadCpuUsage.graphModel
+                        maximumValue: 100
+                        threshold: 75
+                        labels: [{"color": "green", "value": 25, "label": "25%"},
+                                 {"color": "darkorange", "value": 50, "label": "50%"},
+                                 {"color": "red", "value": 75, "label": "75%"}]
+                        labelFormat: "GUI %1 %"
+                    }
+
+                    BarGraph {
+                        id: renderThreadCpuUsageGraph
+                        anchors.left: parent.left
+                        anchors.right: parent.right
+                        model: renderThreadCpuUsage.graphModel
+                        maximumValue: 100
+                        threshold: 75
+                        labels: [{"color": "green", "value": 25, "label": "25%"},
+                                 {"color": "darkorange", "value": 50, "label": "50%"},
+                                 {"color": "red", "value": 75, "label": "75%"}]
+                        labelFormat: "Render %1 %"
+                    }
                 }
             }
 
@@ -1,9 +1,10 @@
-QT *= qml quick
+QT *= qml quick UbuntuMetrics
 
 # Input
 SOURCES += \
     $$PWD/upmplugin.cpp \
     $$PWD/upmgraphmodel.cpp \
+    $$PWD/upmgraph.cpp \
     $$PWD/upmtexturefromimage.cpp \
     $$PWD/upmrenderingtimes.cpp \
     $$PWD/upmcpuusage.cpp \
@@ -12,6 +13,7 @@ SOURCES += \
 HEADERS += \
     $$PWD/upmplugin.h \
     $$PWD/upmgraphmodel.h \
+    $$PWD/upmgraph.h \
     $$PWD/upmtexturefromimage.h \
     $$PWD/upmrenderingtimes.h \
     $$PWD/upmcpuusage.h \
@@ -20,14 +20,18 @@
 
 #include <unistd.h>
 
+Q_STATIC_ASSERT(UPMCpuUsage::LoggerThread - UPMCpuUsage::GuiThread == UMProcessEvent::LoggerThread);
+
 UPMCpuUsage::UPMCpuUsage(QQuickItem *parent) :
     QQuickItem(parent),
     m_window(NULL),
     m_graphModel(new UPMGraphModel(this)),
     m_period(5000),
     m_samplingInterval(500),
-    m_timeAtLastFrame(0)
+    m_timeAtLastFrame(0),
+    m_thread(Process)
 {
+    memset(&m_processEvent, 0, sizeof(m_processEvent));
     m_timingFactor = 100.0f / sysconf(_SC_NPROCESSORS_ONLN);
     m_previousClock = times(&m_previousTimes);
 
@@ -71,6 +75,19 @@ void UPMCpuUsage::setSamplingInterval(int samplingInterval)
     }
 }
 
+UPMCpuUsage::Thread UPMCpuUsage::thread() const
+{
+    return m_thread;
+}
+
+void UPMCpuUsage::setThread(Thread thread)
+{
+    if (thread != m_thread) {
+        m_thread = thread;
+        Q_EMIT threadChanged();
+    }
+}
+
 // FIXME: can be replaced with connecting to windowChanged() signal introduced in Qt5.2
 void UPMCpuUsage::itemChange(ItemChange change, const ItemChangeData & value)
 {
@@ -118,6 +135,18 @@ void UPMCpuUsage::appendCpuTime()
         return;
     }
 
+    int width = ((qreal)m_graphModel->samples() / m_period) * m_samplingInterval;
+
+    if (m_thread != Process) {
+        /* Per-thread CPU usage is read from /proc/self/task by UbuntuMetrics,
+           as a percentage of one core. Values are refreshed at most every
+           200 ms.
+        */
+        m_eventUtils.updateProcessEvent(&m_processEvent);
+        m_graphModel->appendValue(width, m_processEvent.process.threadCpuUsage[m_thread - GuiThread]);
+        return;
+    }
+
     struct tms newTimes;
     clock_t newClock = times(&newTimes);
 
@@ -127,6 +156,5 @@ void UPMCpuUsage::appendCpuTime()
     memcpy(&m_previousTimes, &newTimes, sizeof(tms));
     m_previousClock = newClock;
 
-    int width = ((qreal)m_graphModel->samples() / m_period) * m_samplingInterval;
     m_graphModel->appendValue(width, elapsed * m_timingFactor);
 }
@@ -26,6 +26,8 @@
 #include <QtQuick/QQuickItem>
 #include <QtQuick/QQuickWindow>
 
+#include <UbuntuMetrics/events.h>
+
 #include "upmgraphmodel.h"
 
 class UPMCpuUsage : public QQuickItem
@@ -35,23 +37,36 @@ class UPMCpuUsage : public QQuickItem
     Q_PROPERTY(UPMGraphModel* graphModel READ graphModel NOTIFY graphModelChanged)
     Q_PROPERTY(int period READ period WRITE setPeriod NOTIFY periodChanged)
     Q_PROPERTY(int samplingInterval READ samplingInterval WRITE setSamplingInterval NOTIFY samplingIntervalChanged)
+    Q_PROPERTY(Thread thread READ thread WRITE setThread NOTIFY threadChanged)
+    Q_ENUMS(Thread)
 
 public:
+    enum Thread {
+        Process,
+        GuiThread,
+        RenderThread,
+        QmlThread,
+        LoggerThread
+    };
+
     explicit UPMCpuUsage(QQuickItem* parent = 0);
 
     // getters
     UPMGraphModel* graphModel() const;
     int period() const;
     int samplingInterval() const;
+    Thread thread() const;
 
     // setters
     void setPeriod(int period);
     void setSamplingInterval(int samplingInterval);
+    void setThread(Thread thread);
 
 Q_SIGNALS:
     void graphModelChanged();
     void periodChanged();
     void samplingIntervalChanged();
+    void threadChanged();
 
 protected:
     void itemChange(ItemChange change, const ItemChangeData & value) override;
@@ -71,6 +86,9 @@ private:
     struct tms m_previousTimes;
     clock_t m_previousClock;
     int m_timeAtLastFrame;
+    Thread m_thread;
+    UMEventUtils m_eventUtils;
+    UMEvent m_processEvent;
 };
 
 #endif // UPMCPUUSAGE_H
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "upmgraph.h"
+#include "upmgraphmodel.h"
+
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtQuick/QSGMaterialShader>
+
+static QVector4D premultiplied(const QColor& color)
+{
+    const float alpha = color.alphaF();
+    return QVector4D(color.redF() * alpha, color.greenF() * alpha, color.blueF() * alpha, alpha);
+}
+
+// --- Shader ---
+
+class UPMGraphShader : public QSGMaterialShader
+{
+public:
+    char const* const* attributeNames() const override;
+    void initialize() override;
+    void updateState(
+        const RenderState& state, QSGMaterial* newEffect, QSGMaterial* oldEffect) override;
+
+protected:
+    const char* vertexShader() const override;
+    const char* fragmentShader() const override;
+
+private:
+    int m_matrixId;
+    int m_opacityId;
+    int m_shiftId;
+    int m_maximumValueId;
+    int m_thresholdId;
+    int m_statisticsId;
+    int m_lineWidthId;
+    int m_colorId;
+    int m_aboveThresholdColorId;
+    int m_bandColorId;
+};
+
+char const* const* UPMGraphShader::attributeNames() const
+{
+    static char const* const attributes[] = { "positionAttrib", "texCoordAttrib", 0 };
+    return attributes;
+}
+
+const char* UPMGraphShader::vertexShader() const
+{
+    return
+        "uniform highp mat4 matrix;\n"
+        "attribute highp vec4 positionAttrib;\n"
+        "attribute mediump vec2 texCoordAttrib;\n"
+        "varying mediump vec2 coord;\n"
+        "void main() {\n"
+        "    coord = texCoordAttrib;\n"
+        "    gl_Position = matrix * positionAttrib;\n"
+        "}";
+}
+
+const char* UPMGraphShader::fragmentShader() const
+{
+    // The texture holds the samples ring as is, the ring offset is applied
+    // here with fract() so that non power of two widths don't rely on
+    // GL_REPEAT. Heights are compared in value units, the band covers
+    // [minimum, maximum] and the average is drawn as a line on top of it.
+    return
+        "varying mediump vec2 coord;\n"
+        "uniform sampler2D texture;\n"
+        "uniform lowp float opacity;\n"
+        "uniform mediump float shift;\n"
+        "uniform mediump float maximumValue;\n"
+        "uniform mediump float threshold;\n"
+        "uniform mediump vec3 statistics;\n"
+        "uniform mediump float lineWidth;\n"
+        "uniform lowp vec4 color;\n"
+        "uniform lowp vec4 aboveThresholdColor;\n"
+        "uniform lowp vec4 bandColor;\n"
+        "void main() {\n"
+        "    mediump float value = texture2D(texture, vec2(fract(coord.x + shift), 0.5)).r * 255.0;\n"
+        "    mediump float height = (1.0 - coord.y) * maximumValue;\n"
+        "    lowp float isOn = step(height, value);\n"
+        "    lowp float isAboveThreshold = step(threshold, value);\n"
+        "    lowp vec4 bar = mix(color, aboveThresholdColor, isAboveThreshold) * isOn;\n"
+        "    lowp float inBand = step(statistics.x, height) * step(height, statistics.z);\n"
+        "    lowp float onAverage = 1.0 - step(lineWidth, abs(height - statistics.y));\n"
+        "    lowp vec4 band = bandColor * min(1.0, inBand * 0.5 + onAverage);\n"
+        "    gl_FragColor = (bar + band * (1.0 - bar.a)) * opacity;\n"
+        "}";
+}
+
+void UPMGraphShader::initialize()
+{
+    QSGMaterialShader::initialize();
+    program()->bind();
+    program()->setUniformValue("texture", 0);
+    m_matrixId = program()->uniformLocation("matrix");
+    m_opacityId = program()->uniformLocation("opacity");
+    m_shiftId = program()->uniformLocation("shift");
+    m_maximumValueId = program()->uniformLocation("maximumValue");
+    m_thresholdId = program()->uniformLocation("threshold");
+    m_statisticsId = program()->uniformLocation("statistics");
+    m_lineWidthId = program()->uniformLocation("lineWidth");
+    m_colorId = program()->uniformLocation("color");
+    m_aboveThresholdColorId = program()->uniformLocation("aboveThresholdColor");
+    m_bandColorId = program()->uniformLocation("bandColor");
+}
+
+void UPMGraphShader::updateState(
+    const RenderState& state, QSGMaterial* newEffect, QSGMaterial* oldEffect)
+{
+    Q_UNUSED(oldEffect);
+
+    UPMGraphMaterial* material = static_cast<UPMGraphMaterial*>(newEffect);
+    QOpenGLFunctions* funcs = QOpenGLContext::currentContext()->functions();
+    funcs->glBindTexture(GL_TEXTURE_2D, material->textureId);
+
+    if (state.isMatrixDirty()) {
+        program()->setUniformValue(m_matrixId, state.combinedMatrix());
+    }
+    if (state.isOpacityDirty()) {
+        program()->setUniformValue(m_opacityId, state.opacity());
+    }
+    // The ring offset and statistics change with every sample, there is no
+    // point in tracking which of these uniforms are dirty.
+    program()->setUniformValue(m_shiftId, material->shift);
+    program()->setUniformValue(m_maximumValueId, material->maximumValue);
+    program()->setUniformValue(m_thresholdId, material->threshold);
+    program()->setUniformValue(
+        m_statisticsId, material->minimum, material->average, material->maximum);
+    program()->setUniformValue(m_lineWidthId, material->pixelHeight * 0.5f);
+    program()->setUniformValue(m_colorId, material->color);
+    program()->setUniformValue(m_aboveThresholdColorId, material->aboveThresholdColor);
+    program()->setUniformValue(m_bandColorId, material->bandColor);
+}
+
+// --- Material ---
+
+UPMGraphMaterial::UPMGraphMaterial() :
+    textureId(0),
+    shift(0.0f),
+    maximumValue(1.0f),
+    threshold(0.0f),
+    minimum(0.0f),
+    average(0.0f),
+    maximum(0.0f),
+    pixelHeight(0.0f)
+{
+    setFlag(Blending, true);
+}
+
+QSGMaterialType* UPMGraphMaterial::type() const
+{
+    static QSGMaterialType type;
+    return &type;
+}
+
+QSGMaterialShader* UPMGraphMaterial::createShader() const
+{
+    return new UPMGraphShader;
+}
+
+int UPMGraphMaterial::compare(const QSGMaterial* other) const
+{
+    // Each graph owns its texture and uniforms, never batch them.
+    return this < other ? -1 : (this > other ? 1 : 0);
+}
+
+// --- Node ---
+
+UPMGraphNode::UPMGraphNode() :
+    QSGGeometryNode(),
+    m_material(),
+    m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4),
+    m_model(NULL),
+    m_written(0),
+    m_samples(0)
+{
+    m_geometry.setDrawingMode(GL_TRIANGLE_STRIP);
+    setMaterial(&m_material);
+    setGeometry(&m_geometry);
+    qsgnode_set_description(this, QLatin1String("graph"));
+}
+
+UPMGraphNode::~UPMGraphNode()
+{
+    QOpenGLContext* openglContext = QOpenGLContext::currentContext();
+    if (m_material.textureId != 0 && openglContext != NULL) {
+        openglContext->functions()->glDeleteTextures(1, &m_material.textureId);
+    }
+}
+
+void UPMGraphNode::updateTexture(const UPMGraphModel* model)
+{
+    QOpenGLFunctions* funcs = QOpenGLContext::currentContext()->functions();
+    const int samples = model->samples();
+    const quint8* values = model->values();
+
+    if (m_material.textureId == 0) {
+        funcs->glGenTextures(1, &m_material.textureId);
+        funcs->glBindTexture(GL_TEXTURE_2D, m_material.textureId);
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    } else {
+        funcs->glBindTexture(GL_TEXTURE_2D, m_material.textureId);
+    }
+    funcs->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (samples != m_samples || model != m_model) {
+        // (Re)allocate the storage, only happens when the samples count or
+        // the model changes.
+        funcs->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, samples, 1, 0,
+                            GL_LUMINANCE, GL_UNSIGNED_BYTE, values);
+        m_samples = samples;
+        m_model = model;
+    } else if (model->written() != m_written) {
+        // Upload the columns written since the last sync, ending right before
+        // the current shift. A wrapping range is split in two sub-images.
+        const int count = qMin<qint64>(model->written() - m_written, samples);
+        const int start = (model->shift() - count + samples) % samples;
+        const int after = qMin(count, samples - start);
+        funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, start, 0, after, 1,
+                               GL_LUMINANCE, GL_UNSIGNED_BYTE, &values[start]);
+        if (after < count) {
+            funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, count - after, 1,
+                                   GL_LUMINANCE, GL_UNSIGNED_BYTE, values);
+        }
+    }
+    funcs->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    m_written = model->written();
+}
+
+void UPMGraphNode::updateGeometry(const QRectF& rect)
+{
+    if (rect != m_rect) {
+        QSGGeometry::updateTexturedRectGeometry(&m_geometry, rect, QRectF(0.0, 0.0, 1.0, 1.0));
+        m_rect = rect;
+        markDirty(QSGNode::DirtyGeometry);
+    }
+}
+
+// --- Item ---
+
+UPMGraph::UPMGraph(QQuickItem* parent) :
+    QQuickItem(parent),
+    m_maximumValue(1.0),
+    m_threshold(16.0),
+    m_color(QColor::fromRgbF(0.4, 0.73, 0.4, 1.0)),
+    m_aboveThresholdColor(QColor(0xff, 0x4e, 0x00)),
+    m_bandColor(QColor::fromRgbF(1.0, 1.0, 1.0, 0.3))
+{
+    setFlag(QQuickItem::ItemHasContents);
+}
+
+UPMGraphModel* UPMGraph::model() const
+{
+    return m_model;
+}
+
+void UPMGraph::setModel(UPMGraphModel* model)
+{
+    if (model != m_model) {
+        if (m_model) {
+            QObject::disconnect(m_model, &UPMGraphModel::shiftChanged, this, &QQuickItem::update);
+        }
+        m_model = model;
+        if (m_model) {
+            QObject::connect(m_model, &UPMGraphModel::shiftChanged, this, &QQuickItem::update);
+        }
+        Q_EMIT modelChanged();
+        update();
+    }
+}
+
+qreal UPMGraph::maximumValue() const
+{
+    return m_maximumValue;
+}
+
+void UPMGraph::setMaximumValue(qreal maximumValue)
+{
+    if (maximumValue != m_maximumValue) {
+        m_maximumValue = maximumValue;
+        Q_EMIT maximumValueChanged();
+        update();
+    }
+}
+
+qreal UPMGraph::threshold() const
+{
+    return m_threshold;
+}
+
+void UPMGraph::setThreshold(qreal threshold)
+{
+    if (threshold != m_threshold) {
+        m_threshold = threshold;
+        Q_EMIT thresholdChanged();
+        update();
+    }
+}
+
+QColor UPMGraph::color() const
+{
+    return m_color;
+}
+
+void UPMGraph::setColor(const QColor& color)
+{
+    if (color != m_color) {
+        m_color = color;
+        Q_EMIT colorChanged();
+        update();
+    }
+}
+
+QColor UPMGraph::aboveThresholdColor() const
+{
+    return m_aboveThresholdColor;
+}
+
+void UPMGraph::setAboveThresholdColor(const QColor& color)
+{
+    if (color != m_aboveThresholdColor) {
+        m_aboveThresholdColor = color;
+        Q_EMIT aboveThresholdColorChanged();
+        update();
+    }
+}
+
+QColor UPMGraph::bandColor() const
+{
+    return m_bandColor;
+}
+
+void UPMGraph::setBandColor(const QColor& color)
+{
+    if (color != m_bandColor) {
+        m_bandColor = color;
+        Q_EMIT bandColorChanged();
+        update();
+    }
+}
+
+QSGNode* UPMGraph::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData)
+{
+    Q_UNUSED(updatePaintNodeData)
+
+    if (!m_model || width() <= 0.0 || height() <= 0.0 || m_maximumValue <= 0.0) {
+        delete oldNode;
+        return NULL;
+    }
+
+    UPMGraphNode* node = oldNode ? static_cast<UPMGraphNode*>(oldNode) : new UPMGraphNode;
+    node->updateTexture(m_model);
+    node->updateGeometry(boundingRect());
+
+    UPMGraphMaterial* material = node->graphMaterial();
+    material->shift = (float)m_model->shift() / m_model->samples();
+    material->maximumValue = m_maximumValue;
+    material->threshold = m_threshold;
+    material->minimum = m_model->minimum();
+    material->average = m_model->average();
+    material->maximum = m_model->maximum();
+    material->pixelHeight = m_maximumValue / height();
+    material->color = premultiplied(m_color);
+    material->aboveThresholdColor = premultiplied(m_aboveThresholdColor);
+    material->bandColor = premultiplied(m_bandColor);
+    node->markDirty(QSGNode::DirtyMaterial);
+
+    return node;
+}
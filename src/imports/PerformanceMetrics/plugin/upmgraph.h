@@ -0,0 +1,121 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPMGRAPH_H
+#define UPMGRAPH_H
+
+#include <QtCore/QPointer>
+#include <QtGui/QColor>
+#include <QtGui/QVector4D>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QSGMaterial>
+#include <QtQuick/QSGNode>
+
+class UPMGraphModel;
+
+class UPMGraphMaterial : public QSGMaterial
+{
+public:
+    UPMGraphMaterial();
+    QSGMaterialType* type() const override;
+    QSGMaterialShader* createShader() const override;
+    int compare(const QSGMaterial* other) const override;
+
+    quint32 textureId;
+    float shift;
+    float maximumValue;
+    float threshold;
+    float minimum;
+    float average;
+    float maximum;
+    float pixelHeight;
+    QVector4D color;
+    QVector4D aboveThresholdColor;
+    QVector4D bandColor;
+};
+
+// Keeps a persistent one row texture mirroring the model's samples ring and
+// uploads only the columns written since the last synchronization.
+class UPMGraphNode : public QSGGeometryNode
+{
+public:
+    UPMGraphNode();
+    ~UPMGraphNode();
+
+    void updateTexture(const UPMGraphModel* model);
+    void updateGeometry(const QRectF& rect);
+    UPMGraphMaterial* graphMaterial() { return &m_material; }
+
+private:
+    UPMGraphMaterial m_material;
+    QSGGeometry m_geometry;
+    QRectF m_rect;
+    const UPMGraphModel* m_model;
+    qint64 m_written;
+    int m_samples;
+};
+
+class UPMGraph : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(UPMGraphModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(qreal maximumValue READ maximumValue WRITE setMaximumValue NOTIFY maximumValueChanged)
+    Q_PROPERTY(qreal threshold READ threshold WRITE setThreshold NOTIFY thresholdChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor aboveThresholdColor READ aboveThresholdColor WRITE setAboveThresholdColor NOTIFY aboveThresholdColorChanged)
+    Q_PROPERTY(QColor bandColor READ bandColor WRITE setBandColor NOTIFY bandColorChanged)
+
+public:
+    explicit UPMGraph(QQuickItem* parent = 0);
+
+    // getters
+    UPMGraphModel* model() const;
+    qreal maximumValue() const;
+    qreal threshold() const;
+    QColor color() const;
+    QColor aboveThresholdColor() const;
+    QColor bandColor() const;
+
+    // setters
+    void setModel(UPMGraphModel* model);
+    void setMaximumValue(qreal maximumValue);
+    void setThreshold(qreal threshold);
+    void setColor(const QColor& color);
+    void setAboveThresholdColor(const QColor& color);
+    void setBandColor(const QColor& color);
+
+Q_SIGNALS:
+    void modelChanged();
+    void maximumValueChanged();
+    void thresholdChanged();
+    void colorChanged();
+    void aboveThresholdColorChanged();
+    void bandColorChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData) override;
+
+private:
+    QPointer<UPMGraphModel> m_model;
+    qreal m_maximumValue;
+    qreal m_threshold;
+    QColor m_color;
+    QColor m_aboveThresholdColor;
+    QColor m_bandColor;
+};
+
+#endif // UPMGRAPH_H
@@ -22,43 +22,87 @@
 
 UPMGraphModel::UPMGraphModel(QObject *parent) :
     QObject(parent),
+    m_values(100, 0),
+    m_imageDirty(true),
+    m_written(0),
+    m_sum(0),
+    m_minimum(0),
+    m_maximum(0),
     m_shift(0),
     m_samples(100),
     m_currentValue(0)
 {
-    m_image = QImage(m_samples, 1, QImage::Format_RGB32);
-    m_image.fill(0);
+}
+
+void UPMGraphModel::fill(int from, int count, quint8 value)
+{
+    quint8* data = m_values.data();
+    for (int i = from; i < from + count; i++) {
+        m_sum += value - data[i];
+    }
+    memset(&data[from], value, count);
+}
+
+void UPMGraphModel::updateStatistics()
+{
+    /* The ring is a few hundred bytes at most, scanning it is cheaper than
+       maintaining a sorted structure and doesn't allocate.
+    */
+    const quint8* data = m_values.constData();
+    int minimum = 255;
+    int maximum = 0;
+    for (int i = 0; i < m_samples; i++) {
+        minimum = qMin(minimum, (int)data[i]);
+        maximum = qMax(maximum, (int)data[i]);
+    }
+    m_minimum = minimum;
+    m_maximum = maximum;
 }
 
 void UPMGraphModel::appendValue(int width, int value)
 {
-    /* FIXME: modifying m_image here implicitly triggers a deep copy
-       of its data because UCTextureFromImage usually holds a reference
-       to that image
+    /* Samples are stored in a plain byte ring rather than in m_image so that
+       appending never detaches an image shared with a texture. Renderers
+       pick up the changed columns through values() and written().
     */
-    width = qMax(1, width);
-    QRgb* line = (QRgb*)m_image.scanLine(0);
-
-    if (width >= m_image.width()) {
-        memset(&line[0], value, m_image.width() * 4);
-    } else if (m_shift + width > m_image.width()) {
-        int after = m_image.width() - m_shift;
-        int before = width - after;
-        memset(&line[m_shift], value, after * 4);
-        memset(&line[0], value, before * 4);
+    width = qMin(qMax(1, width), m_samples);
+    quint8 column = qBound(0, value, 255);
+
+    if (m_shift + width > m_samples) {
+        int after = m_samples - m_shift;
+        fill(m_shift, after, column);
+        fill(0, width - after, column);
     } else {
-        memset(&line[m_shift], value, width * 4);
+        fill(m_shift, width, column);
     }
     m_shift = (m_shift + width) % m_samples;
+    m_written += width;
     m_currentValue = value;
+    m_imageDirty = true;
+    updateStatistics();
 
     Q_EMIT imageChanged();
     Q_EMIT shiftChanged();
     Q_EMIT currentValueChanged();
+    Q_EMIT statisticsChanged();
 }
 
 QImage UPMGraphModel::image() const
 {
+    /* Only built on demand for TextureFromImage users, Graph reads the
+       samples ring directly.
+    */
+    if (m_imageDirty) {
+        if (m_image.width() != m_samples) {
+            m_image = QImage(m_samples, 1, QImage::Format_RGB32);
+        }
+        QRgb* line = (QRgb*)m_image.scanLine(0);
+        const quint8* data = m_values.constData();
+        for (int i = 0; i < m_samples; i++) {
+            line[i] = 0x01010101u * data[i];
+        }
+        m_imageDirty = false;
+    }
     return m_image;
 }
 
@@ -74,12 +118,21 @@ int UPMGraphModel::samples() const
 
 void UPMGraphModel::setSamples(int samples)
 {
+    samples = qMax(1, samples);
     if (samples != m_samples) {
         m_samples = samples;
-        m_image = QImage(m_samples, 1, QImage::Format_RGB32);
-        m_image.fill(0);
+        m_values.fill(0, m_samples);
+        m_shift = 0;
+        m_sum = 0;
+        m_minimum = 0;
+        m_maximum = 0;
+        /* Every column changed, make sure renderers upload all of them. */
+        m_written += m_samples;
+        m_imageDirty = true;
         Q_EMIT samplesChanged();
         Q_EMIT imageChanged();
+        Q_EMIT shiftChanged();
+        Q_EMIT statisticsChanged();
     }
 }
 
@@ -87,3 +140,28 @@ int UPMGraphModel::currentValue() const
 {
     return m_currentValue;
 }
+
+int UPMGraphModel::minimum() const
+{
+    return m_minimum;
+}
+
+qreal UPMGraphModel::average() const
+{
+    return (qreal)m_sum / m_samples;
+}
+
+int UPMGraphModel::maximum() const
+{
+    return m_maximum;
+}
+
+const quint8* UPMGraphModel::values() const
+{
+    return m_values.constData();
+}
+
+qint64 UPMGraphModel::written() const
+{
+    return m_written;
+}
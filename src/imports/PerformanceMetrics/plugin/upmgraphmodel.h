@@ -20,6 +20,7 @@
 #define UPMGRAPHMODEL_H
 
 #include <QtCore/QObject>
+#include <QtCore/QVector>
 #include <QtGui/QImage>
 
 class UPMGraphModel : public QObject
@@ -30,6 +31,9 @@ class UPMGraphModel : public QObject
     Q_PROPERTY(int shift READ shift NOTIFY shiftChanged)
     Q_PROPERTY(int samples READ samples WRITE setSamples NOTIFY samplesChanged)
     Q_PROPERTY(int currentValue READ currentValue NOTIFY currentValueChanged)
+    Q_PROPERTY(int minimum READ minimum NOTIFY statisticsChanged)
+    Q_PROPERTY(qreal average READ average NOTIFY statisticsChanged)
+    Q_PROPERTY(int maximum READ maximum NOTIFY statisticsChanged)
 
 public:
     explicit UPMGraphModel(QObject *parent = 0);
@@ -41,6 +45,15 @@ public:
     int shift() const;
     int samples() const;
     int currentValue() const;
+    int minimum() const;
+    qreal average() const;
+    int maximum() const;
+
+    // Raw samples ring, one byte per column, valid until the next append.
+    const quint8* values() const;
+    // Total number of columns written since creation, used by renderers to
+    // find out which columns changed since they last synchronized.
+    qint64 written() const;
 
     // setters
     void setSamples(int samples);
@@ -50,9 +63,19 @@ Q_SIGNALS:
     void shiftChanged();
     void samplesChanged();
     void currentValueChanged();
+    void statisticsChanged();
 
 private:
-    QImage m_image;
+    void fill(int from, int count, quint8 value);
+    void updateStatistics();
+
+    QVector<quint8> m_values;
+    mutable QImage m_image;
+    mutable bool m_imageDirty;
+    qint64 m_written;
+    int m_sum;
+    int m_minimum;
+    int m_maximum;
     int m_shift;
     int m_samples;
     int m_currentValue;
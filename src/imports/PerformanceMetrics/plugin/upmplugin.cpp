@@ -23,6 +23,7 @@
 #include <QtQml/QQmlContext>
 
 #include "upmcpuusage.h"
+#include "upmgraph.h"
 #include "upmtexturefromimage.h"
 #include "upmgraphmodel.h"
 #include "upmrenderingtimes.h"
@@ -32,6 +33,7 @@ void UbuntuPerformanceMetricsPlugin::registerTypeVersion(const char *uri, int ma
     qmlRegisterType<UPMRenderingTimes>(uri, major, minor, "RenderingTimes");
     qmlRegisterType<UPMCpuUsage>(uri, major, minor, "CpuUsage");
     qmlRegisterType<UPMTextureFromImage>(uri, major, minor, "TextureFromImage");
+    qmlRegisterType<UPMGraph>(uri, major, minor, "Graph");
     qmlRegisterType<UPMGraphModel>();
 }
 
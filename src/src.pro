@@ -41,6 +41,7 @@ SUBDIRS += src_layouts_module
 
 src_performance_metrics_module.subdir = imports/PerformanceMetrics
 src_performance_metrics_module.target = sub-performance-metrics-module
+src_performance_metrics_module.depends = sub-metrics-lib
 SUBDIRS += src_performance_metrics_module
 
 src_test_module.subdir = imports/Test
@@ -0,0 +1,6 @@
+include(../test-include.pri)
+
+QT *= UbuntuMetrics UbuntuMetrics-private
+
+SOURCES += \
+    tst_eventqueue.cpp
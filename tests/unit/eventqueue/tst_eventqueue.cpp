@@ -0,0 +1,152 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <UbuntuMetrics/logger.h>
+#define private public
+#include <UbuntuMetrics/private/applicationmonitor_p.h>
+#undef private
+
+// Records the time stamps of the events logged by the logging thread.
+class TestLogger : public UMLogger
+{
+public:
+    void log(const UMEvent& event) override {
+        QMutexLocker locker(&m_mutex);
+        m_timeStamps.append(event.timeStamp);
+    }
+    bool isOpen() override { return true; }
+
+    QVector<quint64> timeStamps() {
+        QMutexLocker locker(&m_mutex);
+        return m_timeStamps;
+    }
+
+private:
+    QMutex m_mutex;
+    QVector<quint64> m_timeStamps;
+};
+
+static void push(EventQueue* queue, quint64 first, int count)
+{
+    UMEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = UMEvent::Generic;
+    for (int i = 0; i < count; ++i) {
+        event.timeStamp = first + i;
+        queue->push(&event);
+    }
+}
+
+static QVector<quint64> pop(EventQueue* queue)
+{
+    UMEvent events[8];
+    QVector<quint64> timeStamps;
+    int count;
+    while ((count = queue->pop(events, 8)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            timeStamps.append(events[i].timeStamp);
+        }
+    }
+    return timeStamps;
+}
+
+static QVector<quint64> range(quint64 first, int count)
+{
+    QVector<quint64> timeStamps;
+    for (int i = 0; i < count; ++i) {
+        timeStamps.append(first + i);
+    }
+    return timeStamps;
+}
+
+class tst_EventQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_EventQueue() {}
+
+private Q_SLOTS:
+
+    // The queues below aren't created by the logging thread, so that it
+    // doesn't drain them.
+
+    void test_dropNewest() {
+        LoggingThread* loggingThread = new LoggingThread(UMApplicationMonitor::DropNewest);
+        {
+            EventQueue queue(loggingThread, 4);
+            push(&queue, 0, 6);
+            QCOMPARE(queue.droppedEventCount(), 2u);
+            QCOMPARE(pop(&queue), range(0, 4));
+            QVERIFY(queue.isEmpty());
+        }
+        loggingThread->deref();
+    }
+
+    void test_dropOldest() {
+        LoggingThread* loggingThread = new LoggingThread(UMApplicationMonitor::DropOldest);
+        {
+            EventQueue queue(loggingThread, 4);
+            push(&queue, 0, 6);
+            QCOMPARE(queue.droppedEventCount(), 2u);
+            QCOMPARE(pop(&queue), range(2, 4));
+            // Indices are free-running, wrapping around the ring still works.
+            push(&queue, 6, 3);
+            QCOMPARE(pop(&queue), range(6, 3));
+            QCOMPARE(queue.droppedEventCount(), 2u);
+        }
+        loggingThread->deref();
+    }
+
+    // The producer waits for the logging thread to make room, nothing is lost.
+    void test_block() {
+        LoggingThread* loggingThread = new LoggingThread(UMApplicationMonitor::Block);
+        TestLogger logger;
+        UMLogger* loggers[] = { &logger };
+        loggingThread->setLoggers(loggers, 1);
+        EventQueue* queue = loggingThread->createQueue(4);
+        push(queue, 0, 100);
+        QCOMPARE(queue->droppedEventCount(), 0u);
+        // The logging thread deletes the queue once drained.
+        queue->release();
+        QTRY_COMPARE(logger.timeStamps(), range(0, 100));
+        QCOMPARE(loggingThread->droppedEventCount(), Q_UINT64_C(0));
+        loggingThread->deref();
+    }
+
+    // With empty queues, the logging thread waits without timeout and a
+    // single event is enough to wake it up.
+    void test_idleWait() {
+        LoggingThread* loggingThread = new LoggingThread(UMApplicationMonitor::Block);
+        TestLogger logger;
+        UMLogger* loggers[] = { &logger };
+        loggingThread->setLoggers(loggers, 1);
+        EventQueue* queue = loggingThread->createQueue(64);
+        QTRY_COMPARE(loggingThread->m_waiting.loadAcquire(),
+                     static_cast<quint32>(LoggingThread::IdleWaiting));
+        push(queue, 0, 1);
+        QTRY_COMPARE(logger.timeStamps(), range(0, 1));
+        QTRY_COMPARE(loggingThread->m_waiting.loadAcquire(),
+                     static_cast<quint32>(LoggingThread::IdleWaiting));
+        queue->release();
+        loggingThread->deref();
+    }
+};
+
+QTEST_MAIN(tst_EventQueue)
+
+#include "tst_eventqueue.moc"
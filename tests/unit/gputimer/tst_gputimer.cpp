@@ -0,0 +1,105 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QTest>
+#include <UbuntuMetrics/private/gputimer_p.h>
+
+Q_DECLARE_METATYPE(GPUTimer::Type)
+
+static quint32 types(std::initializer_list<GPUTimer::Type> list)
+{
+    quint32 mask = 0;
+    for (GPUTimer::Type type : list) {
+        mask |= 1 << type;
+    }
+    return mask;
+}
+
+class tst_GPUTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_GPUTimer() {}
+
+private Q_SLOTS:
+
+    void test_selectType_data() {
+        QTest::addColumn<quint32>("types");
+        QTest::addColumn<bool>("asynchronous");
+        QTest::addColumn<GPUTimer::Type>("type");
+
+        // OpenGL ES.
+        QTest::newRow("disjoint, async")
+            << types({ GPUTimer::EXTDisjointTimerQuery, GPUTimer::KHRFence })
+            << true << GPUTimer::EXTDisjointTimerQuery;
+        QTest::newRow("disjoint, sync")
+            << types({ GPUTimer::EXTDisjointTimerQuery, GPUTimer::KHRFence })
+            << false << GPUTimer::KHRFence;
+        // Fences wait for the GPU in stop(), they must not be pipelined.
+        QTest::newRow("KHR fence, async")
+            << types({ GPUTimer::KHRFence, GPUTimer::NVFence }) << true << GPUTimer::Unset;
+        QTest::newRow("KHR fence, sync")
+            << types({ GPUTimer::KHRFence, GPUTimer::NVFence }) << false << GPUTimer::KHRFence;
+        QTest::newRow("NV fence, async")
+            << types({ GPUTimer::NVFence }) << true << GPUTimer::Unset;
+        QTest::newRow("NV fence, sync")
+            << types({ GPUTimer::NVFence }) << false << GPUTimer::NVFence;
+
+        // OpenGL.
+        QTest::newRow("ARB query, async")
+            << types({ GPUTimer::ARBTimerQuery, GPUTimer::EXTTimerQuery })
+            << true << GPUTimer::ARBTimerQuery;
+        QTest::newRow("ARB query, sync")
+            << types({ GPUTimer::ARBTimerQuery, GPUTimer::EXTTimerQuery })
+            << false << GPUTimer::ARBTimerQuery;
+        QTest::newRow("EXT query, async")
+            << types({ GPUTimer::EXTTimerQuery }) << true << GPUTimer::EXTTimerQuery;
+        QTest::newRow("EXT query, sync")
+            << types({ GPUTimer::EXTTimerQuery }) << false << GPUTimer::EXTTimerQuery;
+
+        // glFinish() stalls the pipeline, it's only used synchronously.
+        QTest::newRow("none, async") << types({}) << true << GPUTimer::Unset;
+        QTest::newRow("none, sync") << types({}) << false << GPUTimer::Finish;
+    }
+    void test_selectType() {
+        QFETCH(quint32, types);
+        QFETCH(bool, asynchronous);
+        QFETCH(GPUTimer::Type, type);
+        QCOMPARE(GPUTimer::selectType(types, asynchronous), type);
+    }
+
+    // initialize() drops the types which entry points can't be resolved and
+    // selects again.
+    void test_selectTypeFallback() {
+        quint32 available = types({ GPUTimer::EXTDisjointTimerQuery, GPUTimer::KHRFence,
+                                    GPUTimer::NVFence });
+        QCOMPARE(GPUTimer::selectType(available, false), GPUTimer::KHRFence);
+        available &= ~(1 << GPUTimer::KHRFence);
+        QCOMPARE(GPUTimer::selectType(available, false), GPUTimer::NVFence);
+        available &= ~(1 << GPUTimer::NVFence);
+        QCOMPARE(GPUTimer::selectType(available, false), GPUTimer::Finish);
+
+        available = types({ GPUTimer::EXTDisjointTimerQuery, GPUTimer::KHRFence });
+        QCOMPARE(GPUTimer::selectType(available, true), GPUTimer::EXTDisjointTimerQuery);
+        available &= ~(1 << GPUTimer::EXTDisjointTimerQuery);
+        QCOMPARE(GPUTimer::selectType(available, true), GPUTimer::Unset);
+    }
+};
+
+QTEST_MAIN(tst_GPUTimer)
+
+#include "tst_gputimer.moc"
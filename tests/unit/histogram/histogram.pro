@@ -0,0 +1,6 @@
+include(../test-include.pri)
+
+QT *= UbuntuMetrics
+
+SOURCES += \
+    tst_histogram.cpp
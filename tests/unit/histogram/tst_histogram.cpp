@@ -0,0 +1,164 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QTest>
+#include <UbuntuMetrics/histogram.h>
+
+// Returns true if value is within the bucket precision of expected. Buckets
+// split each power-of-two range in 16, values are reported at the middle of
+// their bucket so the relative error is bounded by 1/32.
+static bool fuzzyCompare(quint64 value, quint64 expected)
+{
+    const quint64 error = value > expected ? value - expected : expected - value;
+    return error * 32 <= expected;
+}
+
+class tst_Histogram : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_Histogram() {}
+
+private Q_SLOTS:
+
+    void test_empty() {
+        UMHistogram histogram;
+        QCOMPARE(histogram.count(), Q_UINT64_C(0));
+        QCOMPARE(histogram.min(), Q_UINT64_C(0));
+        QCOMPARE(histogram.max(), Q_UINT64_C(0));
+        QCOMPARE(histogram.mean(), Q_UINT64_C(0));
+        QCOMPARE(histogram.percentile(50.0f), Q_UINT64_C(0));
+    }
+
+    void test_reset() {
+        UMHistogram histogram;
+        histogram.add(1000);
+        histogram.add(2000);
+        histogram.reset();
+        QCOMPARE(histogram.count(), Q_UINT64_C(0));
+        QCOMPARE(histogram.min(), Q_UINT64_C(0));
+        QCOMPARE(histogram.max(), Q_UINT64_C(0));
+        QCOMPARE(histogram.percentile(100.0f), Q_UINT64_C(0));
+    }
+
+    // Values lower than 16 have their own bucket and are exact.
+    void test_exactBuckets() {
+        UMHistogram histogram;
+        for (quint64 i = 1; i <= 10; ++i) {
+            histogram.add(i);
+        }
+        QCOMPARE(histogram.count(), Q_UINT64_C(10));
+        QCOMPARE(histogram.min(), Q_UINT64_C(1));
+        QCOMPARE(histogram.max(), Q_UINT64_C(10));
+        QCOMPARE(histogram.mean(), Q_UINT64_C(5));
+        QCOMPARE(histogram.percentile(0.0f), Q_UINT64_C(1));
+        QCOMPARE(histogram.percentile(50.0f), Q_UINT64_C(5));
+        QCOMPARE(histogram.percentile(95.0f), Q_UINT64_C(10));
+        QCOMPARE(histogram.percentile(100.0f), Q_UINT64_C(10));
+        // Out of range percentiles are clamped.
+        QCOMPARE(histogram.percentile(-10.0f), Q_UINT64_C(1));
+        QCOMPARE(histogram.percentile(150.0f), Q_UINT64_C(10));
+    }
+
+    void test_bucketPrecision_data() {
+        QTest::addColumn<quint64>("value");
+        QTest::newRow("16") << Q_UINT64_C(16);
+        QTest::newRow("31") << Q_UINT64_C(31);
+        QTest::newRow("1000") << Q_UINT64_C(1000);
+        QTest::newRow("16666666") << Q_UINT64_C(16666666);
+        QTest::newRow("2^35 + 1") << (Q_UINT64_C(1) << 35) + 1;
+    }
+    void test_bucketPrecision() {
+        QFETCH(quint64, value);
+
+        // Surround the value so that the percentile isn't clamped to the
+        // min or the max.
+        UMHistogram histogram;
+        histogram.add(0);
+        histogram.add(value);
+        histogram.add(value);
+        histogram.add((Q_UINT64_C(1) << 36) - 1);
+        QVERIFY(fuzzyCompare(histogram.percentile(50.0f), value));
+    }
+
+    void test_clamping() {
+        UMHistogram histogram;
+        histogram.add(Q_UINT64_C(1) << 40);
+        QCOMPARE(histogram.max(), (Q_UINT64_C(1) << 36) - 1);
+        QCOMPARE(histogram.percentile(50.0f), (Q_UINT64_C(1) << 36) - 1);
+    }
+
+    // Frame times uniformly distributed from 1 µs to 1 ms.
+    void test_uniformDistribution() {
+        UMHistogram histogram;
+        for (quint64 i = 1; i <= 1000; ++i) {
+            histogram.add(i * 1000);
+        }
+        QCOMPARE(histogram.count(), Q_UINT64_C(1000));
+        QCOMPARE(histogram.min(), Q_UINT64_C(1000));
+        QCOMPARE(histogram.max(), Q_UINT64_C(1000000));
+        QCOMPARE(histogram.mean(), Q_UINT64_C(500500));
+        QVERIFY(fuzzyCompare(histogram.percentile(50.0f), 500000));
+        QVERIFY(fuzzyCompare(histogram.percentile(95.0f), 950000));
+        QVERIFY(fuzzyCompare(histogram.percentile(99.0f), 990000));
+    }
+
+    // Mostly 60 Hz frames with a few 30 Hz ones.
+    void test_bimodalDistribution() {
+        UMHistogram histogram;
+        for (int i = 0; i < 97; ++i) {
+            histogram.add(16666666);
+        }
+        for (int i = 0; i < 3; ++i) {
+            histogram.add(33333333);
+        }
+        QVERIFY(fuzzyCompare(histogram.percentile(50.0f), 16666666));
+        QVERIFY(fuzzyCompare(histogram.percentile(95.0f), 16666666));
+        QVERIFY(fuzzyCompare(histogram.percentile(99.0f), 33333333));
+        QCOMPARE(histogram.max(), Q_UINT64_C(33333333));
+    }
+
+    // Merging histograms must give the same results as adding all the values
+    // to a single one.
+    void test_merge() {
+        UMHistogram all, even, odd, empty;
+        for (quint64 i = 1; i <= 1000; ++i) {
+            all.add(i * 1000);
+            if (i % 2) {
+                odd.add(i * 1000);
+            } else {
+                even.add(i * 1000);
+            }
+        }
+        UMHistogram merged;
+        merged.add(empty);
+        merged.add(even);
+        merged.add(odd);
+        merged.add(empty);
+        QCOMPARE(merged.count(), all.count());
+        QCOMPARE(merged.min(), all.min());
+        QCOMPARE(merged.max(), all.max());
+        QCOMPARE(merged.mean(), all.mean());
+        QCOMPARE(merged.percentile(50.0f), all.percentile(50.0f));
+        QCOMPARE(merged.percentile(95.0f), all.percentile(95.0f));
+        QCOMPARE(merged.percentile(99.0f), all.percentile(99.0f));
+    }
+};
+
+QTEST_MAIN(tst_Histogram)
+
+#include "tst_histogram.moc"
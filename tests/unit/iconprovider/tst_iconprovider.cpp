@@ -18,9 +18,46 @@
 #define private public
 #include <UbuntuToolkit/private/unitythemeiconprovider_p.h>
 #undef private
+#include <UbuntuToolkit/private/imagecache_p.h>
+
+#include <utime.h>
 
 UT_USE_NAMESPACE
 
+static bool setModificationTime(const QString &path, qint64 secsSinceEpoch)
+{
+    struct utimbuf times;
+    times.actime = times.modtime = static_cast<time_t>(secsSinceEpoch);
+    return utime(QFile::encodeName(path).constData(), &times) == 0;
+}
+
+// Themes are created once per process, so the icon index is only ever read
+// back by another process. Runs test_indexChildProcess() in a new process
+// looking up @icon in the themes of @dataDir.
+static bool resolveInNewProcess(const QString &dataDir, const QString &icon)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("XDG_DATA_DIRS", dataDir);
+    environment.insert("ICONPROVIDER_CHILD_ICON", icon);
+    QProcess process;
+    process.setProcessEnvironment(environment);
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.start(QCoreApplication::applicationFilePath(),
+                  QStringList() << "-platform" << "minimal" << "test_indexChildProcess");
+    return process.waitForFinished()
+        && process.exitStatus() == QProcess::NormalExit
+        && process.exitCode() == 0;
+}
+
+class BlockingRunnable : public QRunnable
+{
+public:
+    BlockingRunnable(QSemaphore *semaphore) : semaphore(semaphore) {}
+    void run() override { semaphore->acquire(); }
+private:
+    QSemaphore *semaphore;
+};
+
 class tst_IconProvider : public QObject
 {
     Q_OBJECT
@@ -31,7 +68,16 @@ private Q_SLOTS:
 
     void initTestCase()
     {
+        if (qEnvironmentVariableIsSet("ICONPROVIDER_CHILD_ICON")) {
+            // the environment is set up by the parent process
+            return;
+        }
         qputenv("XDG_DATA_DIRS", SRCDIR);
+        // keep the icon index out of the user's cache
+        QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+        QString cacheDir(tempDir.filePath("tst_iconprovider"));
+        QDir(cacheDir).removeRecursively();
+        qputenv("XDG_CACHE_HOME", cacheDir.toUtf8());
     }
 
     void test_loadIcon_data()
@@ -93,6 +139,151 @@ private Q_SLOTS:
         QVERIFY(!i.isNull());
         QCOMPARE(QColor(i.pixel(0,0)), QColor(Qt::black));
     }
+
+    void test_indexCache()
+    {
+        UnityThemeIconProvider provider("mockTheme");
+        QSize returnedSize;
+        // myapp2 is only found in hicolor, after searching the whole mockTheme hierarchy
+        QVERIFY(!provider.requestImage("myapp2", &returnedSize, QSize(16, 16)).isNull());
+
+        // the index of every theme searched is kept on disk
+        QDir indexDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                      + "/ubuntu-ui-toolkit/icons");
+        QStringList indexes = indexDir.entryList(QStringList() << "*.index", QDir::Files);
+        QVERIFY(indexes.filter(QRegularExpression("^mockTheme-")).count() == 1);
+        QVERIFY(indexes.filter(QRegularExpression("^hicolor-")).count() == 1);
+    }
+
+    void test_indexReuse()
+    {
+        QTemporaryDir dataDir;
+        QVERIFY(dataDir.isValid());
+        const QString themeDir = dataDir.path() + "/icons/indexTheme";
+        const QString appsDir = themeDir + "/apps/32";
+        const QString png = SRCDIR "icons/mockTheme/apps/512/gallery-app.png";
+        QVERIFY(QDir().mkpath(appsDir));
+        QFile indexTheme(themeDir + "/index.theme");
+        QVERIFY(indexTheme.open(QIODevice::WriteOnly));
+        indexTheme.write("[Icon Theme]\nName=IndexTheme\nDirectories=apps/32\n\n"
+                         "[apps/32]\nSize=32\nType=Fixed\n");
+        indexTheme.close();
+        QVERIFY(QFile::copy(png, appsDir + "/first.png"));
+
+        // the first process builds the index
+        QVERIFY(resolveInNewProcess(dataDir.path(), "first"));
+        QDir indexDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                      + "/ubuntu-ui-toolkit/icons");
+        const QStringList indexes = indexDir.entryList(QStringList() << "indexTheme-*.index", QDir::Files);
+        QCOMPARE(indexes.count(), 1);
+        const QString indexFile = indexDir.filePath(indexes.first());
+
+        // the next ones resolve icons from it, without writing it again
+        const qint64 indexTime = 1000000000;
+        QVERIFY(setModificationTime(indexFile, indexTime));
+        QVERIFY(resolveInNewProcess(dataDir.path(), "first"));
+        QCOMPARE(QFileInfo(indexFile).lastModified().toMSecsSinceEpoch() / 1000, indexTime);
+
+        // adding an icon touches its directory, which outdates the index; the
+        // time is moved forward for file systems with coarse time stamps
+        QVERIFY(QFile::copy(png, appsDir + "/second.png"));
+        const qint64 appsDirTime = QFileInfo(appsDir).lastModified().toMSecsSinceEpoch() / 1000;
+        QVERIFY(setModificationTime(appsDir, appsDirTime + 10));
+        QVERIFY(resolveInNewProcess(dataDir.path(), "second"));
+        QVERIFY(QFileInfo(indexFile).lastModified().toMSecsSinceEpoch() / 1000 != indexTime);
+    }
+
+    // run by test_indexReuse() in a new process
+    void test_indexChildProcess()
+    {
+        const QString icon = QString::fromLocal8Bit(qgetenv("ICONPROVIDER_CHILD_ICON"));
+        if (icon.isEmpty()) {
+            QSKIP("Only run by test_indexReuse()");
+        }
+        UnityThemeIconProvider provider("indexTheme");
+        QSize returnedSize;
+        QVERIFY(!provider.requestImage(icon, &returnedSize, QSize(32, 32)).isNull());
+    }
+
+    void test_imageCache()
+    {
+        ImageCache *cache = ImageCache::instance();
+        cache->clear();
+        UnityThemeIconProvider provider("mockTheme");
+        QSize returnedSize;
+
+        int misses = cache->misses();
+        int hits = cache->hits();
+        QImage first = provider.requestImage("gallery-app", &returnedSize, QSize(32, 32));
+        QCOMPARE(cache->misses(), misses + 1);
+        QImage second = provider.requestImage("gallery-app", &returnedSize, QSize(32, 32));
+        QCOMPARE(cache->hits(), hits + 1);
+        QCOMPARE(returnedSize, QSize(32, 32));
+        // shared, not decoded again
+        QCOMPARE(second.constBits(), first.constBits());
+
+        // least recently used images are dropped when over budget
+        int maxCost = cache->maxCost();
+        cache->setMaxCost(first.byteCount());
+        provider.requestImage("gallery-app", &returnedSize, QSize(16, 16));
+        QVERIFY(cache->totalCost() <= first.byteCount());
+        misses = cache->misses();
+        provider.requestImage("gallery-app", &returnedSize, QSize(32, 32));
+        QCOMPARE(cache->misses(), misses + 1);
+        cache->setMaxCost(maxCost);
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    void test_asyncProvider()
+    {
+        UnityThemeAsyncIconProvider provider("mockTheme");
+        ImageCache *cache = ImageCache::instance();
+        cache->clear();
+        const int misses = cache->misses();
+        // keep the single decoding thread busy while requesting
+        QSemaphore semaphore;
+        provider.pool.setMaxThreadCount(1);
+        provider.pool.start(new BlockingRunnable(&semaphore));
+
+        QScopedPointer<QQuickImageResponse> first(provider.requestImageResponse("gallery-app", QSize(24, 24)));
+        QScopedPointer<QQuickImageResponse> second(provider.requestImageResponse("gallery-app", QSize(24, 24)));
+        QScopedPointer<QQuickImageResponse> cancelled(provider.requestImageResponse("gallery-app", QSize(16, 16)));
+        // identical requests share the decoding
+        QCOMPARE(provider.jobs.count(), 2);
+
+        QSignalSpy firstSpy(first.data(), SIGNAL(finished()));
+        QSignalSpy secondSpy(second.data(), SIGNAL(finished()));
+        QSignalSpy cancelledSpy(cancelled.data(), SIGNAL(finished()));
+        cancelled->cancel();
+        // finished right away, so that the engine deletes the response
+        QCOMPARE(cancelledSpy.count(), 1);
+        QVERIFY(!cancelled->textureFactory());
+        QVERIFY(!cancelled->errorString().isEmpty());
+        semaphore.release();
+
+        QTRY_COMPARE(firstSpy.count(), 1);
+        QTRY_COMPARE(secondSpy.count(), 1);
+        provider.pool.waitForDone();
+        QCOMPARE(cancelledSpy.count(), 1);
+        QVERIFY(provider.jobs.isEmpty());
+        // only the shared 24x24 request got decoded
+        QCOMPARE(cache->misses(), misses + 1);
+
+        QScopedPointer<QQuickTextureFactory> texture(first->textureFactory());
+        QVERIFY(texture);
+        QCOMPARE(texture->textureSize(), QSize(24, 24));
+    }
+#endif
+
+    void benchmark_lookupMissingIcon()
+    {
+        // an icon found nowhere walks the whole theme hierarchy, without loading any image
+        UnityThemeIconProvider provider("mockTheme");
+        QSize returnedSize;
+        QBENCHMARK {
+            provider.requestImage("missing-icon,another-missing-icon", &returnedSize, QSize(24, 24));
+        }
+    }
 };
 
 QTEST_MAIN(tst_IconProvider)
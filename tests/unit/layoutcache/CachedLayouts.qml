@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.0
+import Ubuntu.Components 1.3
+import Ubuntu.Layouts 1.0
+
+Item {
+    id: root
+    width: units.gu(40)
+    height: units.gu(30)
+
+    // number of items laid out by the small layout
+    property int smallItemCount: 2
+
+    Layouts {
+        objectName: "layouts"
+        id: layouts
+        anchors.fill: parent
+        layouts: [
+            ConditionalLayout {
+                name: "small"
+                when: layouts.width <= units.gu(40)
+                Column {
+                    objectName: "column"
+                    anchors.fill: parent
+                    Repeater {
+                        model: root.smallItemCount
+                        ItemLayout {
+                            item: "item" + (index + 1)
+                            width: units.gu(10)
+                            height: units.gu(5)
+                        }
+                    }
+                }
+            },
+            ConditionalLayout {
+                name: "medium"
+                when: layouts.width > units.gu(40) && layouts.width <= units.gu(60)
+                Flow {
+                    objectName: "flow"
+                    anchors.fill: parent
+                    ItemLayout {
+                        item: "item1"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                    ItemLayout {
+                        item: "item2"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                    ItemLayout {
+                        item: "item3"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                }
+            },
+            ConditionalLayout {
+                name: "large"
+                when: layouts.width > units.gu(60)
+                Row {
+                    objectName: "row"
+                    anchors.fill: parent
+                    ItemLayout {
+                        item: "item1"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                    ItemLayout {
+                        item: "item2"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                    ItemLayout {
+                        item: "item3"
+                        width: units.gu(10)
+                        height: units.gu(5)
+                    }
+                }
+            }
+        ]
+
+        // default layout
+        Column {
+            Rectangle {
+                objectName: "item1"
+                Layouts.item: "item1"
+                color: "red"
+                width: units.gu(5)
+                height: units.gu(5)
+            }
+            Rectangle {
+                objectName: "item2"
+                Layouts.item: "item2"
+                color: "green"
+                width: units.gu(5)
+                height: units.gu(5)
+            }
+            Rectangle {
+                objectName: "item3"
+                Layouts.item: "item3"
+                color: "blue"
+                width: units.gu(5)
+                height: units.gu(5)
+            }
+        }
+    }
+}
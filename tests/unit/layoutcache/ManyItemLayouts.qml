@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.0
+import Ubuntu.Components 1.3
+import Ubuntu.Layouts 1.0
+
+Item {
+    id: root
+    width: units.gu(40)
+    height: units.gu(30)
+
+    property int itemCount: 200
+
+    Layouts {
+        objectName: "layouts"
+        id: layouts
+        anchors.fill: parent
+        layouts: [
+            ConditionalLayout {
+                name: "small"
+                when: layouts.width <= units.gu(40)
+                Column {
+                    anchors.fill: parent
+                    Repeater {
+                        model: root.itemCount
+                        ItemLayout {
+                            item: "item" + index
+                            width: units.gu(4)
+                            height: units.gu(1)
+                        }
+                    }
+                }
+            },
+            ConditionalLayout {
+                name: "medium"
+                when: layouts.width > units.gu(40)
+                Flow {
+                    anchors.fill: parent
+                    Repeater {
+                        model: root.itemCount
+                        ItemLayout {
+                            item: "item" + index
+                            width: units.gu(2)
+                            height: units.gu(2)
+                        }
+                    }
+                }
+            }
+        ]
+
+        // default layout
+        Flow {
+            anchors.fill: parent
+            Repeater {
+                model: root.itemCount
+                Rectangle {
+                    Layouts.item: "item" + index
+                    width: units.gu(1)
+                    height: width
+                    anchors.margins: units.dp(1)
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,10 @@
+include(../test-include-x11.pri)
+include(../../unit/qtprivate_dependency.pri)
+
+QT += gui
+SOURCES += \
+    tst_layoutcache.cpp
+
+OTHER_FILES += \
+    CachedLayouts.qml \
+    ManyItemLayouts.qml
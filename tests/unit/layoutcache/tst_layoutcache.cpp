@@ -0,0 +1,161 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtCore/QPointer>
+#include <QtQuick/QQuickItem>
+#include <QtTest/QtTest>
+#include <UbuntuToolkit/private/ucunits_p.h>
+
+#include "uctestcase.h"
+#include "ullayouts.h"
+
+UT_USE_NAMESPACE
+
+class tst_LayoutCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_LayoutCache() {}
+
+    // the positioner of the ItemLayout holding a laid out item
+    QQuickItem *container(QQuickItem *item)
+    {
+        return item->parentItem() ? item->parentItem()->parentItem() : 0;
+    }
+
+private Q_SLOTS:
+
+    void testCase_CachedLayouts()
+    {
+        QScopedPointer<UbuntuTestCase> view(new UbuntuTestCase("CachedLayouts.qml"));
+        QQuickItem *root = view->rootObject();
+        ULLayouts *layouts = view->findItem<ULLayouts*>("layouts");
+        layouts->setCacheSize(1);
+        QTRY_COMPARE(layouts->currentLayout(), QString("small"));
+
+        QQuickItem *item = view->findItem<QQuickItem*>("item1");
+        QPointer<QQuickItem> column(container(item));
+        QCOMPARE(column->objectName(), QString("column"));
+
+        root->setWidth(UCUnits::instance()->gu(55));
+        QTRY_COMPARE(layouts->currentLayout(), QString("medium"));
+        QCOMPARE(container(item)->objectName(), QString("flow"));
+        // the small layout is kept alive, hidden
+        QVERIFY(column);
+        QCOMPARE(column->isVisible(), false);
+
+        // switching back re-uses the cached layout synchronously
+        QSignalSpy layoutChangeSpy(layouts, SIGNAL(currentLayoutChanged()));
+        root->setWidth(UCUnits::instance()->gu(40));
+        QCOMPARE(layoutChangeSpy.count(), 1);
+        QCOMPARE(layouts->currentLayout(), QString("small"));
+        QCOMPARE(container(item), column.data());
+        QCOMPARE(column->isVisible(), true);
+
+        root->setWidth(UCUnits::instance()->gu(55));
+        QTRY_COMPARE(layouts->currentLayout(), QString("medium"));
+        root->setWidth(UCUnits::instance()->gu(100));
+        QTRY_COMPARE(layouts->currentLayout(), QString("large"));
+        // only one layout is kept, the least recently used is dropped
+        QTRY_VERIFY(!column);
+
+        // dropping the cache deletes the hidden medium layout
+        layouts->setCacheSize(0);
+        QVERIFY(!layouts->findChild<QQuickItem*>("flow"));
+    }
+
+    void testCase_CachedLayoutNewContainers()
+    {
+        QScopedPointer<UbuntuTestCase> view(new UbuntuTestCase("CachedLayouts.qml"));
+        QQuickItem *root = view->rootObject();
+        ULLayouts *layouts = view->findItem<ULLayouts*>("layouts");
+        layouts->setCacheSize(1);
+        QTRY_COMPARE(layouts->currentLayout(), QString("small"));
+
+        QQuickItem *item3 = view->findItem<QQuickItem*>("item3");
+        QVERIFY(container(item3)->objectName() != QString("column"));
+
+        root->setWidth(UCUnits::instance()->gu(55));
+        QTRY_COMPARE(layouts->currentLayout(), QString("medium"));
+        QCOMPARE(container(item3)->objectName(), QString("flow"));
+
+        // add a container to the cached small layout
+        root->setProperty("smallItemCount", 3);
+        root->setWidth(UCUnits::instance()->gu(40));
+        QCOMPARE(layouts->currentLayout(), QString("small"));
+        QCOMPARE(container(item3)->objectName(), QString("column"));
+        QCOMPARE(item3->isVisible(), true);
+    }
+
+    void testCase_CachedLayoutDestroyedItem()
+    {
+        QScopedPointer<UbuntuTestCase> view(new UbuntuTestCase("CachedLayouts.qml"));
+        QQuickItem *root = view->rootObject();
+        ULLayouts *layouts = view->findItem<ULLayouts*>("layouts");
+        layouts->setCacheSize(1);
+        QTRY_COMPARE(layouts->currentLayout(), QString("small"));
+
+        root->setWidth(UCUnits::instance()->gu(55));
+        QTRY_COMPARE(layouts->currentLayout(), QString("medium"));
+        root->setWidth(UCUnits::instance()->gu(40));
+        QCOMPARE(layouts->currentLayout(), QString("small"));
+
+        // item3 isn't laid out in the small layout, destroy it while the
+        // medium layout laying it out is cached
+        QPointer<QQuickItem> item3(view->findItem<QQuickItem*>("item3"));
+        delete item3.data();
+        QVERIFY(!item3);
+
+        root->setWidth(UCUnits::instance()->gu(55));
+        QCOMPARE(layouts->currentLayout(), QString("medium"));
+        QQuickItem *item1 = view->findItem<QQuickItem*>("item1");
+        QCOMPARE(container(item1)->objectName(), QString("flow"));
+    }
+
+    void benchmark_resizeAcrossBreakpoints_data()
+    {
+        QTest::addColumn<QString>("document");
+        QTest::addColumn<int>("cacheSize");
+        QTest::newRow("uncached") << "CachedLayouts.qml" << 0;
+        QTest::newRow("cached") << "CachedLayouts.qml" << 2;
+        // mostly measures applying and reverting the item layout changes
+        QTest::newRow("200 items, uncached") << "ManyItemLayouts.qml" << 0;
+        QTest::newRow("200 items, cached") << "ManyItemLayouts.qml" << 2;
+    }
+    void benchmark_resizeAcrossBreakpoints()
+    {
+        QFETCH(QString, document);
+        QFETCH(int, cacheSize);
+        QScopedPointer<UbuntuTestCase> view(new UbuntuTestCase(document));
+        QQuickItem *root = view->rootObject();
+        ULLayouts *layouts = view->findItem<ULLayouts*>("layouts");
+        layouts->setCacheSize(cacheSize);
+        QTRY_COMPARE(layouts->currentLayout(), QString("small"));
+
+        // rotate back and forth between the phone and tablet layouts
+        QBENCHMARK {
+            root->setWidth(UCUnits::instance()->gu(55));
+            QTRY_COMPARE(layouts->currentLayout(), QString("medium"));
+            root->setWidth(UCUnits::instance()->gu(40));
+            QTRY_COMPARE(layouts->currentLayout(), QString("small"));
+        }
+    }
+};
+
+QTEST_MAIN(tst_LayoutCache)
+
+#include "tst_layoutcache.moc"
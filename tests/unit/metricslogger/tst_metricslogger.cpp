@@ -0,0 +1,116 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+#include <UbuntuMetrics/logger.h>
+
+static UMEvent frameEvent()
+{
+    UMEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = UMEvent::Frame;
+    event.timeStamp = Q_UINT64_C(1000000000);
+    event.frame.window = 1;
+    event.frame.number = 2;
+    event.frame.deltaTime = 16000000;
+    event.frame.syncTime = 1000000;
+    event.frame.renderTime = 2000000;
+    event.frame.gpuTime = 3000000;
+    event.frame.swapTime = 500000;
+    return event;
+}
+
+static QByteArray readFile(const QString& fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+class tst_MetricsLogger : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_MetricsLogger() {}
+
+private Q_SLOTS:
+
+    // File loggers write parsable text by default, whatever the parsable flag
+    // passed at construction.
+    void test_parsableText_data() {
+        QTest::addColumn<bool>("parsable");
+        QTest::newRow("parsable") << true;
+        QTest::newRow("not parsable") << false;
+    }
+    void test_parsableText() {
+        QFETCH(bool, parsable);
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.path() + QStringLiteral("/metrics.log");
+        {
+            UMFileLogger logger(fileName, parsable);
+            QVERIFY(logger.isOpen());
+            QCOMPARE(logger.parsable(), true);
+            QCOMPARE(logger.binary(), false);
+            logger.log(frameEvent());
+        }
+        QCOMPARE(readFile(fileName),
+                 QByteArray("F 1000000000 1 2 16000000 1000000 2000000 3000000 500000\n"));
+    }
+
+    void test_humanReadableText() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.path() + QStringLiteral("/metrics.log");
+        {
+            UMFileLogger logger(fileName);
+            logger.setParsable(false);
+            QCOMPARE(logger.parsable(), false);
+            logger.log(frameEvent());
+        }
+        QCOMPARE(readFile(fileName),
+                 QByteArray("F 00:01:000 Win=1 N=2 Delta=16.00ms Sync=1.00ms Render=2.00ms "
+                            "GPU=3.00ms Swap=0.50ms\n"));
+    }
+
+    // The binary format is opt-in.
+    void test_binary() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.path() + QStringLiteral("/metrics.bin");
+        {
+            UMFileLogger logger(fileName, true, true);
+            QVERIFY(logger.isOpen());
+            QCOMPARE(logger.binary(), true);
+            logger.log(frameEvent());
+        }
+        const QByteArray data = readFile(fileName);
+        QCOMPARE(data.size(),
+                 static_cast<int>(sizeof(UMBinaryLogHeader) + 2 * sizeof(quint32)
+                                  + sizeof(UMEvent)));
+        QCOMPARE(data.left(4), QByteArray("UMLG"));
+        UMEvent event;
+        memcpy(&event, data.constData() + sizeof(UMBinaryLogHeader) + 2 * sizeof(quint32),
+               sizeof(event));
+        QCOMPARE(event.type, UMEvent::Frame);
+        QCOMPARE(event.frame.swapTime, Q_UINT64_C(500000));
+    }
+};
+
+QTEST_MAIN(tst_MetricsLogger)
+
+#include "tst_metricslogger.moc"
@@ -151,6 +151,32 @@ private Q_SLOTS:
             delete root;
     }
 
+    void benchmark_rendering_data()
+    {
+        QTest::addColumn<QString>("document");
+
+        QTest::newRow("grid with Rectangle") << "RectangleGrid.qml";
+        QTest::newRow("grid with UbuntuShape") << "UbuntuShapeGrid.qml";
+        QTest::newRow("grid with UbuntuShapePair") << "PairOfUbuntuShapeGrid.qml";
+    }
+
+    // Measures the rendering of a frame, which includes the batching of the scene graph nodes and
+    // the draw calls.
+    void benchmark_rendering()
+    {
+        QFETCH(QString, document);
+
+        QQuickItem *root = loadDocument(document);
+        QVERIFY(root);
+        quickView->show();
+        QVERIFY(QTest::qWaitForWindowExposed(quickView));
+        QBENCHMARK {
+            quickView->grabWindow();
+        }
+        quickView->hide();
+        delete root;
+    }
+
     void benchmark_import_data()
     {
         QTest::addColumn<QString>("document");
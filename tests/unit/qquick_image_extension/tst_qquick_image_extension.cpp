@@ -31,7 +31,7 @@ UT_USE_NAMESPACE
 unsigned int numberOfTemporarySciFiles() {
     QStringList nameFilters;
     nameFilters << "*.sci";
-    return QDir::temp().entryList(nameFilters, QDir::Files).count();
+    return QDir(UCQQuickImageExtension::sciCacheDirectory()).entryList(nameFilters, QDir::Files).count();
 }
 
 int nFaces = 0;
@@ -57,6 +57,15 @@ private:
 
 private Q_SLOTS:
 
+    void initTestCase()
+    {
+        // start with an empty cache of rewritten .sci files
+        QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+        QString cacheDir(tempDir.filePath("tst_qquick_image_extension"));
+        QDir(cacheDir).removeRecursively();
+        qputenv("XDG_CACHE_HOME", cacheDir.toUtf8());
+    }
+
     void init()
     {
         engine = new QQmlEngine;
@@ -115,8 +124,8 @@ private Q_SLOTS:
 
     void cachingOfRewrittenSciFiles() {
         /* This tests an internal implementation detail of UCQQuickImageExtension,
-           namely making sure that only one temporary rewritten .sci file is
-           created for each source .sci file.
+           namely making sure that only one rewritten .sci file is
+           created for each source .sci file and scale factor.
         */
         QQuickImageBase baseImage;
         UCQQuickImageExtension* image1 = new UCQQuickImageExtension(&baseImage);
@@ -134,13 +143,43 @@ private Q_SLOTS:
         delete image1;
         QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
 
-        /* The temporary files will be deleted when the cache is destroyed when
-           the application exits.
+        /* The rewritten files are kept for the next runs of the application.
         */
         delete image2;
         QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
     }
 
+    void collectStaleSciFiles() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString sciFilePath = QFileInfo("data/test@18.sci").absoluteFilePath();
+        const QString modified = QString::number(QFileInfo(sciFilePath).lastModified().toMSecsSinceEpoch());
+
+        QFile upToDate(directory.path() + "/upToDate.sci");
+        QVERIFY(upToDate.open(QIODevice::WriteOnly | QIODevice::Text));
+        upToDate.write(QString("# ubuntu-ui-toolkit rewritten sci " + modified + " " + sciFilePath + "\n").toUtf8());
+        upToDate.close();
+        QFile modifiedSince(directory.path() + "/modifiedSince.sci");
+        QVERIFY(modifiedSince.open(QIODevice::WriteOnly | QIODevice::Text));
+        modifiedSince.write(QString("# ubuntu-ui-toolkit rewritten sci 1 " + sciFilePath + "\n").toUtf8());
+        modifiedSince.close();
+        QFile removed(directory.path() + "/removed.sci");
+        QVERIFY(removed.open(QIODevice::WriteOnly | QIODevice::Text));
+        removed.write(QString("# ubuntu-ui-toolkit rewritten sci " + modified + " /non/existing.sci\n").toUtf8());
+        removed.close();
+        QFile foreign(directory.path() + "/foreign.sci");
+        QVERIFY(foreign.open(QIODevice::WriteOnly | QIODevice::Text));
+        foreign.write("border.left: 9\n");
+        foreign.close();
+
+        UCQQuickImageExtension::collectStaleSciFiles(directory.path());
+        QVERIFY(upToDate.exists());
+        QVERIFY(!modifiedSince.exists());
+        QVERIFY(!removed.exists());
+        // not written by the toolkit
+        QVERIFY(foreign.exists());
+    }
+
     void onlyOneStatRepeatedImage() {
         DummyFileEngineHandler handler;
 
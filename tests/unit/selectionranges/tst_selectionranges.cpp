@@ -0,0 +1,124 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QTest>
+#include <UbuntuToolkit/private/selectionranges_p.h>
+
+UT_USE_NAMESPACE
+
+class tst_SelectionRanges : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_SelectionRanges() {}
+
+private Q_SLOTS:
+
+    void test_insertMergesRanges()
+    {
+        SelectionRanges selection;
+        QVERIFY(selection.insert(0, 4));
+        QVERIFY(selection.insert(10, 14));
+        QCOMPARE(selection.ranges().size(), 2);
+        QCOMPARE(selection.count(), 10);
+
+        // touching range merges
+        QVERIFY(selection.insert(5, 5));
+        QCOMPARE(selection.ranges().size(), 2);
+        // already contained
+        QVERIFY(!selection.insert(1, 3));
+        // bridging range merges both
+        QVERIFY(selection.insert(6, 9));
+        QCOMPARE(selection.ranges().size(), 1);
+        QCOMPARE(selection.count(), 15);
+        QVERIFY(selection.contains(0));
+        QVERIFY(selection.contains(14));
+        QVERIFY(!selection.contains(15));
+    }
+
+    void test_removeSplitsRanges()
+    {
+        SelectionRanges selection;
+        selection.insert(0, 9999);
+        QVERIFY(selection.remove(100, 199));
+        QCOMPARE(selection.ranges().size(), 2);
+        QCOMPARE(selection.count(), 9900);
+        QVERIFY(!selection.contains(150));
+        QVERIFY(selection.contains(99));
+        QVERIFY(selection.contains(200));
+        QVERIFY(!selection.remove(120, 130));
+        QVERIFY(selection.remove(0, 9999));
+        QVERIFY(selection.isEmpty());
+        QCOMPARE(selection.count(), 0);
+    }
+
+    void test_move_data()
+    {
+        QTest::addColumn<QList<int> >("selected");
+        QTest::addColumn<int>("from");
+        QTest::addColumn<int>("to");
+        QTest::addColumn<QList<int> >("expected");
+
+        QTest::newRow("selected forwards") << (QList<int>() << 1 << 3) << 1 << 4 << (QList<int>() << 2 << 4);
+        QTest::newRow("selected backwards") << (QList<int>() << 1 << 4) << 4 << 0 << (QList<int>() << 0 << 2);
+        QTest::newRow("unselected forwards") << (QList<int>() << 2 << 3 << 6) << 0 << 5 << (QList<int>() << 1 << 2 << 6);
+        QTest::newRow("within range") << (QList<int>() << 1 << 2 << 3) << 1 << 3 << (QList<int>() << 1 << 2 << 3);
+        QTest::newRow("out of range") << (QList<int>() << 1 << 2 << 3) << 0 << 5 << (QList<int>() << 0 << 1 << 2);
+    }
+    void test_move()
+    {
+        QFETCH(QList<int>, selected);
+        QFETCH(int, from);
+        QFETCH(int, to);
+        QFETCH(QList<int>, expected);
+
+        SelectionRanges selection = SelectionRanges::fromList(selected);
+        selection.move(from, to);
+        QCOMPARE(selection.toList(), expected);
+        QCOMPARE(selection.count(), expected.count());
+    }
+
+    void test_fromListSortsAndMerges()
+    {
+        SelectionRanges selection = SelectionRanges::fromList(QList<int>() << 5 << 1 << 2 << 5 << 3 << 8);
+        QCOMPARE(selection.ranges().size(), 3);
+        QCOMPARE(selection.toList(), QList<int>() << 1 << 2 << 3 << 5 << 8);
+    }
+
+    void test_diff()
+    {
+        SelectionRanges before = SelectionRanges::fromList(QList<int>() << 0 << 1 << 2 << 6 << 7);
+        SelectionRanges after = SelectionRanges::fromList(QList<int>() << 1 << 2 << 3 << 4 << 7);
+
+        QVector<SelectionRanges::Change> changes = SelectionRanges::diff(before, after);
+        QCOMPARE(changes.size(), 3);
+        QCOMPARE(changes[0].first, 0);
+        QCOMPARE(changes[0].last, 0);
+        QCOMPARE(changes[0].selected, false);
+        QCOMPARE(changes[1].first, 3);
+        QCOMPARE(changes[1].last, 4);
+        QCOMPARE(changes[1].selected, true);
+        QCOMPARE(changes[2].first, 6);
+        QCOMPARE(changes[2].last, 6);
+        QCOMPARE(changes[2].selected, false);
+        QVERIFY(SelectionRanges::diff(after, after).isEmpty());
+    }
+};
+
+QTEST_MAIN(tst_SelectionRanges)
+
+#include "tst_selectionranges.moc"
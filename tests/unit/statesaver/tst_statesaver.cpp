@@ -21,6 +21,7 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QProcess>
 #include <QtCore/QProcessEnvironment>
+#include <QtCore/QSettings>
 #include <QtGui/QMatrix4x4>
 #include <QtGui/QQuaternion>
 #include <QtGui/QVector3D>
@@ -66,7 +67,9 @@ private:
         Q_EMIT StateSaverBackend::instance()->initiateStateSaving();
         view.reset();
         // Make sure that the state is reloaded from file
-        StateSaverBackend::instance()->m_archive.data()->sync();
+        StateSaverBackend::instance()->flush();
+        StateSaverBackend::instance()->m_states.clear();
+        StateSaverBackend::instance()->readArchive();
         view.reset(new UbuntuTestCase(file));
     }
 
@@ -75,7 +78,9 @@ private:
         Q_EMIT StateSaverBackend::instance()->initiateStateSaving();
         view.reset();
         // Make sure that the state is reloaded from file
-        StateSaverBackend::instance()->m_archive.data()->sync();
+        StateSaverBackend::instance()->flush();
+        StateSaverBackend::instance()->m_states.clear();
+        StateSaverBackend::instance()->readArchive();
         view.reset(createView(file));
     }
 
@@ -122,6 +127,27 @@ private Q_SLOTS:
         delete engine;
     }
 
+    void test_ImportSettingsArchive()
+    {
+        // archives written by QSettings are read with the types saved along the values
+        StateSaverBackend *backend = StateSaverBackend::instance();
+        QString fileName = backend->archiveFileName();
+        QVERIFY(!fileName.isEmpty());
+        {
+            QSettings settings(fileName, QSettings::NativeFormat);
+            settings.beginGroup("item:1");
+            settings.setValue("count", 5);
+            settings.setValue("count_TYPE", QVariant::fromValue((int)QVariant::Int));
+            settings.endGroup();
+            settings.sync();
+        }
+
+        backend->readArchive();
+        QVariant value = backend->m_states.value("item:1").value("count");
+        QCOMPARE(value.type(), QVariant::Int);
+        QCOMPARE(value.toInt(), 5);
+    }
+
     void test_SaveArrays()
     {
         QScopedPointer<QQuickView> view(createView("SaveArrays.qml"));
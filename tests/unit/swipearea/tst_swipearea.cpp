@@ -125,6 +125,7 @@ private Q_SLOTS:
     void makoLeftEdgeDrag_movesSlightlyBackwardsOnStart();
     void grabGesture();
     void grabGestureWithImmediateRecognition();
+    void touchResampling();
 
 private:
     // QTest::touchEvent takes QPoint instead of QPointF and I don't want to
@@ -1445,6 +1446,59 @@ void tst_UCSwipeArea::grabGestureWithImmediateRecognition()
     sendTouchRelease(timestamp, 0, touchPoint);
 }
 
+/*
+  With touch resampling enabled the public position is updated once per frame
+  with the touch position extrapolated one frame ahead.
+ */
+void tst_UCSwipeArea::touchResampling()
+{
+    UCSwipeArea *edgeDragArea =
+        m_view->rootObject()->findChild<UCSwipeArea*>("hpDragArea");
+    Q_ASSERT(edgeDragArea != 0);
+    UCSwipeAreaPrivate *d = UCSwipeAreaPrivate::get(edgeDragArea);
+    d->setRecognitionTimer(m_fakeTimerFactory->createTimer(edgeDragArea));
+    d->setTimeSource(m_fakeTimerFactory->timeSource());
+
+    edgeDragArea->setImmediateRecognition(true);
+    d->setTouchResampling(true);
+    d->predictionLead = 16;
+
+    QPointF touchPoint = calculateInitialtouchPosition(edgeDragArea);
+    // moves rightwards at 200 pixels per second
+    const QPointF touchMovement(1., 0.);
+    const int movementTimeStepMs = 5;
+
+    qint64 timestamp = 0;
+    sendTouchPress(timestamp, 0, touchPoint);
+    QCOMPARE((int)d->status, (int)UCSwipeAreaPrivate::Recognized);
+
+    for (int i = 0; i < 10; ++i) {
+        touchPoint += touchMovement;
+        timestamp += movementTimeStepMs;
+        sendTouchUpdate(timestamp, 0, touchPoint);
+    }
+
+    QVERIFY(qAbs(d->velocity().x() - 200.) < 0.001);
+    QVERIFY(qAbs(d->velocity().y()) < 0.001);
+
+    // one frame ahead of the last touch event
+    d->resampleTouchPosition();
+    QVERIFY(qAbs(d->publicScenePos.x() - (touchPoint.x() + 16. * 0.2)) < 0.001);
+    QVERIFY(qAbs(d->publicScenePos.y() - touchPoint.y()) < 0.001);
+
+    // the finger stopped some time ago, no more extrapolation
+    passTime(d->resampler.fitWindow() + 1);
+    d->resampleTouchPosition();
+    QVERIFY(qAbs(d->publicScenePos.x() - touchPoint.x()) < 0.001);
+
+    // the gesture ends exactly where the finger was lifted
+    touchPoint += touchMovement;
+    timestamp = m_fakeTimerFactory->timeSource()->msecsSinceReference() + movementTimeStepMs;
+    sendTouchRelease(timestamp, 0, touchPoint);
+    QCOMPARE((int)d->status, (int)UCSwipeAreaPrivate::WaitingForTouch);
+    QCOMPARE(d->publicScenePos, touchPoint);
+}
+
 QTEST_MAIN(tst_UCSwipeArea)
 
 #include "tst_swipearea.moc"
@@ -48,6 +48,22 @@ Q_SIGNALS:
     void lostOwnership();
 };
 
+// Only counts the events, so that benchmarks measure the dispatching alone
+class CountingCandidate : public QQuickItem
+{
+public:
+    CountingCandidate() : unownedTouchEventCount(0) {}
+    bool event(QEvent *e) override
+    {
+        if (e->type() == UnownedTouchEvent::unownedTouchEventType()) {
+            ++unownedTouchEventCount;
+            return true;
+        }
+        return QQuickItem::event(e);
+    }
+    int unownedTouchEventCount;
+};
+
 class tst_TouchRegistry : public QObject
 {
     Q_OBJECT
@@ -73,6 +89,8 @@ private Q_SLOTS:
     void interimOwnerWontGetUnownedTouchEvents();
     void candidateVanishes();
     void candicateOwnershipReentrace();
+    void benchmark_dispatchToUndecidedCandidates_data();
+    void benchmark_dispatchToUndecidedCandidates();
 
 private:
     TouchRegistry *touchRegistry;
@@ -920,6 +938,67 @@ void tst_TouchRegistry::candicateOwnershipReentrace()
     QCOMPARE(candicate3.lostTouches.count(), 1);
 }
 
+void tst_TouchRegistry::benchmark_dispatchToUndecidedCandidates_data()
+{
+    QTest::addColumn<int>("touchCount");
+    QTest::addColumn<int>("candidateCount");
+    QTest::addColumn<int>("watcherCount");
+
+    QTest::newRow("1 touch, 1 candidate") << 1 << 1 << 0;
+    QTest::newRow("1 touch, 3 candidates") << 1 << 3 << 0;
+    QTest::newRow("2 touches, 3 candidates, 1 watcher") << 2 << 3 << 1;
+    QTest::newRow("5 touches, 3 candidates, 2 watchers") << 5 << 3 << 2;
+}
+
+void tst_TouchRegistry::benchmark_dispatchToUndecidedCandidates()
+{
+    QFETCH(int, touchCount);
+    QFETCH(int, candidateCount);
+    QFETCH(int, watcherCount);
+
+    QList<CountingCandidate*> items;
+    for (int i = 0; i < candidateCount + watcherCount; ++i) {
+        items.append(new CountingCandidate);
+    }
+
+    QList<QTouchEvent::TouchPoint> touchPoints;
+    for (int touchId = 0; touchId < touchCount; ++touchId) {
+        touchPoints.append(QTouchEvent::TouchPoint(touchId));
+        touchPoints.last().setState(Qt::TouchPointPressed);
+    }
+    {
+        QTouchEvent touchEvent(QEvent::TouchBegin,
+                               0 /* device */,
+                               Qt::NoModifier,
+                               Qt::TouchPointPressed,
+                               touchPoints);
+        touchRegistry->update(&touchEvent);
+    }
+    for (int touchId = 0; touchId < touchCount; ++touchId) {
+        for (int i = 0; i < candidateCount; ++i) {
+            touchRegistry->addCandidateOwnerForTouch(touchId, items[i]);
+        }
+        for (int i = candidateCount; i < items.count(); ++i) {
+            touchRegistry->addTouchWatcher(touchId, items[i]);
+        }
+    }
+
+    for (int i = 0; i < touchPoints.count(); ++i) {
+        touchPoints[i].setState(Qt::TouchPointMoved);
+    }
+    QTouchEvent touchEvent(QEvent::TouchUpdate,
+                           0 /* device */,
+                           Qt::NoModifier,
+                           Qt::TouchPointMoved,
+                           touchPoints);
+    QBENCHMARK {
+        touchRegistry->update(&touchEvent);
+    }
+    QVERIFY(items[0]->unownedTouchEventCount > 0);
+
+    qDeleteAll(items);
+}
+
 ////////////// TouchMemento //////////
 
 TouchMemento::TouchMemento(const QTouchEvent *touchEvent)
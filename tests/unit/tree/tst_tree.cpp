@@ -19,6 +19,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QVariant>
+#include <QtCore/QVector>
 #include <QtTest/QTest>
 #include <UbuntuToolkit/private/tree_p.h>
 
@@ -459,6 +460,123 @@ private Q_SLOTS:
         //out of bounds
         QVERIFY(tree.top(0, true, 19) == nullptr);
     }
+
+    void test_chopAfterPruneKeepsIndices () {
+        Tree tree;
+        QObject parent;
+
+        QObject *rootNode = new QObject(&parent);
+        QObject *stem1 = new QObject(&parent);
+        QObject *subNode1 = new QObject(&parent);
+        QObject *subNode2 = new QObject(&parent);
+
+        QVERIFY(tree.add(0, nullptr, rootNode));
+        QVERIFY(tree.add(1, rootNode, stem1));
+        QVERIFY(tree.add(0, rootNode, subNode1));
+        QVERIFY(tree.add(0, subNode1, subNode2));
+
+        // removing from the middle shifts the later nodes down
+        QList<QObject *> nodes = tree.prune(1);
+        QCOMPARE(nodes, QList<QObject *>() << stem1);
+        QCOMPARE(tree.index(subNode1), 1);
+        QCOMPARE(tree.index(subNode2), 2);
+
+        nodes = tree.chop(QVariant::fromValue<QObject *>(subNode1));
+        QCOMPARE(nodes, QList<QObject *>() << subNode1 << subNode2);
+        QCOMPARE(tree.top(), rootNode);
+        QVERIFY(tree.parent(rootNode) == nullptr);
+
+        // slots of removed nodes are reused
+        QVERIFY(tree.add(2, rootNode, subNode2));
+        QCOMPARE(tree.index(subNode2), 1);
+        QCOMPARE(tree.parent(subNode2), rootNode);
+        QCOMPARE(tree.top(2, true), subNode2);
+    }
+
+    void benchmark_deepStack_data() {
+        QTest::addColumn<int>("depth");
+        QTest::newRow("100") << 100;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+    void benchmark_deepStack() {
+        QFETCH(int, depth);
+        QObject parent;
+        QVector<QObject *> pages;
+        for (int i = 0; i < depth; i++) {
+            pages.append(new QObject(&parent));
+        }
+
+        // push a deep stack, then pop it page by page as PageStack does
+        QBENCHMARK {
+            Tree tree;
+            tree.add(0, nullptr, pages[0]);
+            for (int i = 1; i < depth; i++) {
+                tree.add(0, tree.top(), pages[i]);
+            }
+            while (tree.top()) {
+                tree.chop(QVariant());
+            }
+        }
+    }
+
+    void benchmark_adaptivePageLayoutNavigation_data() {
+        QTest::addColumn<int>("depth");
+        QTest::newRow("100") << 100;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+    void benchmark_adaptivePageLayoutNavigation() {
+        QFETCH(int, depth);
+        QObject parent;
+        QVector<QObject *> pages;
+        for (int i = 0; i < depth; i++) {
+            pages.append(new QObject(&parent));
+        }
+
+        // fill two columns, then repeatedly replace the top of the second
+        // column the way AdaptivePageLayout.addPageToNextColumn() does
+        Tree tree;
+        tree.add(0, nullptr, pages[0]);
+        for (int i = 1; i < depth - 1; i++) {
+            tree.add(i % 2, pages[i - 1], pages[i]);
+        }
+        QObject *page = pages[depth - 1];
+        QBENCHMARK {
+            tree.add(1, tree.top(0, true), page);
+            tree.parent(page);
+            tree.index(page);
+            tree.chop(QVariant::fromValue<QObject *>(page));
+        }
+    }
+
+    void benchmark_pruneDeepStem_data() {
+        QTest::addColumn<int>("depth");
+        QTest::newRow("100") << 100;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+    void benchmark_pruneDeepStem() {
+        QFETCH(int, depth);
+        QObject parent;
+        QVector<QObject *> pages;
+        for (int i = 0; i < depth; i++) {
+            pages.append(new QObject(&parent));
+        }
+
+        // a deep primary column with a single page in the second column
+        // which gets pruned, as when the layout collapses to one column
+        Tree tree;
+        tree.add(0, nullptr, pages[0]);
+        for (int i = 1; i < depth - 1; i++) {
+            tree.add(0, pages[i - 1], pages[i]);
+        }
+        QObject *page = pages[depth - 1];
+        QBENCHMARK {
+            tree.add(1, tree.top(), page);
+            tree.prune(1);
+        }
+    }
 };
 
 QTEST_MAIN(tst_Tree)
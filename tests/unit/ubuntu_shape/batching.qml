@@ -0,0 +1,33 @@
+import QtQuick 2.4
+import Ubuntu.Components 1.3
+
+Item {
+    width: 900
+    height: 500
+
+    // "shared": each shape has its own Image item sourcing the same file.
+    // "atlas": shapes alternate between two small images packed in the atlas.
+    // "repeated": same as "shared" with repeat wrapping, which prevents batching.
+    property string mode: "shared"
+
+    Flow {
+        anchors.fill: parent
+        spacing: 10
+
+        Repeater {
+            model: 8
+
+            UbuntuShape {
+                width: 100
+                height: 100
+                radius: index % 2 ? "medium" : "small"
+                sourceHorizontalWrapMode: mode == "repeated" ? UbuntuShape.Repeat
+                                                             : UbuntuShape.Transparent
+                source: Image {
+                    source: mode == "atlas" && index % 2 ? "batching_source2.png"
+                                                         : "batching_source1.png"
+                }
+            }
+        }
+    }
+}
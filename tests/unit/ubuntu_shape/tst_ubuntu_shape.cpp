@@ -17,9 +17,23 @@
  */
 
 #include <QtQml/QQmlEngine>
+#include <QtQuick/QQuickItem>
 #include <QtQuick/QQuickView>
 #include <QtTest/QtTest>
 
+// Statistics printed by the batch renderer for each frame when QSG_RENDERER_DEBUG
+// contains "render", the number of batches being the number of draw calls.
+static QMutex rendererStatsMutex;
+static QStringList rendererStats;
+
+static void rendererStatsHandler(QtMsgType, const QMessageLogContext &, const QString &message)
+{
+    if (message.contains(QStringLiteral("batches"))) {
+        QMutexLocker locker(&rendererStatsMutex);
+        rendererStats.append(message);
+    }
+}
+
 class tst_UbuntuShape: public QObject
 {
     Q_OBJECT
@@ -27,6 +41,13 @@ class tst_UbuntuShape: public QObject
 private:
     QQuickView *m_quickView;
 
+public:
+    tst_UbuntuShape()
+    {
+        // Must be set before the first frame is rendered, the renderer reads it once.
+        qputenv("QSG_RENDERER_DEBUG", "render");
+    }
+
 private Q_SLOTS:
 
     void initTestCase()
@@ -56,6 +77,49 @@ private Q_SLOTS:
 
         QCOMPARE(result, expected);
     }
+
+    void batching_data() {
+        QTest::addColumn<QString>("mode");
+        QTest::addColumn<int>("batchCount");
+
+        // The 8 shapes have different radii.
+        QTest::newRow("shared image") << "shared" << 1;
+        QTest::newRow("atlas") << "atlas" << 1;
+        QTest::newRow("repeat wrapping") << "repeated" << 8;
+    }
+    void batching() {
+        QFETCH(QString, mode);
+        QFETCH(int, batchCount);
+
+        m_quickView->setSource(QUrl::fromLocalFile("batching.qml"));
+        QVERIFY(m_quickView->rootObject());
+        m_quickView->rootObject()->setProperty("mode", mode);
+        QVERIFY(QTest::qWaitForWindowExposed(m_quickView));
+
+        rendererStatsMutex.lock();
+        rendererStats.clear();
+        rendererStatsMutex.unlock();
+        QtMessageHandler previousHandler = qInstallMessageHandler(rendererStatsHandler);
+        m_quickView->grabWindow();
+        qInstallMessageHandler(previousHandler);
+
+        // The blended shapes are rendered in the alpha pass.
+        QRegularExpression alphaStats(
+            QStringLiteral("Alpha:\\s*(\\d+)\\s*nodes in\\s*(\\d+)\\s*batches"));
+        QRegularExpressionMatch match;
+        QMutexLocker locker(&rendererStatsMutex);
+        for (const QString &stats : rendererStats) {
+            QRegularExpressionMatch statsMatch = alphaStats.match(stats);
+            if (statsMatch.hasMatch()) {
+                match = statsMatch;
+            }
+        }
+        if (!match.hasMatch()) {
+            QSKIP("The scene graph renderer doesn't provide batch statistics");
+        }
+        QCOMPARE(match.captured(1).toInt(), 8);
+        QCOMPARE(match.captured(2).toInt(), batchCount);
+    }
 };
 
 QTEST_MAIN(tst_UbuntuShape)
@@ -2,4 +2,7 @@ include(../test-include-x11.pri)
 SOURCES += tst_ubuntu_shape.cpp
 OTHER_FILES += no_distortion.qml \
                no_distortion_source.png \
-               no_distortion_expected.png
+               no_distortion_expected.png \
+               batching.qml \
+               batching_source1.png \
+               batching_source2.png
@@ -26,6 +26,7 @@ SUBDIRS += \
     deprecated_theme_engine \
     orientation \
 #    layouts \ # FIXME: Breaks on Yakkety. See bug #1625137.
+    layoutcache \
     mousefilters \
     animator \
     serviceproperties \
@@ -49,4 +50,9 @@ SUBDIRS += \
     theme \
     quickutils \
     tree \
+    histogram \
+    gputimer \
+    metricslogger \
+    eventqueue \
+    selectionranges \
     contenthub
@@ -17,6 +17,8 @@
  */
 
 #include <QtTest/QtTest>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
 #include <UbuntuToolkit/private/ucunits_p.h>
 
 UT_USE_NAMESPACE
@@ -282,6 +284,94 @@ private Q_SLOTS:
         expected = QString("0.875/" + QDir::currentPath() + QDir::separator() + "resource@8.png");
         QCOMPARE(resolved, expected);
     }
+
+    void resolveCachedDirectory() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path();
+        QVERIFY(QFile(path + "/plain.png").open(QIODevice::WriteOnly));
+        QVERIFY(QFile(path + "/icon@10.png").open(QIODevice::WriteOnly));
+        QVERIFY(QFile(path + "/icon@14.png").open(QIODevice::WriteOnly));
+
+        UCUnits units;
+        units.setGridUnit(10);
+
+        // exact matches and @N variants, resolved twice from the same listing
+        for (int i = 0; i < 2; i++) {
+            QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/plain.png")),
+                     QString("1/" + path + "/plain.png"));
+            QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                     QString("1/" + path + "/icon@10.png"));
+            QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/missing.png")),
+                     QString());
+        }
+
+        // files added meanwhile are taken into account when the grid unit changes
+        QVERIFY(QFile(path + "/icon@12.png").open(QIODevice::WriteOnly));
+        units.setGridUnit(11);
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                 QString("0.916667/" + path + "/icon@12.png"));
+        units.setGridUnit(13);
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                 QString("0.928571/" + path + "/icon@14.png"));
+        units.setGridUnit(12);
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                 QString("1/" + path + "/icon@12.png"));
+    }
+
+    void resolveAddedFiles() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path();
+        QVERIFY(QFile(path + "/icon@14.png").open(QIODevice::WriteOnly));
+
+        UCUnits units;
+        units.setGridUnit(10);
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/new.png")), QString());
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                 QString("0.714286/" + path + "/icon@14.png"));
+
+        // files created after the directory got listed, like downloaded images
+        QVERIFY(QFile(path + "/new.png").open(QIODevice::WriteOnly));
+        QVERIFY(QFile(path + "/icon@12.png").open(QIODevice::WriteOnly));
+        QVERIFY(QFile(path + "/.hidden.png").open(QIODevice::WriteOnly));
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/new.png")),
+                 QString("1/" + path + "/new.png"));
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/icon.png")),
+                 QString("0.833333/" + path + "/icon@12.png"));
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/.hidden.png")),
+                 QString("1/" + path + "/.hidden.png"));
+    }
+
+    void benchmark_resolveManySources_data() {
+        QTest::addColumn<bool>("gridUnitChanges");
+
+        QTest::newRow("same grid unit") << false;
+        QTest::newRow("grid unit changes") << true;
+    }
+
+    void benchmark_resolveManySources() {
+        QFETCH(bool, gridUnitChanges);
+        UCUnits units;
+        units.setGridUnit(10);
+
+        // image sources of a long list, mixing exact, scaled and missing resources
+        const QStringList names = QStringList() << "exact_match_no_suffix.png" << "resource.png"
+            << "resource_only_higher.png" << "resource_only_smaller.png" << "non_existing.png";
+        QList<QUrl> sources;
+        for (int i = 0; i < 5000; i++) {
+            sources.append(QUrl::fromLocalFile(names[i % names.count()]));
+        }
+
+        QBENCHMARK {
+            if (gridUnitChanges) {
+                units.setGridUnit(units.gridUnit() == 10 ? 9 : 10);
+            }
+            Q_FOREACH(const QUrl &source, sources) {
+                units.resolveResource(source);
+            }
+        }
+    }
 };
 
 QTEST_MAIN(tst_UCUnits)
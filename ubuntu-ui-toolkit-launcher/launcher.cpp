@@ -76,7 +76,7 @@ int main(int argc, const char *argv[])
     QCommandLineOption _desktop_file_hint("desktop_file_hint", "Desktop file - ignored", "desktop_file");
     QCommandLineOption _metricsOverlay("metrics-overlay", "Enable the metrics overlay");
     QCommandLineOption _metricsLogging(
-        "metrics-logging", "Enable metrics logging, <device> can be 'stdout', 'lttng' (Linux "
+        "metrics-logging", "Enable metrics logging, <device> can be 'stdout', 'lttng', 'shm' (Linux "
         "only), a local or absolute filename", "device");
     QCommandLineOption _metricsLoggingFilter(
         "metrics-logging-filter", "Filter metrics logging, <filter> is a list of events separated "
@@ -242,6 +242,8 @@ int main(int argc, const char *argv[])
 #if defined(Q_OS_LINUX)
         } else if (device == "lttng") {
             logger = new UMLTTNGLogger();
+        } else if (device == "shm") {
+            logger = new UMSharedMemoryLogger();
 #endif  // defined(Q_OS_LINUX)
         } else {
             logger = new UMFileLogger(device);